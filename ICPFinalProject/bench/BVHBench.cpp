@@ -0,0 +1,86 @@
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+#include <glm/ext.hpp>
+
+#include "Bench.h"
+#include "TriangleBVH.h"
+#include "Simulation.h"
+#include "Random.h"
+
+/*
+	usage: ICPBench bvh [--queries N]
+
+	Builds the BVH of the shipped meshes (ground.obj, no longer part of the level since the
+	heightmap terrain, wooden_map/Wooden.obj and the level as placed in the game) and measures
+	build time and query throughput:
+	rays in random directions, per-tick plane sweeps (0.1 long) and longer sweeps (2.0).
+	Run it from the project directory (needs resources/).
+*/
+
+static void runMesh(const char* name, TriangleBVH& bvh, int queries)
+{
+    // rebuilding reorders the same triangles, the best of a few builds is the build time
+    double build = BenchBest(5, [&]() { bvh.Build(); });
+
+    // query origins spread over the play area and the wooden map bounds
+    Random random(1);
+    glm::vec3 lo(-10.0f, 0.0f, -12.0f), hi(10.0f, 7.0f, 10.0f);
+    std::vector<glm::vec3> origins(queries), directions(queries);
+    random.FillInBox(origins.data(), queries, lo, hi);
+    for (int i = 0; i < queries; i++)
+        directions[i] = glm::normalize(random.InBox(glm::vec3(-1.0f), glm::vec3(1.0f)) + glm::vec3(0.0f, 0.0f, 1e-3f));
+
+    int rayHits = 0, shortHits = 0, longHits = 0;
+    double ray = BenchBest(3, [&]() {
+        rayHits = 0;
+        BVHHit hit;
+        for (int i = 0; i < queries; i++)
+            rayHits += bvh.Raycast(origins[i], directions[i], 100.0f, hit);
+    });
+    double sweepShort = BenchBest(3, [&]() {
+        shortHits = 0;
+        BVHHit hit;
+        for (int i = 0; i < queries; i++)
+            shortHits += bvh.SphereCast(origins[i], origins[i] + directions[i] * 0.1f, Simulation::PLANE_RADIUS, hit);
+    });
+    double sweepLong = BenchBest(3, [&]() {
+        longHits = 0;
+        BVHHit hit;
+        for (int i = 0; i < queries; i++)
+            longHits += bvh.SphereCast(origins[i], origins[i] + directions[i] * 2.0f, 0.25f, hit);
+    });
+
+    std::cout << name << ": " << bvh.TriangleCount() << " triangles, " << bvh.NodeCount() << " nodes, depth " << bvh.Depth()
+        << ", build " << build * 1e3 << " ms" << std::endl;
+    BenchReport("  ray (closest hit)", ray, queries);
+    BenchReport("  sphere sweep 0.1 (plane tick)", sweepShort, queries);
+    BenchReport("  sphere sweep 2.0, r 0.25", sweepLong, queries);
+    std::cout << "  hits: rays " << rayHits << ", short sweeps " << shortHits << ", long sweeps " << longHits << " of " << queries << std::endl;
+}
+
+int BVHBench(int argc, char** argv)
+{
+    int queries = 100000;
+    for (int i = 0; i < argc; i++) {
+        if (std::strcmp(argv[i], "--queries") == 0 && i + 1 < argc)
+            queries = std::atoi(argv[++i]);
+        else {
+            std::cout << "usage: ICPBench bvh [--queries N]" << std::endl;
+            return -1;
+        }
+    }
+
+    TriangleBVH ground, wooden, level;
+    if (!ground.AddObj("resources/objects/ground/ground.obj", glm::mat4(1.0f))
+        || !wooden.AddObj("resources/objects/wooden_map/Wooden.obj", glm::mat4(1.0f))
+        || !Simulation::LoadTerrain(level))
+        return -1;
+
+    runMesh("ground.obj", ground, queries);
+    runMesh("Wooden.obj", wooden, queries);
+    runMesh("level (as placed in the game)", level, queries);
+    return 0;
+}
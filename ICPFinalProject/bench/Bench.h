@@ -0,0 +1,52 @@
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+
+#include "Timing.h"
+
+/*
+	Microbenchmarks of engine parts (ICPBench project), one function per benchmark.
+	Each takes the remaining command line and returns the process exit code.
+*/
+int RandomBench(int argc, char** argv);
+int CollisionBench(int argc, char** argv);
+int SphereBench(int argc, char** argv);
+int BVHBench(int argc, char** argv);
+int EntityBench(int argc, char** argv);
+int ChunkBench(int argc, char** argv);
+int TreeBench(int argc, char** argv);
+int TerrainBench(int argc, char** argv);
+int HsvBench(int argc, char** argv);
+int PredictionBench(int argc, char** argv);
+int RoiBench(int argc, char** argv);
+
+// best of `repeats` runs of f(), in seconds (best = least disturbed by the OS)
+template <typename F>
+double BenchBest(int repeats, F f)
+{
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        double start = NowSeconds();
+        f();
+        double elapsed = NowSeconds() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+// keeps results alive so the optimizer can't remove the measured work
+inline volatile float bench_sink = 0.0f;
+
+// one result line: name, time per item, throughput
+inline void BenchReport(const char* name, double seconds, double items)
+{
+    std::ios state(nullptr);
+    state.copyfmt(std::cout);
+    std::cout << std::left << std::setw(36) << name << std::right
+        << std::setw(10) << std::fixed << std::setprecision(2) << seconds / items * 1e9 << " ns/item"
+        << std::setw(12) << std::setprecision(1) << items / seconds / 1e6 << " M items/s" << std::endl;
+    std::cout.copyfmt(state);
+}
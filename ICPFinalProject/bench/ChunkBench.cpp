@@ -0,0 +1,100 @@
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "Bench.h"
+#include "ChunkStreamer.h"
+
+/*
+	usage: ICPBench chunks [--distance D] [--speed S] [--workers N]
+
+	Flies a straight line over the streamed world at S units per second (default 100, a lot
+	faster than the plane) with 60 frames per second, taking at most 4 finished chunks per frame
+	like the game's uploads. Reports chunk build throughput, load latency (request -> taken)
+	percentiles, the per frame cost on the flying thread and whether memory stays flat.
+*/
+
+static double percentile(std::vector<double>& values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(p * values.size()))];
+}
+
+int ChunkBench(int argc, char** argv)
+{
+    float distance = 1000.0f;
+    float speed = 100.0f;
+    int workerCount = 0;
+    for (int i = 0; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--distance") == 0 && has_value)
+            distance = (float)std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--speed") == 0 && has_value)
+            speed = (float)std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--workers") == 0 && has_value)
+            workerCount = std::atoi(argv[++i]);
+        else {
+            std::cout << "usage: ICPBench chunks [--distance D] [--speed S] [--workers N]" << std::endl;
+            return -1;
+        }
+    }
+
+    // build cost of one chunk on one thread
+    ChunkMesh mesh;
+    int builds = 0;
+    double build_time = BenchBest(5, [&]() {
+        for (int i = 0; i < 200; i++) {
+            mesh.coord.x = i;
+            mesh.coord.z = builds++;
+            BuildChunkMesh(1, mesh);
+        }
+    });
+    BenchReport("  BuildChunkMesh", build_time, 200.0);
+
+    ChunkStreamer streamer(1, 3, workerCount);
+    const double frame = 1.0 / 60.0;
+    int frames = (int)(distance / speed / frame);
+    std::vector<double> latencies, frame_us;
+    size_t first_bytes = 0, max_bytes = 0;
+    int max_resident = 0;
+
+    std::cout << "flying " << distance << " units at " << speed << " units/s (" << frames << " frames), load radius "
+        << streamer.LoadRadius() << " chunks of " << CHUNK_SIZE << std::endl;
+
+    double next = NowSeconds();
+    for (int f = 0; f < frames; f++) {
+        double start = NowSeconds();
+        streamer.Update(glm::vec3(0.0f, 2.0f, f * frame * speed));
+        ChunkCoord coord;
+        while (streamer.PopEvicted(coord)) {}
+        for (int i = 0; i < 4; i++) {
+            ChunkMesh* ready = streamer.PopReady();
+            if (!ready)
+                break;
+            latencies.push_back((NowSeconds() - ready->request_time) * 1000.0);
+            streamer.Recycle(ready);
+        }
+        frame_us.push_back((NowSeconds() - start) * 1e6);
+
+        size_t bytes = streamer.CpuBytes();
+        if (f == 60)
+            first_bytes = bytes;
+        max_bytes = std::max(max_bytes, bytes);
+        max_resident = std::max(max_resident, streamer.Resident());
+
+        next += frame;
+        SleepUntil(next);
+    }
+
+    std::cout << "  chunks loaded: " << latencies.size() << "  most resident: " << max_resident << " of " << streamer.MaxResident() << std::endl;
+    std::cout << "  load latency ms: p50 " << percentile(latencies, 0.5) << "  p95 " << percentile(latencies, 0.95)
+        << "  p99 " << percentile(latencies, 0.99) << "  max " << percentile(latencies, 1.0) << std::endl;
+    std::cout << "  frame cost us: p50 " << percentile(frame_us, 0.5) << "  p99 " << percentile(frame_us, 0.99)
+        << "  max " << percentile(frame_us, 1.0) << std::endl;
+    std::cout << "  CPU memory: " << first_bytes / 1024 << " kB after 1 s, " << max_bytes / 1024 << " kB most, "
+        << streamer.CpuBytes() / 1024 << " kB at the end" << std::endl;
+    return streamer.Resident() <= streamer.MaxResident() ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "Bench.h"
+#include "CollisionWorld.h"
+#include "Random.h"
+
+/*
+	usage: ICPBench collision [--objects N] [--probes N]
+
+	Spheres (r 0.2 - 0.6) at the density of the game map, 10 % of them moving every tick.
+	A collision tick = moving those + one swept query per probe (a plane flying 0.1 per tick).
+	Runs 1k, 10k, 100k objects (or just N) and compares the queries with brute force
+	(sqrt distance to every object, what the game did before the collision world).
+*/
+
+// brute force "within r of segment" with a square root per object
+static int bruteSegment(const std::vector<glm::vec3>& centers, const std::vector<float>& radii, const glm::vec3& p0, const glm::vec3& p1, float r)
+{
+    glm::vec3 d = p1 - p0;
+    float dd = glm::dot(d, d);
+    int found = 0;
+    for (size_t i = 0; i < centers.size(); i++) {
+        float t = dd > 0.0f ? glm::clamp(glm::dot(centers[i] - p0, d) / dd, 0.0f, 1.0f) : 0.0f;
+        if (glm::length(p0 + d * t - centers[i]) <= r + radii[i])
+            found++;
+    }
+    return found;
+}
+
+static int runCollision(int objects, int probes)
+{
+    const int ticks = 60;
+    const float step = 0.1f;
+    // same density as the 10 x 3 x 10 game map with 100 objects
+    float side = 10.0f * std::cbrt(objects / 100.0f);
+    glm::vec3 lo(-side * 0.5f, 0.0f, -side * 0.5f), hi(side * 0.5f, 3.0f * std::cbrt(objects / 100.0f), side * 0.5f);
+
+    Random random(1);
+    std::vector<glm::vec3> centers(objects);
+    std::vector<float> radii(objects);
+    random.FillInBox(centers.data(), objects, lo, hi);
+    random.FillRange(radii.data(), objects, 0.2f, 0.6f);
+
+    CollisionWorld world;
+    std::vector<int> handles(objects);
+    double build = BenchBest(1, [&]() {
+        for (int i = 0; i < objects; i++)
+            handles[i] = world.Insert(centers[i], radii[i], i % 2 ? LAYER_BOMB : LAYER_COIN, i);
+    });
+
+    std::vector<glm::vec3> probe(probes), direction(probes);
+    random.FillInBox(probe.data(), probes, lo, hi);
+    for (int i = 0; i < probes; i++)
+        direction[i] = glm::normalize(random.InBox(glm::vec3(-1.0f), glm::vec3(1.0f)) + glm::vec3(0.0f, 0.0f, 0.001f)) * step;
+
+    std::vector<CollisionHit> hits;
+    int moving = objects / 10;
+    long long found = 0;
+    world.tested = 0;
+    double start = NowSeconds();
+    for (int tick = 0; tick < ticks; tick++) {
+        for (int i = 0; i < moving; i++) {
+            centers[i].x += (tick & 1) ? 0.05f : -0.05f;
+            world.Move(handles[i], centers[i]);
+        }
+        for (int i = 0; i < probes; i++) {
+            hits.clear();
+            found += world.QuerySegment(probe[i], probe[i] + direction[i], 0.0f, LAYER_ALL, hits);
+        }
+    }
+    double tick_time = (NowSeconds() - start) / ticks;
+
+    // brute force on the final state, fewer probes when it gets slow
+    int brute_probes = objects > 10000 ? probes / 10 : probes;
+    long long brute_found = 0, grid_found = 0;
+    double brute_time = BenchBest(1, [&]() {
+        for (int i = 0; i < brute_probes; i++)
+            brute_found += bruteSegment(centers, radii, probe[i], probe[i] + direction[i], 0.0f);
+    }) / brute_probes;
+    for (int i = 0; i < brute_probes; i++) {
+        hits.clear();
+        grid_found += world.QuerySegment(probe[i], probe[i] + direction[i], 0.0f, LAYER_ALL, hits);
+    }
+
+    std::cout << objects << " objects (" << moving << " moving), " << probes << " probes" << std::endl;
+    std::cout << "  build: " << build * 1e3 << " ms (" << build / objects * 1e9 << " ns per object)" << std::endl;
+    std::cout << "  collision tick: " << tick_time * 1e3 << " ms  (query " << (tick_time / probes) * 1e9
+        << " ns incl. moves, " << (double)world.tested / ((double)ticks * probes) << " narrow tests, "
+        << (double)found / ((double)ticks * probes) << " hits per query)" << std::endl;
+    std::cout << "  brute force: " << brute_time * 1e9 << " ns per query" << std::endl;
+    if (brute_found != grid_found) {
+        std::cout << "  MISMATCH: grid " << grid_found << " hits, brute force " << brute_found << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int CollisionBench(int argc, char** argv)
+{
+    std::vector<int> counts = { 1000, 10000, 100000 };
+    int probes = 1000;
+    for (int i = 0; i < argc; i++) {
+        if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+            counts = { std::atoi(argv[++i]) };
+        else if (std::strcmp(argv[i], "--probes") == 0 && i + 1 < argc)
+            probes = std::atoi(argv[++i]);
+        else {
+            std::cout << "usage: ICPBench collision [--objects N] [--probes N]" << std::endl;
+            return -1;
+        }
+    }
+
+    int result = 0;
+    for (int objects : counts) {
+        if (runCollision(objects, probes) != 0)
+            result = 1;
+    }
+    return result;
+}
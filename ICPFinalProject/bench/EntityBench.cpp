@@ -0,0 +1,141 @@
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+
+#include "Bench.h"
+#include "EntityPool.h"
+#include "Random.h"
+
+/*
+	usage: ICPBench entities [--count N]
+
+	10k / 100k particles (or N): per tick update of all of them and churn (1% removed and
+	spawned again), EntityPool (one array per component, swap remove) against an array of
+	structs with erase, the usual way to keep a list of game objects.
+	Checks that handles of removed entities are reported dead.
+*/
+
+struct ParticleAoS {
+    glm::vec3 position;
+    glm::vec3 velocity;
+    float life;
+    int collider;
+};
+
+enum { PARTICLE_POSITION, PARTICLE_VELOCITY, PARTICLE_LIFE, PARTICLE_COLLIDER };
+typedef EntityPool<glm::vec3, glm::vec3, float, int> ParticlePool;
+
+static int runEntities(size_t count)
+{
+    const int ticks = 20;
+    const float dt = 1.0f / 60.0f;
+    size_t churn = count / 100 > 0 ? count / 100 : 1;
+
+    Random random(1);
+    std::vector<glm::vec3> positions(count), velocities(count);
+    random.FillInBox(positions.data(), count, glm::vec3(-50.0f), glm::vec3(50.0f));
+    random.FillInBox(velocities.data(), count, glm::vec3(-1.0f), glm::vec3(1.0f));
+    // which entities the churn removes, same for both layouts
+    std::vector<size_t> victims(churn);
+    for (size_t i = 0; i < churn; i++)
+        victims[i] = (size_t)random.Int(0, (int)count - churn - 1);
+
+    std::cout << count << " entities, " << ticks << " ticks, " << churn << " removed + spawned per tick" << std::endl;
+
+    std::vector<ParticleAoS> aos;
+    ParticlePool pool;
+    std::vector<EntityHandle> handles;
+    auto fill = [&]() {
+        aos.clear();
+        pool.Clear();
+        handles.clear();
+        for (size_t i = 0; i < count; i++) {
+            aos.push_back({ positions[i], velocities[i], 1.0f, (int)i });
+            handles.push_back(pool.Add(positions[i], velocities[i], 1.0f, (int)i));
+        }
+    };
+    fill();
+
+    double aos_update = BenchBest(5, [&]() {
+        for (int t = 0; t < ticks; t++) {
+            for (ParticleAoS& particle : aos) {
+                particle.position += particle.velocity * dt;
+                particle.life -= dt;
+            }
+        }
+        bench_sink = bench_sink + aos[0].position.x;
+    });
+    BenchReport("  update, array of structs", aos_update, (double)count * ticks);
+
+    double pool_update = BenchBest(5, [&]() {
+        for (int t = 0; t < ticks; t++) {
+            glm::vec3* position = pool.Column<PARTICLE_POSITION>();
+            const glm::vec3* velocity = pool.Column<PARTICLE_VELOCITY>();
+            float* life = pool.Column<PARTICLE_LIFE>();
+            for (size_t i = 0; i < pool.Size(); i++) {
+                position[i] += velocity[i] * dt;
+                life[i] -= dt;
+            }
+        }
+        bench_sink = bench_sink + pool.Column<PARTICLE_POSITION>()[0].x;
+    });
+    BenchReport("  update, EntityPool", pool_update, (double)count * ticks);
+
+    double aos_churn = BenchBest(3, [&]() {
+        for (int t = 0; t < ticks; t++) {
+            for (size_t v : victims)
+                aos.erase(aos.begin() + v);
+            for (size_t i = 0; i < churn; i++)
+                aos.push_back({ positions[i], velocities[i], 1.0f, (int)i });
+        }
+    });
+    BenchReport("  remove + spawn, vector erase", aos_churn, (double)churn * ticks);
+
+    int result = 0;
+    double pool_churn = BenchBest(3, [&]() {
+        for (int t = 0; t < ticks; t++) {
+            for (size_t v : victims) {
+                EntityHandle dead = handles[v];
+                pool.Remove(dead);
+                handles[v] = pool.Add(positions[v], velocities[v], 1.0f, (int)v);
+                if (pool.Alive(dead))
+                    result = 1;
+            }
+        }
+    });
+    BenchReport("  remove + spawn, EntityPool", pool_churn, (double)churn * ticks);
+
+    if (pool.Size() != count) {
+        std::cout << "  MISMATCH: " << pool.Size() << " entities left, expected " << count << std::endl;
+        result = 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!pool.Alive(handles[i]) || pool.Get<PARTICLE_COLLIDER>(handles[i]) != (int)i)
+            result = 1;
+    }
+    if (result != 0)
+        std::cout << "  MISMATCH: a handle points to the wrong entity" << std::endl;
+    return result;
+}
+
+int EntityBench(int argc, char** argv)
+{
+    std::vector<size_t> counts = { 10000, 100000 };
+    for (int i = 0; i < argc; i++) {
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            counts = { (size_t)std::strtoull(argv[++i], nullptr, 10) };
+        else {
+            std::cout << "usage: ICPBench entities [--count N]" << std::endl;
+            return -1;
+        }
+    }
+
+    int result = 0;
+    for (size_t count : counts) {
+        if (count < 2)
+            count = 2;
+        if (runEntities(count) != 0)
+            result = 1;
+    }
+    return result;
+}
@@ -0,0 +1,202 @@
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <algorithm>
+#include <string>
+
+#include "Bench.h"
+#include "HsvCentroid.h"
+#include "Random.h"
+
+/*
+	usage: ICPBench hsv [--frames N] [--threads N]
+
+	Colour tracking of 480p / 1080p / 4K frames: a noisy background with a red ball (the game's
+	tracking thresholds). The old GameApp::find_center_normalized_hsv made three passes with two
+	temporary images: BGR -> HSV image, inRange mask, then a loop over the mask with int sums.
+	ICPBench doesn't link OpenCV, so the baseline repeats those passes in plain C++ (OpenCV's
+	cvtColor is vectorized, the real old function is somewhat faster than this baseline, the
+	extra images and passes are the same).
+	Every kernel and thread count has to give the same moments, also over all 2^24 colours.
+*/
+
+// the game's thresholds
+static const HsvRange RED = { { 170, 150, 150 }, { 180, 255, 250 } };
+
+static void makeFrame(std::vector<uint8_t>& frame, int width, int height)
+{
+    Random random(7);
+    frame.resize((size_t)width * height * 3);
+    for (size_t i = 0; i < frame.size(); i++)
+        frame[i] = (uint8_t)random.Int(0, 255);
+
+    // ball of radius height / 4 at 2/3 of the width
+    float cx = width * 2.0f / 3.0f, cy = height * 0.5f, radius = height * 0.25f;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            float dx = x - cx, dy = y - cy;
+            if (dx * dx + dy * dy > radius * radius)
+                continue;
+            uint8_t* p = &frame[((size_t)y * width + x) * 3];
+            p[0] = (uint8_t)(60 + random.Int(-10, 10));
+            p[1] = (uint8_t)(20 + random.Int(-10, 10));
+            p[2] = (uint8_t)(230 + random.Int(-10, 10));
+        }
+    }
+}
+
+// the old function's passes, sums in 64 bit to show whether int would have overflowed
+static HsvMoments threePass(const uint8_t* bgr, int width, int height, bool& overflow)
+{
+    std::vector<uint8_t> hsv((size_t)width * height * 3);
+    for (size_t i = 0; i < (size_t)width * height; i++)
+        BgrToHsv(bgr[i * 3], bgr[i * 3 + 1], bgr[i * 3 + 2], &hsv[i * 3]);
+
+    std::vector<uint8_t> mask((size_t)width * height);
+    for (size_t i = 0; i < mask.size(); i++) {
+        const uint8_t* p = &hsv[i * 3];
+        bool inside = true;
+        for (int c = 0; c < 3; c++)
+            inside = inside && p[c] >= RED.low[c] && p[c] <= RED.high[c];
+        mask[i] = inside ? 255 : 0;
+    }
+
+    HsvMoments moments;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (mask[(size_t)y * width + x] == 255) {
+                moments.count++;
+                moments.sum_x += x;
+                moments.sum_y += y;
+            }
+        }
+    }
+    overflow = moments.sum_x > INT_MAX || moments.sum_y > INT_MAX;
+    return moments;
+}
+
+static bool sameMoments(const HsvMoments& a, const HsvMoments& b)
+{
+    return a.count == b.count && a.sum_x == b.sum_x && a.sum_y == b.sum_y;
+}
+
+static int runFrame(int width, int height, int frames, int threads)
+{
+    std::vector<uint8_t> frame;
+    makeFrame(frame, width, height);
+    double pixels = (double)width * height * frames;
+
+    std::cout << width << "x" << height << ", " << frames << " frames" << std::endl;
+
+    bool overflow = false;
+    HsvMoments reference;
+    double old_time = BenchBest(3, [&]() {
+        for (int f = 0; f < frames; f++)
+            reference = threePass(frame.data(), width, height, overflow);
+    });
+    BenchReport("  old three passes", old_time, pixels);
+    glm::vec2 center = reference.Normalized(width, height);
+    std::cout << "  " << reference.count << " pixels inside, centroid " << center.x << " " << center.y
+        << (overflow ? "  (the old int sums overflow here)" : "") << std::endl;
+
+    int result = 0;
+    Simd_Level best = DetectSimdLevel();
+    for (int level = SIMD_SCALAR; level <= best; level++) {
+        SetHsvKernel((Simd_Level)level);
+        if (HsvKernel() != level)
+            continue; // runs another level's kernel
+        HsvMoments moments;
+        double time = BenchBest(3, [&]() {
+            for (int f = 0; f < frames; f++)
+                moments = HsvThresholdMoments(frame.data(), width, (size_t)width * 3, 0, height, RED);
+        });
+        std::string name = std::string("  fused ") + SimdLevelName((Simd_Level)level) + ", 1 thread";
+        BenchReport(name.c_str(), time, pixels);
+        if (!sameMoments(moments, reference)) {
+            std::cout << "  MISMATCH: " << name << std::endl;
+            result = 1;
+        }
+    }
+
+    HsvCentroid centroid(threads);
+    HsvMoments moments;
+    double time = BenchBest(3, [&]() {
+        for (int f = 0; f < frames; f++)
+            moments = centroid.Run(frame.data(), width, height, (size_t)width * 3, RED);
+    });
+    std::string name = std::string("  fused ") + SimdLevelName(HsvKernel()) + ", " + std::to_string(centroid.Threads()) + " thread(s)";
+    BenchReport(name.c_str(), time, pixels);
+    std::cout << "  ms per frame: old " << old_time / frames * 1000.0 << ", fused " << time / frames * 1000.0 << std::endl;
+    if (!sameMoments(moments, reference)) {
+        std::cout << "  MISMATCH: " << name << std::endl;
+        result = 1;
+    }
+    return result;
+}
+
+// every BGR colour once (4096 x 4096), the kernels against the per pixel reference
+static int checkAllColours()
+{
+    const int size = 4096;
+    std::vector<uint8_t> frame((size_t)size * size * 3);
+    for (uint32_t i = 0; i < (uint32_t)size * size; i++) {
+        frame[i * 3] = (uint8_t)i;
+        frame[i * 3 + 1] = (uint8_t)(i >> 8);
+        frame[i * 3 + 2] = (uint8_t)(i >> 16);
+    }
+
+    const HsvRange ranges[] = { RED, { { 0, 0, 0 }, { 180, 255, 255 } }, { { 20, 40, 60 }, { 90, 200, 240 } }, { { 0, 0, 0 }, { 0, 0, 0 } } };
+    int result = 0;
+    for (const HsvRange& range : ranges) {
+        HsvMoments reference;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                const uint8_t* p = &frame[((size_t)y * size + x) * 3];
+                if (HsvInside(p[0], p[1], p[2], range)) {
+                    reference.count++;
+                    reference.sum_x += x;
+                    reference.sum_y += y;
+                }
+            }
+        }
+        for (int level = SIMD_SCALAR; level <= DetectSimdLevel(); level++) {
+            SetHsvKernel((Simd_Level)level);
+            if (!sameMoments(HsvThresholdMoments(frame.data(), size, (size_t)size * 3, 0, size, range), reference)) {
+                std::cout << "  MISMATCH: " << SimdLevelName(HsvKernel()) << " over all colours" << std::endl;
+                result = 1;
+            }
+        }
+    }
+    SetHsvKernel(DetectSimdLevel());
+    if (result == 0)
+        std::cout << "all 2^24 colours: every kernel matches" << std::endl;
+    return result;
+}
+
+int HsvBench(int argc, char** argv)
+{
+    int frames = 10;
+    int threads = 0;
+    for (int i = 0; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--frames") == 0 && has_value)
+            frames = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && has_value)
+            threads = std::atoi(argv[++i]);
+        else {
+            std::cout << "usage: ICPBench hsv [--frames N] [--threads N]" << std::endl;
+            return -1;
+        }
+    }
+
+    std::cout << "best kernel on this CPU: " << SimdLevelName(DetectSimdLevel()) << std::endl;
+    int result = checkAllColours();
+    const int sizes[][2] = { { 640, 480 }, { 1920, 1080 }, { 3840, 2160 } };
+    for (const auto& size : sizes) {
+        if (runFrame(size[0], size[1], frames, threads) != 0)
+            result = 1;
+    }
+    SetHsvKernel(DetectSimdLevel());
+    return result;
+}
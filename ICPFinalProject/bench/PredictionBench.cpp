@@ -0,0 +1,139 @@
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "Bench.h"
+#include "TrackingPredictor.h"
+#include "Random.h"
+
+/*
+	usage: ICPBench prediction [--log file] [--process-noise Q]
+
+	Error of the game's tracking input: the newest sample as it is (the old behaviour), the
+	Kalman filter without and with extrapolation over the pipeline latency.
+	--log replays raw samples saved next to a recording (ICPFinalProject --record x.rec writes
+	x.rec.tracking), scored against the samples measured next. Without a log a synthetic hand
+	(two sines, 30 fps camera, 40 +- 10 ms latency, centroid noise, 3 % misses) is used and the
+	estimates are also scored against the true position at 60 Hz render times.
+*/
+
+static glm::vec2 handAt(double t)
+{
+    return glm::vec2(0.5f + 0.25f * (float)std::sin(t * 1.9) + 0.05f * (float)std::sin(t * 5.3),
+        0.5f + 0.2f * (float)std::sin(t * 1.3 + 1.0));
+}
+
+static void syntheticSamples(std::vector<TrackingSample>& samples)
+{
+    Random random(3);
+    double t = 0.0;
+    for (int i = 0; i < 30 * 60; i++) {
+        TrackingSample sample;
+        sample.capture_time = t;
+        sample.result_time = t + 0.04 + random.Range(-0.01f, 0.01f);
+        if (random.Float() < 0.03f) {
+            sample.center = glm::vec2(0.0f);
+            sample.confidence = 0.0f;
+        }
+        else {
+            sample.center = handAt(t) + glm::vec2(random.Range(-0.008f, 0.008f), random.Range(-0.008f, 0.008f));
+            sample.confidence = random.Range(0.6f, 1.0f);
+        }
+        samples.push_back(sample);
+        t += 1.0 / 30.0;
+    }
+}
+
+static void report(const char* name, float rms, float p95)
+{
+    std::cout << "  " << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(4)
+        << "rms " << rms << "  p95 " << p95 << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+}
+
+// estimates at 60 Hz render times against the true hand position
+static void scoreAgainstTruth(const std::vector<TrackingSample>& samples, const TrackingPredictorSettings& settings)
+{
+    TrackingPredictorSettings smooth_settings = settings;
+    smooth_settings.predict = false;
+    TrackingPredictor smooth(smooth_settings), predict(settings);
+    std::vector<float> hold_errors, smooth_errors, predict_errors;
+    glm::vec2 hold = glm::vec2(0.5f);
+    size_t next = 0;
+    double end = samples.back().result_time;
+    for (double t = 0.5; t < end; t += 1.0 / 60.0) {
+        while (next < samples.size() && samples[next].result_time <= t) {
+            smooth.Add(samples[next]);
+            predict.Add(samples[next]);
+            hold = samples[next].center;
+            next++;
+        }
+        glm::vec2 truth = handAt(t);
+        hold_errors.push_back(glm::length(hold - truth));
+        smooth_errors.push_back(glm::length(smooth.Predict(t) - truth));
+        predict_errors.push_back(glm::length(predict.Predict(t) - truth));
+    }
+
+    std::cout << "against the true position at 60 Hz render times:" << std::endl;
+    const char* names[] = { "newest sample (old)", "filtered", "filtered + predicted" };
+    std::vector<float>* errors[] = { &hold_errors, &smooth_errors, &predict_errors };
+    for (int i = 0; i < 3; i++) {
+        std::vector<float>& e = *errors[i];
+        double sum = 0.0;
+        for (float v : e)
+            sum += (double)v * v;
+        std::sort(e.begin(), e.end());
+        report(names[i], (float)std::sqrt(sum / e.size()), e[std::min(e.size() - 1, (size_t)(0.95 * e.size()))]);
+    }
+}
+
+int PredictionBench(int argc, char** argv)
+{
+    const char* log = nullptr;
+    TrackingPredictorSettings settings;
+    for (int i = 0; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--log") == 0 && has_value)
+            log = argv[++i];
+        else if (std::strcmp(argv[i], "--process-noise") == 0 && has_value)
+            settings.process_noise = (float)std::atof(argv[++i]);
+        else {
+            std::cout << "usage: ICPBench prediction [--log file] [--process-noise Q]" << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<TrackingSample> samples;
+    if (log) {
+        if (!LoadTrackingSamples(log, samples) || samples.empty()) {
+            std::cout << "can't read tracking samples from " << log << std::endl;
+            return -1;
+        }
+    }
+    else
+        syntheticSamples(samples);
+
+    // per sample work of the consumer
+    TrackingPredictor predictor(settings);
+    double time = BenchBest(5, [&]() {
+        for (const TrackingSample& sample : samples) {
+            predictor.Add(sample);
+            bench_sink = bench_sink + predictor.Predict(sample.result_time).x;
+        }
+    });
+    BenchReport("  Add + Predict", time, (double)samples.size());
+
+    TrackingError error = EvaluateTracking(samples, settings);
+    std::cout << samples.size() << " samples (" << (log ? log : "synthetic") << "), " << error.samples << " scored, average latency "
+        << error.latency_ms << " ms" << std::endl;
+    std::cout << "against the next measured sample:" << std::endl;
+    report("newest sample (old)", error.hold_rms, error.hold_p95);
+    report("filtered", error.smooth_rms, error.smooth_p95);
+    report("filtered + predicted", error.predict_rms, error.predict_p95);
+
+    if (!log)
+        scoreAgainstTruth(samples, settings);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <random>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+
+#include "Bench.h"
+#include "Random.h"
+
+/*
+	usage: ICPBench random [--count N]
+
+	Compares the generator the game used to have (random_device + mt19937 + distribution
+	constructed on every call) with Random, per single number and batched.
+*/
+
+// the original helper from GameApp.cpp, kept verbatim as the baseline
+static float randomFloatInRange(float min, float max) {
+	// Set up random number generation
+	std::random_device rd;
+	std::mt19937 gen(rd());
+	std::uniform_real_distribution<float> dis(min, max);
+
+	// Generate random float
+	return dis(gen);
+}
+
+int RandomBench(int argc, char** argv)
+{
+	size_t count = 1 << 22;
+	for (int i = 0; i < argc; i++) {
+		if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+			count = std::strtoull(argv[++i], nullptr, 10);
+		else {
+			std::cout << "usage: ICPBench random [--count N]" << std::endl;
+			return -1;
+		}
+	}
+	// the baseline is 3-4 orders of magnitude slower, it gets fewer numbers
+	size_t slow_count = count / 256 > 0 ? count / 256 : 1;
+	const int repeats = 5;
+
+	std::vector<float> floats(count);
+	std::vector<glm::vec3> points(count / 3 + 1);
+
+	double old_time = BenchBest(repeats, [&]() {
+		float sum = 0.0f;
+		for (size_t i = 0; i < slow_count; i++)
+			sum += randomFloatInRange(0.1f, 0.5f);
+		bench_sink = sum;
+	});
+	BenchReport("old randomFloatInRange", old_time, (double)slow_count);
+
+	std::mt19937 mt(1);
+	double mt_time = BenchBest(repeats, [&]() {
+		std::uniform_real_distribution<float> dis(0.1f, 0.5f);
+		float sum = 0.0f;
+		for (size_t i = 0; i < count; i++)
+			sum += dis(mt);
+		bench_sink = sum;
+	});
+	BenchReport("mt19937 kept + distribution", mt_time, (double)count);
+
+	Random random(1);
+	double single_time = BenchBest(repeats, [&]() {
+		float sum = 0.0f;
+		for (size_t i = 0; i < count; i++)
+			sum += random.Range(0.1f, 0.5f);
+		bench_sink = sum;
+	});
+	BenchReport("Random::Range", single_time, (double)count);
+
+	double fill_time = BenchBest(repeats, [&]() {
+		random.FillRange(floats.data(), count, 0.1f, 0.5f);
+		bench_sink = floats[count / 2];
+	});
+	BenchReport("Random::FillRange", fill_time, (double)count);
+
+	double box_time = BenchBest(repeats, [&]() {
+		random.FillInBox(points.data(), points.size(), glm::vec3(-5.0f, 0.5f, -5.0f), glm::vec3(5.0f, 3.0f, 5.0f));
+		bench_sink = points[points.size() / 2].y;
+	});
+	BenchReport("Random::FillInBox (per float)", box_time, points.size() * 3.0);
+
+	double old_per_number = old_time / slow_count;
+	std::cout << std::endl << "speedup vs old: Range " << old_per_number / (single_time / count)
+		<< "x, FillRange " << old_per_number / (fill_time / count) << "x" << std::endl;
+	// what the flame loop used to cost per frame (100 particles x 3 numbers)
+	std::cout << "300 numbers per frame: old " << old_per_number * 300 * 1e3 << " ms, now "
+		<< fill_time / count * 300 * 1e3 << " ms" << std::endl;
+
+	// batched and single versions have to give the same sequence
+	Random a(42, 7), b(42, 7);
+	float batch[64];
+	a.FillRange(batch, 64, -1.0f, 1.0f);
+	for (int i = 0; i < 64; i++) {
+		if (batch[i] != b.Range(-1.0f, 1.0f)) {
+			std::cout << "FillRange differs from Range at " << i << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
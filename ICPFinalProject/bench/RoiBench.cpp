@@ -0,0 +1,104 @@
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+
+#include "Bench.h"
+#include "RoiTracker.h"
+#include "SyntheticFrames.h"
+
+/*
+	usage: ICPBench roi [--frames N] [--size WxH]
+
+	Tracks the synthetic ball (SyntheticFrames) at 60 fps, 640x480 and 1920x1080 (or WxH):
+	moving for the first half, still for a quarter, moving again. Full frame thresholding (the
+	pipeline before, one thread) against RoiTracker: pixels read per frame, CPU time of the
+	tracking thread per frame and as a share of one core at 60 fps, skipped frames, coarse
+	searches and the centroid error against the true ball position.
+*/
+
+struct RunStats {
+    double cpu = 0.0; // seconds
+    uint64_t pixels = 0;
+    double error_sum = 0.0;
+    double error_max = 0.0;
+    int scored = 0;
+    int skipped = 0;
+    int searched = 0;
+};
+
+static void printStats(const char* name, const RunStats& stats, int frames)
+{
+    double ms = stats.cpu / frames * 1000.0;
+    std::printf("  %-12s %10.0f px/frame %8.3f ms/frame CPU %6.1f %% of a core at 60 fps   error px: avg %.2f max %.2f\n",
+        name, (double)stats.pixels / frames, ms, ms * 60.0 / 10.0, stats.error_sum / std::max(1, stats.scored), stats.error_max);
+}
+
+static void score(RunStats& stats, glm::vec2 center, glm::vec2 truth, int width, int height)
+{
+    double error = glm::length((center - truth) * glm::vec2((float)width, (float)height));
+    stats.error_sum += error;
+    stats.error_max = std::max(stats.error_max, error);
+    stats.scored++;
+}
+
+static void runSize(int width, int height, int frames)
+{
+    SyntheticFrames synthetic(width, height);
+    std::vector<uint8_t> frame((size_t)width * height * 3);
+    size_t stride = (size_t)width * 3;
+    RoiTracker roi;
+    RunStats full, tracked;
+
+    double time = 0.0, ball_time = 0.0;
+    for (int f = 0; f < frames; f++) {
+        bool still = f >= frames / 2 && f < frames * 3 / 4;
+        glm::vec2 truth = synthetic.Render(frame.data(), stride, ball_time);
+
+        double start = ThreadCpuSeconds();
+        HsvMoments moments = HsvThresholdMoments(frame.data(), width, stride, 0, height, roi.range);
+        full.cpu += ThreadCpuSeconds() - start;
+        full.pixels += (uint64_t)width * height;
+        score(full, moments.Normalized(width, height), truth, width, height);
+
+        start = ThreadCpuSeconds();
+        RoiResult result = roi.Track(frame.data(), width, height, stride, time);
+        tracked.cpu += ThreadCpuSeconds() - start;
+        tracked.pixels += result.pixels;
+        tracked.skipped += result.skipped;
+        tracked.searched += result.searched;
+        score(tracked, result.center, truth, width, height);
+
+        time += 1.0 / 60.0;
+        if (!still)
+            ball_time += 1.0 / 60.0;
+    }
+
+    std::cout << width << "x" << height << ", " << frames << " frames (" << SimdLevelName(HsvKernel()) << " kernel)" << std::endl;
+    printStats("full frame", full, frames);
+    printStats("ROI", tracked, frames);
+    std::cout << "  ROI: " << tracked.skipped << " frames skipped (no motion), " << tracked.searched << " coarse searches" << std::endl;
+}
+
+int RoiBench(int argc, char** argv)
+{
+    int frames = 600;
+    std::vector<std::pair<int, int>> sizes = { { 640, 480 }, { 1920, 1080 } };
+    for (int i = 0; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        int width, height;
+        if (std::strcmp(argv[i], "--frames") == 0 && has_value)
+            frames = std::max(4, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--size") == 0 && has_value && std::sscanf(argv[++i], "%dx%d", &width, &height) == 2)
+            sizes = { { width, height } };
+        else {
+            std::cout << "usage: ICPBench roi [--frames N] [--size WxH]" << std::endl;
+            return -1;
+        }
+    }
+
+    for (const auto& size : sizes)
+        runSize(size.first, size.second, frames);
+    return 0;
+}
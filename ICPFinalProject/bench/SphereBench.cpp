@@ -0,0 +1,104 @@
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+
+#include "Bench.h"
+#include "SphereBatch.h"
+#include "Random.h"
+
+/*
+	usage: ICPBench spheres [--count N]
+
+	One probe sphere against 1k / 10k / 100k / 1M candidates (or N): every kernel the CPU
+	supports, plus the old per-object test (glm::vec3, doubles, sqrt) the game used to do.
+	All kernels have to produce the same hit mask.
+*/
+
+// the collision test the game did before, kept as the baseline
+static bool areVectorsInRange(glm::vec3 vector1, glm::vec3 vector2, float range) {
+    double distanceSquared = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        double diff = vector1[i] - vector2[i];
+        distanceSquared += diff * diff;
+    }
+    double distance = std::sqrt(distanceSquared);
+    return distance <= range;
+}
+
+static int runSpheres(size_t count)
+{
+    const int probes = 16;
+    int repeats = count >= 1000000 ? 3 : 10;
+
+    Random random(1);
+    SphereSoA spheres;
+    std::vector<glm::vec3> centers(count);
+    random.FillInBox(centers.data(), count, glm::vec3(-50.0f), glm::vec3(50.0f));
+    for (size_t i = 0; i < count; i++)
+        spheres.Push(centers[i], random.Range(0.2f, 0.6f));
+    std::vector<glm::vec3> probe(probes);
+    random.FillInBox(probe.data(), probes, glm::vec3(-50.0f), glm::vec3(50.0f));
+
+    size_t words = (count + 63) / 64;
+    std::vector<uint64_t> reference(words * probes), mask(words * probes);
+
+    std::cout << count << " candidates, " << probes << " probes (r 2.0)" << std::endl;
+
+    int hits = 0;
+    double old_time = BenchBest(repeats, [&]() {
+        hits = 0;
+        for (int p = 0; p < probes; p++)
+            for (size_t i = 0; i < count; i++)
+                hits += areVectorsInRange(probe[p], spheres.Center(i), spheres.radius[i] + 2.0f);
+    });
+    BenchReport("  old areVectorsInRange", old_time, (double)count * probes);
+
+    int result = 0;
+    Simd_Level best = DetectSimdLevel();
+    for (int level = SIMD_SCALAR; level <= best; level++) {
+        SetSphereKernel((Simd_Level)level);
+        int kernel_hits = 0;
+        double time = BenchBest(repeats, [&]() {
+            kernel_hits = 0;
+            for (int p = 0; p < probes; p++)
+                kernel_hits += SphereOverlapMask(spheres, probe[p], 2.0f, mask.data() + p * words);
+        });
+        std::string name = std::string("  ") + SimdLevelName((Simd_Level)level);
+        BenchReport(name.c_str(), time, (double)count * probes);
+
+        if (level == SIMD_SCALAR)
+            reference = mask;
+        else if (mask != reference) {
+            std::cout << "  MISMATCH: " << SimdLevelName((Simd_Level)level) << " differs from scalar" << std::endl;
+            result = 1;
+        }
+        // the double / sqrt version can disagree on exact touches only
+        if (kernel_hits != hits)
+            std::cout << "  (" << kernel_hits << " hits vs " << hits << " of the double precision test)" << std::endl;
+    }
+    SetSphereKernel(best);
+    return result;
+}
+
+int SphereBench(int argc, char** argv)
+{
+    std::vector<size_t> counts = { 1000, 10000, 100000, 1000000 };
+    for (int i = 0; i < argc; i++) {
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            counts = { (size_t)std::strtoull(argv[++i], nullptr, 10) };
+        else {
+            std::cout << "usage: ICPBench spheres [--count N]" << std::endl;
+            return -1;
+        }
+    }
+
+    std::cout << "best kernel on this CPU: " << SimdLevelName(DetectSimdLevel()) << std::endl;
+    int result = 0;
+    for (size_t count : counts) {
+        if (runSpheres(count) != 0)
+            result = 1;
+    }
+    return result;
+}
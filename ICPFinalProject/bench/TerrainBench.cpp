@@ -0,0 +1,137 @@
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "Bench.h"
+#include "Terrain.h"
+
+/*
+	usage: ICPBench terrain [--frames N]
+
+	Heightmap build time, height queries (what collision costs), then N frames (default 200)
+	of a flythrough with TerrainLod at a few view distances: selection time, patches and
+	vertices per frame against the full resolution grid of the same area.
+	Checks every frame that no patch has a vertex in the middle of a neighbour's edge
+	(a T-junction = a crack), using the same stitching as terrain.vert.
+*/
+
+// grid vertices on the edges of a patch, after stitching
+static void edgeVertices(const TerrainPatch& patch, std::vector<glm::vec2>& out)
+{
+    out.clear();
+    for (int k = 0; k <= PATCH_GRID; k++) {
+        out.push_back(patch.Vertex(k, 0));
+        out.push_back(patch.Vertex(k, PATCH_GRID));
+        out.push_back(patch.Vertex(0, k));
+        out.push_back(patch.Vertex(PATCH_GRID, k));
+    }
+}
+
+static bool onBoundary(const TerrainPatch& patch, const glm::vec2& p)
+{
+    const float e = 1e-3f;
+    glm::vec2 max = patch.origin + patch.size;
+    bool insideX = p.x > patch.origin.x - e && p.x < max.x + e;
+    bool insideZ = p.y > patch.origin.y - e && p.y < max.y + e;
+    bool onX = std::abs(p.x - patch.origin.x) < e || std::abs(p.x - max.x) < e;
+    bool onZ = std::abs(p.y - patch.origin.y) < e || std::abs(p.y - max.y) < e;
+    return insideX && insideZ && (onX || onZ);
+}
+
+// vertices of one patch that lie on another patch's edge without being one of its vertices
+static size_t countCracks(const std::vector<TerrainPatch>& patches)
+{
+    std::vector<std::vector<glm::vec2>> edges(patches.size());
+    for (size_t i = 0; i < patches.size(); i++)
+        edgeVertices(patches[i], edges[i]);
+
+    size_t cracks = 0;
+    for (size_t i = 0; i < patches.size(); i++) {
+        for (size_t j = 0; j < patches.size(); j++) {
+            if (i == j)
+                continue;
+            for (const glm::vec2& v : edges[i]) {
+                if (!onBoundary(patches[j], v))
+                    continue;
+                bool shared = std::any_of(edges[j].begin(), edges[j].end(), [&](const glm::vec2& w) {
+                    return std::abs(w.x - v.x) < 1e-3f && std::abs(w.y - v.y) < 1e-3f;
+                });
+                if (!shared)
+                    cracks++;
+            }
+        }
+    }
+    return cracks;
+}
+
+int TerrainBench(int argc, char** argv)
+{
+    int frames = 200;
+    for (int i = 0; i < argc; i++) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::cout << "usage: ICPBench terrain [--frames N]" << std::endl;
+            return -1;
+        }
+    }
+
+    const unsigned int seed = 1;
+    std::vector<float> texels;
+    double build_time = BenchBest(3, [&]() { BuildHeightmap(seed, texels); });
+    std::cout << "heightmap " << HEIGHTMAP_SIZE << " x " << HEIGHTMAP_SIZE << " (" << TERRAIN_PERIOD << " units, repeats), built in "
+        << build_time * 1000.0 << " ms" << std::endl;
+
+    const int queries = 100000;
+    double query_time = BenchBest(5, [&]() {
+        float sum = 0.0f;
+        for (int i = 0; i < queries; i++)
+            sum += TerrainHeight(seed, i * 0.37f, i * 0.73f);
+        bench_sink = bench_sink + sum;
+    });
+    BenchReport("  TerrainHeight", query_time, queries);
+
+    // the query has to give what the texture holds (texel centres = grid points)
+    int result = 0;
+    for (int j = 0; j < HEIGHTMAP_SIZE; j += 7) {
+        for (int i = 0; i < HEIGHTMAP_SIZE; i += 7) {
+            if (TerrainHeight(seed, i * HEIGHTMAP_SPACING, j * HEIGHTMAP_SPACING) != texels[j * HEIGHTMAP_SIZE + i])
+                result = 1;
+        }
+    }
+    if (result != 0)
+        std::cout << "  MISMATCH: TerrainHeight differs from the heightmap texels" << std::endl;
+
+    const float distances[3] = { 100.0f, 200.0f, 350.0f };
+    std::vector<TerrainPatch> patches;
+    for (float distance : distances) {
+        TerrainLod lod;
+        lod.view_distance = distance;
+        size_t most_patches = 0, vertices = 0, cracks = 0;
+        double select_seconds = 0.0;
+        for (int f = 0; f < frames; f++) {
+            // a curvy flight at changing altitude, 20 units per frame
+            float t = f * 0.05f;
+            glm::vec3 eye = glm::vec3(f * 20.0f, 3.0f + 20.0f * (0.5f + 0.5f * std::sin(t)), 300.0f * std::sin(t * 0.5f));
+            glm::vec3 forward = glm::normalize(glm::vec3(1.0f, -0.2f, 0.5f * std::cos(t * 0.5f)));
+            double start = NowSeconds();
+            lod.Select(eye, forward, patches);
+            select_seconds += NowSeconds() - start;
+            most_patches = std::max(most_patches, patches.size());
+            vertices += patches.size() * (PATCH_GRID + 1) * (PATCH_GRID + 1);
+            cracks += countCracks(patches);
+        }
+        // the same disc at the finest level: one vertex per texel
+        double full = 3.14159 * distance * distance / (HEIGHTMAP_SPACING * HEIGHTMAP_SPACING);
+        std::cout << "  view distance " << distance << ": select " << select_seconds / frames * 1e6 << " us/frame, "
+            << "patches up to " << most_patches << ", " << vertices / frames << " vertices/frame (full resolution disc: "
+            << (size_t)full << ")" << std::endl;
+        if (cracks > 0) {
+            std::cout << "  MISMATCH: " << cracks << " T-junctions between patches" << std::endl;
+            result = 1;
+        }
+    }
+    return result;
+}
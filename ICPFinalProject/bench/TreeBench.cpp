@@ -0,0 +1,134 @@
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <glm/ext.hpp>
+
+#include "Bench.h"
+#include "ChunkStreamer.h"
+#include "Vegetation.h"
+
+/*
+	usage: ICPBench trees [--count N]
+
+	Places 10k / 100k trees (or N) the way the world does, chunk by chunk around the origin
+	(ChunkTrees, density per chunk), then sorts them into mesh / impostor instances seen from
+	a viewer turning around on the spot. Reports the CPU cost per tree, how many trees end up
+	as which, and the draw calls against drawing every tree on its own.
+	Checks that no visible tree is lost.
+*/
+
+static int runTrees(size_t count)
+{
+    const unsigned int seed = 1;
+    const int frames = 36;
+
+    // whole rings of chunks until there are enough trees
+    std::vector<glm::vec4> trees, chunk;
+    int chunks = 0;
+    for (int ring = 0; trees.size() < count; ring++) {
+        for (int z = -ring; z <= ring; z++) {
+            for (int x = -ring; x <= ring; x++) {
+                if (std::max(std::abs(x), std::abs(z)) != ring)
+                    continue;
+                ChunkCoord coord;
+                coord.x = x;
+                coord.z = z;
+                ChunkTrees(seed, coord, chunk);
+                trees.insert(trees.end(), chunk.begin(), chunk.end());
+                chunks++;
+            }
+        }
+    }
+    trees.resize(count);
+
+    double place_time = BenchBest(5, [&]() {
+        size_t placed = 0;
+        for (int i = 0; i < chunks; i++) {
+            ChunkCoord coord;
+            coord.x = i;
+            ChunkTrees(seed, coord, chunk);
+            placed += chunk.size();
+        }
+        bench_sink = bench_sink + (float)placed;
+    });
+    std::cout << count << " trees in " << chunks << " chunks (" << (double)count / chunks << " per chunk on average), "
+        << frames << " view directions" << std::endl;
+    BenchReport("  ChunkTrees, per chunk", place_time, (double)chunks);
+
+    VegetationBatch batch;
+    glm::vec3 eye = glm::vec3(0.0f, 5.0f, 0.0f);
+    auto forward = [&](int frame) {
+        float angle = glm::two_pi<float>() * frame / frames;
+        return glm::vec3(std::sin(angle), -0.2f, std::cos(angle));
+    };
+    double sort_time = BenchBest(5, [&]() {
+        for (int f = 0; f < frames; f++) {
+            batch.Begin(eye, forward(f));
+            batch.Add(trees.data(), trees.size());
+            bench_sink = bench_sink + (float)batch.Near().size();
+        }
+    });
+    BenchReport("  VegetationBatch, per tree", sort_time, (double)count * frames);
+
+    // totals over the turn, at the game's view distance and with every tree in view distance,
+    // and the check: every tree in range and in front is in a list
+    const float ranges[2] = { batch.settings.max_distance, 1e6f };
+    int result = 0;
+    for (float range : ranges) {
+        batch.settings.max_distance = range;
+        size_t near = 0, far = 0, culled = 0, lost = 0;
+        for (int f = 0; f < frames; f++) {
+            batch.Begin(eye, forward(f));
+            batch.Add(trees.data(), trees.size());
+            near += batch.Near().size();
+            far += batch.Far().size();
+            culled += batch.Culled();
+
+            glm::vec2 ahead = glm::normalize(glm::vec2(forward(f).x, forward(f).z));
+            size_t visible = 0;
+            for (const glm::vec4& tree : trees) {
+                glm::vec2 d = glm::vec2(tree.x - eye.x, tree.z - eye.z);
+                float distance = glm::length(d);
+                if (distance <= range && glm::dot(d, ahead) >= distance * std::cos(glm::radians(batch.settings.half_fov_degrees)))
+                    visible++;
+            }
+            size_t listed = count - batch.Culled();
+            if (listed < visible)
+                lost += visible - listed;
+        }
+        size_t instances = (near + far) / frames;
+        std::cout << "  view distance " << (range < 1e5f ? std::to_string((int)range) : std::string("unlimited")) << ", per frame: "
+            << near / frames << " meshes, " << far / frames << " impostors, " << culled / frames << " culled" << std::endl;
+        std::cout << "    draw calls: 3 instanced (" << instances * sizeof(glm::vec4) / 1024 << " kB of instances) vs "
+            << 2 * instances << " one tree at a time" << std::endl;
+        if (lost > 0) {
+            std::cout << "  MISMATCH: " << lost / frames << " visible trees per frame not drawn" << std::endl;
+            result = 1;
+        }
+    }
+    return result;
+}
+
+int TreeBench(int argc, char** argv)
+{
+    std::vector<size_t> counts = { 10000, 100000 };
+    for (int i = 0; i < argc; i++) {
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            counts = { (size_t)std::strtoull(argv[++i], nullptr, 10) };
+        else {
+            std::cout << "usage: ICPBench trees [--count N]" << std::endl;
+            return -1;
+        }
+    }
+
+    int result = 0;
+    for (size_t count : counts) {
+        if (count < 1)
+            count = 1;
+        if (runTrees(count) != 0)
+            result = 1;
+    }
+    return result;
+}
@@ -0,0 +1,51 @@
+#include <iostream>
+#include <cstring>
+
+#include "Bench.h"
+
+/*
+	Microbenchmarks without a window or GPU.
+
+	usage: ICPBench <benchmark> [options]
+*/
+
+struct BenchEntry {
+	const char* name;
+	const char* description;
+	int (*run)(int argc, char** argv);
+};
+
+static const BenchEntry benchmarks[] = {
+	{ "random", "Random (PCG32) vs the old per-call random_device + mt19937", RandomBench },
+	{ "collision", "CollisionWorld spatial hash, 1k - 100k spheres, vs brute force", CollisionBench },
+	{ "spheres", "SIMD batch sphere kernels (scalar / SSE / AVX2 / AVX-512), 1k - 1M candidates", SphereBench },
+	{ "bvh", "TriangleBVH build time and ray / sphere sweep throughput on the level meshes", BVHBench },
+	{ "entities", "EntityPool update and remove / spawn of 10k - 100k entities vs an array of structs", EntityBench },
+	{ "chunks", "ChunkStreamer flythrough: chunk load latency, per frame cost and memory", ChunkBench },
+	{ "trees", "Vegetation: 10k / 100k trees sorted into instanced meshes and impostors", TreeBench },
+	{ "terrain", "Heightmap terrain: height queries and quadtree LOD patches / vertices per frame, crack check", TerrainBench },
+	{ "hsv", "Colour tracking: fused SIMD HSV threshold + centroid vs the old three passes, 480p / 1080p / 4K", HsvBench },
+	{ "prediction", "Tracking input error: newest sample vs Kalman filter vs filter + latency prediction (synthetic or a recorded log)", PredictionBench },
+	{ "roi", "Region of interest tracking with motion skip vs full frame thresholding: pixels and CPU per frame, error", RoiBench },
+};
+
+static void print_usage()
+{
+	std::cout << "usage: ICPBench <benchmark> [options]" << std::endl;
+	for (const BenchEntry& entry : benchmarks)
+		std::cout << "  " << entry.name << " - " << entry.description << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		print_usage();
+		return -1;
+	}
+	for (const BenchEntry& entry : benchmarks) {
+		if (std::strcmp(argv[1], entry.name) == 0)
+			return entry.run(argc - 2, argv + 2);
+	}
+	print_usage();
+	return -1;
+}
@@ -0,0 +1,213 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+
+#include "Simulation.h"
+#include "InputScript.h"
+#include "InputRecording.h"
+#include "TriangleBVH.h"
+#include "Timing.h"
+
+/*
+	Headless fast-forward runner: plays N game sessions without a window, GPU or camera,
+	as fast as the CPU allows (optionally on all cores), and reports tick throughput
+	and outcome statistics.
+
+	usage: ICPHeadless [--sessions N] [--ticks N] [--threads N] [--script idle|random|autopilot] [--seed N]
+	                   [--record file]   (single session: record its seed and inputs)
+	                   [--flat]          (no level geometry, heightmap ground only)
+	       ICPHeadless --replay file [--flat]  (replay a recording from the game or headless and verify it)
+
+	The level geometry is loaded from resources/ like in the game - run it from the project directory.
+*/
+
+struct SessionResult {
+	unsigned long long ticks = 0;
+	int score = 0;
+	double collision_seconds = 0.0;
+	Game_Over game_over = GAME_RUNNING; // GAME_RUNNING = hit the tick limit
+};
+
+struct HeadlessOptions {
+	int sessions = 1000;
+	unsigned long long max_ticks = 60 * 60 * 5; // 5 minutes of game time
+	int threads = 0; // 0 = all cores
+	Input_Script script = SCRIPT_AUTOPILOT;
+	unsigned int seed = 1; // session i runs with seed + i
+	std::string record_path;
+	std::string replay_path;
+	bool flat = false;
+};
+
+// level geometry shared read-only by all sessions
+static TriangleBVH terrain;
+
+static const TriangleBVH* session_terrain(const HeadlessOptions& options)
+{
+	return options.flat || terrain.Empty() ? nullptr : &terrain;
+}
+
+static SessionResult run_session(const HeadlessOptions& options, int index)
+{
+	Simulation simulation(options.seed + (unsigned int)index, session_terrain(options));
+	InputScript script(options.script, options.seed + (unsigned int)index);
+	InputRecorder recorder;
+	SessionResult result;
+	if (!options.record_path.empty())
+		recorder.Open(options.record_path, simulation.seed, Simulation::TICK_DT);
+
+	while (simulation.game_over == GAME_RUNNING && simulation.tick < options.max_ticks) {
+		InputState input = script.Next(simulation);
+		recorder.Record(simulation.tick, input);
+		simulation.Tick(input, Simulation::TICK_DT);
+		result.collision_seconds += simulation.collision_seconds;
+	}
+	recorder.Close(simulation.tick, simulation.StateHash());
+
+	result.ticks = simulation.tick;
+	result.score = simulation.score;
+	result.game_over = simulation.game_over;
+	return result;
+}
+
+// replays a recording as fast as possible, returns 0 when it reproduced the recorded state bit-exactly
+static int run_replay(const HeadlessOptions& options)
+{
+	const std::string& path = options.replay_path;
+	InputPlayer player;
+	if (!player.Open(path))
+		return -1;
+	if (player.TickDt() != Simulation::TICK_DT)
+		std::cout << "warning: recorded with a different tick length (" << player.TickDt() << " s)" << std::endl;
+
+	double start = NowSeconds();
+	Simulation simulation(player.Seed(), session_terrain(options));
+	while (!player.Finished(simulation.tick))
+		simulation.Tick(player.InputFor(simulation.tick), Simulation::TICK_DT);
+	double elapsed = NowSeconds() - start;
+
+	std::cout << "replayed " << simulation.tick << " ticks in " << elapsed << " s (" << simulation.tick / elapsed << " ticks/s)" << std::endl;
+	std::cout << "score: " << simulation.score << "  outcome: " << simulation.game_over << std::endl;
+	if (!player.Verifiable()) {
+		std::cout << "recording has no end marker, nothing to verify" << std::endl;
+		return 0;
+	}
+	if (simulation.StateHash() != player.ExpectedHash()) {
+		std::cout << "DIVERGED: state hash " << std::hex << simulation.StateHash() << " != recorded " << player.ExpectedHash() << std::dec << std::endl;
+		return 1;
+	}
+	std::cout << "bit-exact" << std::endl;
+	return 0;
+}
+
+static void print_usage()
+{
+	std::cout << "usage: ICPHeadless [--sessions N] [--ticks N] [--threads N] [--script idle|random|autopilot] [--seed N] [--record file] [--flat]" << std::endl;
+	std::cout << "       ICPHeadless --replay file [--flat]" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, HeadlessOptions& options)
+{
+	for (int i = 1; i < argc; i++) {
+		bool has_value = i + 1 < argc;
+		if (std::strcmp(argv[i], "--sessions") == 0 && has_value)
+			options.sessions = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--ticks") == 0 && has_value)
+			options.max_ticks = std::strtoull(argv[++i], nullptr, 10);
+		else if (std::strcmp(argv[i], "--threads") == 0 && has_value)
+			options.threads = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--script") == 0 && has_value) {
+			if (!InputScript::FromName(argv[++i], options.script))
+				return false;
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && has_value)
+			options.seed = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		else if (std::strcmp(argv[i], "--record") == 0 && has_value)
+			options.record_path = argv[++i];
+		else if (std::strcmp(argv[i], "--replay") == 0 && has_value)
+			options.replay_path = argv[++i];
+		else if (std::strcmp(argv[i], "--flat") == 0)
+			options.flat = true;
+		else
+			return false;
+	}
+	// one recording file = one session
+	if (!options.record_path.empty() && options.sessions != 1)
+		return false;
+	return options.sessions > 0 && options.threads >= 0;
+}
+
+int main(int argc, char** argv)
+{
+	HeadlessOptions options;
+	if (!parse_options(argc, argv, options)) {
+		print_usage();
+		return -1;
+	}
+	if (!options.flat) {
+		if (Simulation::LoadTerrain(terrain))
+			std::cout << "terrain: " << terrain.TriangleCount() << " triangles, BVH built in " << terrain.build_seconds * 1000.0 << " ms" << std::endl;
+		else
+			std::cout << "level geometry not found, heightmap ground only" << std::endl;
+	}
+	if (!options.replay_path.empty())
+		return run_replay(options);
+
+	int threads = options.threads;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::min(threads, options.sessions);
+
+	std::vector<SessionResult> results(options.sessions);
+	std::atomic<int> next_session(0);
+
+	double start = NowSeconds();
+
+	// workers pull session indices until all are done
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; t++) {
+		workers.emplace_back([&]() {
+			for (int i = next_session++; i < options.sessions; i = next_session++)
+				results[i] = run_session(options, i);
+		});
+	}
+	for (auto& worker : workers)
+		worker.join();
+
+	double elapsed = NowSeconds() - start;
+
+	// statistics
+	unsigned long long total_ticks = 0;
+	long long total_score = 0;
+	double collision_seconds = 0.0;
+	int min_score = results[0].score, max_score = results[0].score;
+	int outcomes[3] = { 0, 0, 0 };
+	for (const SessionResult& result : results) {
+		total_ticks += result.ticks;
+		total_score += result.score;
+		collision_seconds += result.collision_seconds;
+		min_score = std::min(min_score, result.score);
+		max_score = std::max(max_score, result.score);
+		outcomes[result.game_over]++;
+	}
+
+	std::cout << "sessions: " << options.sessions << "  threads: " << threads << std::endl;
+	std::cout << "wall time: " << elapsed << " s" << std::endl;
+	std::cout << "ticks: " << total_ticks << "  (" << total_ticks / elapsed << " ticks/s, "
+		<< total_ticks / elapsed / threads << " ticks/s per thread, "
+		<< total_ticks * Simulation::TICK_DT / elapsed << "x real time)" << std::endl;
+	std::cout << "collision: " << collision_seconds / total_ticks * 1e6 << " us per tick ("
+		<< collision_seconds / (elapsed * threads) * 100.0 << " % of the time)" << std::endl;
+	std::cout << "avg session: " << (double)total_ticks / options.sessions * Simulation::TICK_DT << " s of game time" << std::endl;
+	std::cout << "score: avg " << (double)total_score / options.sessions << "  min " << min_score << "  max " << max_score << std::endl;
+	std::cout << "outcome: bomb " << outcomes[GAME_OVER_BOMB]
+		<< "  ground " << outcomes[GAME_OVER_GROUND]
+		<< "  tick limit " << outcomes[GAME_RUNNING] << std::endl;
+
+	return 0;
+}
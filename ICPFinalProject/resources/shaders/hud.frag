@@ -0,0 +1,13 @@
+#version 330 core
+
+in vec2 TexCoords;
+in vec4 Color;
+
+out vec4 FragColor;
+
+uniform sampler2D font; // coverage in red, the last glyph is a solid block for plain quads
+
+void main()
+{
+    FragColor = vec4(Color.rgb, Color.a * texture(font, TexCoords).r);
+}
@@ -0,0 +1,30 @@
+#version 330 core
+
+in vec2 TexCoords;
+in float Fade;
+
+out vec4 FragColor;
+
+uniform sampler2D atlasColor;
+uniform sampler2D atlasNormal;
+uniform vec3 lightDir;
+
+// same pattern as vegetation.frag, this one keeps the pixels the mesh discards
+float dither()
+{
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(gl_FragCoord.xy) % 4;
+    return (bayer[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+
+void main()
+{
+    vec4 color = texture(atlasColor, TexCoords);
+    if (color.a < 0.5 || Fade <= dither())
+        discard;
+
+    // baked normals are in world space (trees are not rotated)
+    vec3 norm = normalize(texture(atlasNormal, TexCoords).xyz * 2.0 - 1.0);
+    float diff = max(dot(norm, -lightDir), 0.0);
+    FragColor = vec4(color.rgb * (0.25 + 0.6 * diff), 1.0);
+}
@@ -0,0 +1,33 @@
+#version 330 core
+
+layout (location = 0) in vec2 aCorner;   // x -0.5 .. 0.5, y 0 .. 1
+layout (location = 3) in vec4 aTree;     // per instance: base xyz, height w
+
+out vec2 TexCoords;
+out float Fade;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+uniform float fadeStart;
+uniform float fadeEnd;
+uniform int frames;  // views around the tree in the atlas
+uniform float width; // of the quad, relative to the height
+
+void main()
+{
+    // turns around the trunk only (cylindrical billboard), like the baked views
+    vec2 toCam = viewPos.xz - aTree.xz;
+    float len = length(toCam);
+    toCam = len > 0.0001 ? toCam / len : vec2(0.0, 1.0);
+    vec3 right = vec3(toCam.y, 0.0, -toCam.x);
+
+    // frame k was baked from angle 2 pi k / frames (0 = from +z)
+    float angle = atan(toCam.x, toCam.y);
+    int frame = int(mod(floor(angle / 6.28318530718 * float(frames) + 0.5), float(frames)));
+    TexCoords = vec2((float(frame) + aCorner.x + 0.5) / float(frames), aCorner.y);
+
+    Fade = smoothstep(fadeStart, fadeEnd, len);
+    vec3 world = aTree.xyz + (right * aCorner.x * width + vec3(0.0, aCorner.y, 0.0)) * aTree.w;
+    gl_Position = projection * view * vec4(world, 1.0);
+}
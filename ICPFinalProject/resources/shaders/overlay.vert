@@ -0,0 +1,13 @@
+#version 330 core
+
+out vec2 TexCoords;
+
+uniform vec4 rect; // x0, y0, x1, y1 in normalized device coordinates
+
+// quad as a triangle strip from gl_VertexID, no vertex buffer
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    TexCoords = vec2(corner.x, 1.0 - corner.y); // images are stored top row first
+    gl_Position = vec4(mix(rect.xy, rect.zw, corner), 0.0, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+in vec3 TexCoords;
+
+out vec4 FragColor;
+
+uniform samplerCube skybox;
+
+void main()
+{
+    // unlit - just the baked sky colour
+    FragColor = texture(skybox, TexCoords);
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+out vec3 TexCoords; // direction into the cubemap
+
+uniform mat4 view; // rotation only, translation is stripped on the CPU side
+uniform mat4 projection;
+
+void main()
+{
+    TexCoords = aPos;
+    vec4 pos = projection * view * vec4(aPos, 1.0);
+    gl_Position = pos.xyww; // z = w -> depth 1.0 after the perspective divide (far plane)
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#version 330 core
+
+layout (location = 0) in vec2 aGrid;   // vertex of the shared patch, 0 .. patchGrid
+layout (location = 3) in vec4 aPatch;  // per instance: corner x, z, size, stitch bits
+
+out vec2 TexCoords;
+out vec3 FragPos;
+out vec3 Normal;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform sampler2D heightmap;
+uniform int heightmapSize; // power of two, wraps with &
+uniform float spacing;     // world units between texels
+uniform int patchGrid;
+uniform float groundRepeat; // world units per repeat of the ground texture
+
+float texel(ivec2 p)
+{
+    return texelFetch(heightmap, p & (heightmapSize - 1), 0).r;
+}
+
+// bilinear between the texels, the same as TerrainHeight on the CPU
+float height(vec2 xz)
+{
+    vec2 f = xz / spacing;
+    vec2 i = floor(f);
+    vec2 t = f - i;
+    ivec2 p = ivec2(i);
+    float a = mix(texel(p), texel(p + ivec2(1, 0)), t.x);
+    float b = mix(texel(p + ivec2(0, 1)), texel(p + ivec2(1, 1)), t.x);
+    return mix(a, b, t.y);
+}
+
+void main()
+{
+    // same as TerrainPatch::Vertex: odd vertices on an edge next to a coarser patch fold onto the even ones
+    ivec2 g = ivec2(aGrid + 0.5);
+    int stitch = int(aPatch.w + 0.5);
+    if (g.y == 0 && (stitch & 1) != 0)
+        g.x -= g.x % 2;
+    if (g.x == patchGrid && (stitch & 2) != 0)
+        g.y -= g.y % 2;
+    if (g.y == patchGrid && (stitch & 4) != 0)
+        g.x -= g.x % 2;
+    if (g.x == 0 && (stitch & 8) != 0)
+        g.y -= g.y % 2;
+    vec2 xz = aPatch.xy + vec2(g) * (aPatch.z / float(patchGrid));
+
+    float s = spacing;
+    Normal = normalize(vec3(height(xz - vec2(s, 0.0)) - height(xz + vec2(s, 0.0)), 2.0 * s,
+                            height(xz - vec2(0.0, s)) - height(xz + vec2(0.0, s))));
+    FragPos = vec3(xz.x, height(xz), xz.y);
+    TexCoords = xz / groundRepeat;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
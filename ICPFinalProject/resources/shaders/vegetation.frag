@@ -0,0 +1,37 @@
+#version 330 core
+
+in vec2 TexCoords;
+in vec3 Normal;
+in float Fade;
+
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 FragNormal; // only when baking the impostors
+
+uniform sampler2D diffuse;
+uniform vec3 lightDir;
+uniform bool bake;
+
+// ordered dither threshold of the pixel, the impostor shader discards the other half
+float dither()
+{
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(gl_FragCoord.xy) % 4;
+    return (bayer[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+
+void main()
+{
+    vec4 color = texture(diffuse, TexCoords);
+    if (color.a < 0.5 || Fade > dither())
+        discard;
+
+    vec3 norm = normalize(Normal);
+    if (bake) {
+        FragColor = vec4(color.rgb, 1.0);
+        FragNormal = vec4(norm * 0.5 + 0.5, 1.0);
+        return;
+    }
+    float diff = max(dot(norm, -lightDir), 0.0);
+    FragColor = vec4(color.rgb * (0.25 + 0.6 * diff), 1.0);
+    FragNormal = vec4(0.0);
+}
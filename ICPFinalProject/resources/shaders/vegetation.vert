@@ -0,0 +1,26 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;      // tree of height 1 on the origin
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec4 aTree;     // per instance: base xyz, height w
+
+out vec2 TexCoords;
+out vec3 Normal;
+out float Fade; // 0 = mesh only, 1 = impostor only
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+uniform float fadeStart;
+uniform float fadeEnd;
+
+void main()
+{
+    // uniform scale only, the normals stay as they are
+    vec3 world = aTree.xyz + aPos * aTree.w;
+    TexCoords = aTexCoord;
+    Normal = aNormal;
+    Fade = smoothstep(fadeStart, fadeEnd, distance(viewPos.xz, aTree.xz));
+    gl_Position = projection * view * vec4(world, 1.0);
+}
@@ -0,0 +1,49 @@
+#include <new>
+#include <cstdlib>
+
+#include "AllocationCounter.h"
+
+static thread_local uint64_t thread_allocations = 0;
+
+uint64_t ThreadAllocations()
+{
+    return thread_allocations;
+}
+
+// what the standard operator new does, counted
+static void* allocate(std::size_t size)
+{
+    thread_allocations++;
+    if (size == 0)
+        size = 1;
+    for (;;) {
+        if (void* p = std::malloc(size))
+            return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+static void* allocateNoThrow(std::size_t size) noexcept
+{
+    try {
+        return allocate(size);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
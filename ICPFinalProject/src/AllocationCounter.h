@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+	Heap allocation count per thread, to check that a loop doesn't allocate in its steady state.
+
+	AllocationCounter.cpp replaces the global operator new / delete of the executable it is
+	linked into (the game, ICPTrackBench) with malloc / free plus a thread-local counter - one
+	increment per allocation, nothing shared between threads.
+	Only operator new on the thread asking is counted. Not seen: memory OpenCV takes with its
+	own allocator (cv::Mat data, fastMalloc scratch inside cv functions; image buffers are
+	checked by whoever owns them, FramePool) and anything on other threads, parallel_for_ or
+	HsvCentroid workers included.
+*/
+
+// operator new calls made by the calling thread so far
+uint64_t ThreadAllocations();
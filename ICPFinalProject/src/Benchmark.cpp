@@ -0,0 +1,182 @@
+#include <glm/ext.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "Benchmark.h"
+#include "Camera.h"
+#include "Terrain.h"
+
+// game time per benchmark frame and one lap of the path
+static const float FRAME_DT = 1.0f / 60.0f;
+static const float LAP_SECONDS = 20.0f;
+
+// a wobbly circle around the level, a little above the ground under it
+static glm::vec3 pathPoint(float t, unsigned int seed)
+{
+    float a = t * glm::two_pi<float>() / LAP_SECONDS;
+    float radius = 6.0f + 1.5f * std::sin(3.0f * a);
+    float x = radius * std::sin(a);
+    float z = radius * std::cos(a);
+    return glm::vec3(x, TerrainHeight(seed, x, z) + 1.2f + 0.3f * std::sin(2.0f * a), z);
+}
+
+void Benchmark::Pose(uint64_t frame, unsigned int seed, PlaneState& plane, CameraState& camera, int& activeView, float& rotor_angle, float& coin_angle) const
+{
+    float t = frame * FRAME_DT;
+    activeView = std::min((int)(frame / (warmup_frames + measured_frames)), VIEWS - 1);
+
+    // orientation from the direction of travel, Yaw / Pitch the way Plane computes Front from them
+    plane.Position = pathPoint(t, seed);
+    plane.Front = glm::normalize(pathPoint(t + 0.05f, seed) - plane.Position);
+    plane.Right = glm::normalize(glm::cross(plane.Front, glm::vec3(0.0f, 1.0f, 0.0f)));
+    plane.Up = glm::normalize(glm::cross(plane.Right, plane.Front));
+    plane.Yaw = glm::degrees(std::atan2(plane.Front.x, plane.Front.z));
+    if (plane.Yaw < 0.0f)
+        plane.Yaw += 360.0f;
+    plane.Pitch = glm::degrees(std::asin(std::clamp(plane.Front.y, -1.0f, 1.0f)));
+
+    // the free camera circles slower and wider, always looking at the plane
+    float b = -0.5f * t * glm::two_pi<float>() / LAP_SECONDS;
+    glm::vec3 eye(12.0f * std::sin(b), 0.0f, 12.0f * std::cos(b));
+    eye.y = TerrainHeight(seed, eye.x, eye.z) + 4.0f;
+    camera.Position = eye;
+    camera.Front = glm::normalize(plane.Position - eye);
+    camera.Up = glm::vec3(0.0f, 1.0f, 0.0f);
+    camera.Zoom = ZOOM;
+
+    rotor_angle = std::fmod(t * 720.0f, 360.0f);
+    coin_angle = std::fmod(t * 90.0f, 360.0f);
+}
+
+int Benchmark::measuredIndex(uint64_t frame) const
+{
+    uint64_t segment = warmup_frames + measured_frames;
+    int view = (int)(frame / segment);
+    int within = (int)(frame % segment);
+    if (view >= VIEWS || within < warmup_frames)
+        return -1;
+    return view * measured_frames + within - warmup_frames;
+}
+
+void Benchmark::Record(uint64_t frame, float cpu_ms, float frame_ms, int draw_calls, size_t triangles)
+{
+    int index = measuredIndex(frame);
+    if (index < 0)
+        return;
+    if (frames.empty())
+        frames.resize((size_t)VIEWS * measured_frames);
+    BenchmarkFrame& out = frames[index];
+    out.view = index / measured_frames;
+    out.frame = frame;
+    out.cpu_ms = cpu_ms;
+    out.frame_ms = frame_ms;
+    out.draw_calls = draw_calls;
+    out.triangles = triangles;
+}
+
+void Benchmark::RecordGpu(uint64_t frame, float gpu_ms)
+{
+    int index = measuredIndex(frame);
+    if (index >= 0 && !frames.empty())
+        frames[index].gpu_ms = gpu_ms;
+}
+
+struct Summary {
+    int count = 0;
+    float mean = 0.0f, p50 = 0.0f, p95 = 0.0f, p99 = 0.0f, worst = 0.0f;
+};
+
+// negative values are frames without the metric
+static Summary summarize(std::vector<float> values)
+{
+    values.erase(std::remove_if(values.begin(), values.end(), [](float v) { return v < 0.0f; }), values.end());
+    Summary s;
+    s.count = (int)values.size();
+    if (values.empty())
+        return s;
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (float v : values)
+        sum += v;
+    s.mean = (float)(sum / values.size());
+    s.p50 = values[std::min(values.size() - 1, values.size() / 2)];
+    s.p95 = values[std::min(values.size() - 1, values.size() * 95 / 100)];
+    s.p99 = values[std::min(values.size() - 1, values.size() * 99 / 100)];
+    s.worst = values.back();
+    return s;
+}
+
+int Benchmark::Finish(const std::string& csvPath, bool completed)
+{
+    std::ofstream csv(csvPath);
+    std::ofstream summary(csvPath + ".summary");
+    if (!csv || !summary) {
+        std::cerr << "Benchmark: can't write " << csvPath << std::endl;
+        return 3;
+    }
+    csv << "view,frame,cpu_ms,frame_ms,gpu_ms,draw_calls,triangles\n";
+    for (const BenchmarkFrame& f : frames) {
+        if (f.frame_ms <= 0.0f)
+            continue; // never drawn (aborted run)
+        csv << f.view << ',' << f.frame << ',' << f.cpu_ms << ',' << f.frame_ms << ',';
+        if (f.gpu_ms >= 0.0f)
+            csv << f.gpu_ms;
+        csv << ',' << f.draw_calls << ',' << f.triangles << '\n';
+    }
+
+    // per view and over all of them, "all" last
+    summary << "view,metric,frames,mean,p50,p95,p99,worst\n";
+    std::cout << "Benchmark" << (completed ? "" : " (aborted)") << ": " << warmup_frames << " warm-up + " << measured_frames << " measured frames per view" << std::endl;
+    float p95_frame = 0.0f;
+    int gpu_missing = 0;
+    for (int view = 0; view <= VIEWS; view++) {
+        std::vector<float> cpu, frame, gpu, draws, triangles;
+        int missing = 0;
+        for (const BenchmarkFrame& f : frames) {
+            if ((view < VIEWS && f.view != view) || f.frame_ms <= 0.0f)
+                continue;
+            if (f.gpu_ms < 0.0f)
+                missing++;
+            cpu.push_back(f.cpu_ms);
+            frame.push_back(f.frame_ms);
+            gpu.push_back(f.gpu_ms);
+            draws.push_back((float)f.draw_calls);
+            triangles.push_back((float)f.triangles);
+        }
+        const char* name = view < VIEWS ? nullptr : "all";
+        char label[16];
+        if (!name) {
+            std::snprintf(label, sizeof(label), "%d", view);
+            name = label;
+        }
+        const char* metrics[] = { "cpu_ms", "frame_ms", "gpu_ms", "draw_calls", "triangles" };
+        std::vector<float>* values[] = { &cpu, &frame, &gpu, &draws, &triangles };
+        for (int m = 0; m < 5; m++) {
+            Summary s = summarize(*values[m]);
+            summary << name << ',' << metrics[m] << ',' << s.count << ',' << s.mean << ',' << s.p50 << ',' << s.p95 << ',' << s.p99 << ',' << s.worst << '\n';
+            char line[160];
+            std::snprintf(line, sizeof(line), "  view %-3s %-10s mean %10.2f  p50 %10.2f  p95 %10.2f  p99 %10.2f  worst %10.2f", name, metrics[m], s.mean, s.p50, s.p95, s.p99, s.worst);
+            std::cout << line << std::endl;
+            if (view == VIEWS && m == 1)
+                p95_frame = s.p95;
+        }
+        // drawn frames without a GPU time: skipped by the GPU timer or never read back
+        summary << name << ",gpu_missing," << missing << ",,,,,\n";
+        if (view == VIEWS)
+            gpu_missing = missing;
+    }
+    if (gpu_missing > 0)
+        std::cout << "Benchmark: warning, " << gpu_missing << " measured frames have no GPU time, the gpu_ms statistics leave them out" << std::endl;
+    std::cout << "Frames saved into " << csvPath << ", summary into " << csvPath << ".summary" << std::endl;
+
+    if (!completed)
+        return 2;
+    if (budget_ms > 0.0f && p95_frame > budget_ms) {
+        std::cout << "Benchmark: p95 frame time " << p95_frame << " ms is over the budget of " << budget_ms << " ms" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GameState.h"
+
+/*
+	Rendering benchmark of the game executable (--benchmark).
+
+	A scripted flythrough replaces the player: the plane and the free camera follow a fixed
+	path over the seeded world, each activeView in turn. The path advances a fixed 1/60 s of
+	game time per frame, not by the clock, so every run draws the same frames whatever the
+	frame rate. Each view gets warmup_frames (chunk streaming, driver caches) and then
+	measured_frames recorded per frame: CPU and whole-frame times, GPU time (GpuTimer, it
+	arrives a few frames late, the benchmark runs on until it has them), draw calls and
+	triangles. Finish() writes them as CSV, the summary (mean, p50, p95, p99, worst) next to
+	it and on the console; frames left without a GPU time are counted there (gpu_missing)
+	and warned about.
+*/
+struct BenchmarkFrame {
+    int view = 0;
+    uint64_t frame = 0;
+    float cpu_ms = 0.0f;
+    float frame_ms = 0.0f;
+    float gpu_ms = -1.0f; // -1 = not measured (the GPU timer skipped the frame)
+    int draw_calls = 0;
+    size_t triangles = 0;
+};
+
+class Benchmark {
+
+public:
+    static const int VIEWS = 3;
+    static const unsigned int SEED = 1; // unless --seed says otherwise
+
+    int warmup_frames = 120;   // per view
+    int measured_frames = 600; // per view
+    float budget_ms = 0.0f;    // p95 frame time limit for the exit code, 0 = none
+
+    // scripted pose for the frame (the frame count since the benchmark started)
+    void Pose(uint64_t frame, unsigned int seed, PlaneState& plane, CameraState& camera, int& activeView, float& rotor_angle, float& coin_angle) const;
+
+    // per-frame results of the measured frames, anything else is ignored
+    void Record(uint64_t frame, float cpu_ms, float frame_ms, int draw_calls, size_t triangles);
+    // for every frame GpuTimer::Resolve() reads back, they arrive late and any number at once
+    void RecordGpu(uint64_t frame, float gpu_ms);
+
+    // all frames drawn, `drain` frames more for the late GPU results
+    bool Done(uint64_t frame, int drain) const { return frame >= TotalFrames() + drain; }
+    uint64_t TotalFrames() const { return (uint64_t)VIEWS * (warmup_frames + measured_frames); }
+
+    // CSV into csvPath, summary into csvPath + ".summary" and the console;
+    // returns the exit code: 0 ok, 1 over budget_ms, 2 aborted (completed = false), 3 can't write
+    int Finish(const std::string& csvPath, bool completed);
+
+private:
+    std::vector<BenchmarkFrame> frames; // measured frames, in order, reserved up front
+
+    // index into frames, -1 when the frame isn't measured
+    int measuredIndex(uint64_t frame) const;
+
+};
@@ -1,4 +1,3 @@
-#include <GL/glew.h> // GLEW provides efficient run-time mechanisms for determining which OpenGL extensions are supported on the target platform.
 #include <glm/glm.hpp> // ibrary for math operations
 #include <glm/ext.hpp>
 
@@ -47,7 +46,7 @@ void Camera::ProcessKeyboard(Camera_Movement direction, float deltaTime)
 
 
 // processes input received from a mouse input system. Expects the offset value in both the x and y direction.
-void Camera::ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch)
+void Camera::ProcessMouseMovement(float xoffset, float yoffset, bool constrainPitch)
 {
     xoffset *= MouseSensitivity;
     yoffset *= MouseSensitivity;
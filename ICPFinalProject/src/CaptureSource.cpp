@@ -0,0 +1,157 @@
+#include <iostream>
+#include <sstream>
+#include <cstring>
+
+#include "CaptureSource.h"
+#include "Timing.h"
+
+std::string CaptureMode::Describe() const
+{
+    std::ostringstream text;
+    text << backend << ", " << width << "x" << height << " @ " << fps << " fps";
+    if (!fourcc.empty())
+        text << " " << fourcc;
+    if (buffers > 0)
+        text << ", " << buffers << (buffers == 1 ? " buffer" : " buffers");
+    return text.str();
+}
+
+bool CaptureSource::FormatFromName(const char* name, Capture_Format& format)
+{
+    if (std::strcmp(name, "mjpeg") == 0)
+        format = CAPTURE_FORMAT_MJPEG;
+    else if (std::strcmp(name, "yuyv") == 0)
+        format = CAPTURE_FORMAT_YUYV;
+    else if (std::strcmp(name, "any") == 0)
+        format = CAPTURE_FORMAT_ANY;
+    else
+        return false;
+    return true;
+}
+
+bool CaptureSource::Open(const CaptureSettings& wanted)
+{
+    Close();
+    settings = wanted;
+    mode = CaptureMode();
+
+    if (settings.source == CAPTURE_CAMERA)
+        opened = openCamera();
+    else if (settings.source == CAPTURE_FILE)
+        opened = openFile();
+    else {
+        int width = settings.width > 0 ? settings.width : 640;
+        int height = settings.height > 0 ? settings.height : 480;
+        synthetic.reset(new SyntheticFrames(width, height));
+        mode.backend = "synthetic";
+        mode.width = width;
+        mode.height = height;
+        mode.fps = settings.fps > 0.0 ? settings.fps : 60.0;
+        opened = true;
+    }
+
+    if (opened && settings.source != CAPTURE_CAMERA)
+        period = 1.0 / mode.fps;
+    next_time = NowSeconds();
+    synthetic_frames = 0;
+    frames_read = 0;
+    return opened;
+}
+
+bool CaptureSource::openCamera()
+{
+    // a backend with control over the driver's queue: V4L2 on Linux, DirectShow on Windows
+#if defined(_WIN32)
+    int api = cv::CAP_DSHOW;
+    mode.backend = "DirectShow";
+#elif defined(__linux__)
+    int api = cv::CAP_V4L2;
+    mode.backend = "V4L2";
+#else
+    int api = cv::CAP_ANY;
+    mode.backend = "default";
+#endif
+    if (!capture.open(settings.device, api))
+        return false;
+
+    // V4L2 wants the pixel format before the size, the size before the frame rate
+    if (settings.format == CAPTURE_FORMAT_MJPEG)
+        capture.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
+    else if (settings.format == CAPTURE_FORMAT_YUYV)
+        capture.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V'));
+    if (settings.width > 0 && settings.height > 0) {
+        capture.set(cv::CAP_PROP_FRAME_WIDTH, settings.width);
+        capture.set(cv::CAP_PROP_FRAME_HEIGHT, settings.height);
+    }
+    if (settings.fps > 0.0)
+        capture.set(cv::CAP_PROP_FPS, settings.fps);
+    if (settings.buffers > 0)
+        capture.set(cv::CAP_PROP_BUFFERSIZE, settings.buffers);
+
+    // what the driver agreed to
+    mode.width = (int)capture.get(cv::CAP_PROP_FRAME_WIDTH);
+    mode.height = (int)capture.get(cv::CAP_PROP_FRAME_HEIGHT);
+    mode.fps = capture.get(cv::CAP_PROP_FPS);
+    mode.buffers = (int)capture.get(cv::CAP_PROP_BUFFERSIZE);
+    int code = (int)capture.get(cv::CAP_PROP_FOURCC);
+    if (code != 0) {
+        for (int i = 0; i < 4; i++)
+            mode.fourcc += (char)((code >> (8 * i)) & 0xFF);
+    }
+    mode.backend += " camera " + std::to_string(settings.device);
+    return true;
+}
+
+bool CaptureSource::openFile()
+{
+    if (!capture.open(settings.file))
+        return false;
+    mode.backend = "file " + settings.file;
+    mode.width = (int)capture.get(cv::CAP_PROP_FRAME_WIDTH);
+    mode.height = (int)capture.get(cv::CAP_PROP_FRAME_HEIGHT);
+    mode.fps = capture.get(cv::CAP_PROP_FPS);
+    if (mode.fps <= 0.0)
+        mode.fps = 30.0;
+    return true;
+}
+
+bool CaptureSource::IsOpen() const
+{
+    return opened;
+}
+
+void CaptureSource::Close()
+{
+    if (capture.isOpened())
+        capture.release();
+    synthetic.reset();
+    opened = false;
+}
+
+bool CaptureSource::Read(cv::Mat& frame)
+{
+    if (!opened || (settings.max_frames > 0 && frames_read >= (uint64_t)settings.max_frames))
+        return false;
+    frames_read++;
+
+    if (period > 0.0) {
+        next_time += period;
+        SleepUntil(next_time);
+    }
+
+    if (settings.source == CAPTURE_SYNTHETIC) {
+        frame.create(synthetic->Height(), synthetic->Width(), CV_8UC3);
+        // frame times, not wall clock: the same frames every run
+        truth = synthetic->Render(frame.data, frame.step, synthetic_frames++ * period);
+        return true;
+    }
+
+    if (capture.read(frame) && !frame.empty())
+        return true;
+    // end of the video: start it again
+    if (settings.source == CAPTURE_FILE && settings.loop && capture.set(cv::CAP_PROP_POS_FRAMES, 0) && capture.read(frame) && !frame.empty()) {
+        next_time = NowSeconds();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <glm/glm.hpp> // ibrary for math operations
+#include <string>
+#include <memory>
+
+#include "SyntheticFrames.h"
+
+/*
+	Where the tracker's frames come from: a camera, a video file or generated frames.
+
+	Camera: V4L2 on Linux, DirectShow on Windows. The wanted size, fps, pixel format and driver
+	buffer count are set before streaming starts (fewer queued buffers = fresher frames); what
+	the driver agreed to is read back into Mode(), it may differ from the request.
+	File and synthetic sources pace Read() to their fps like a camera would, a file loops.
+*/
+
+enum Capture_Source {
+    CAPTURE_CAMERA,
+    CAPTURE_FILE,
+    CAPTURE_SYNTHETIC // SyntheticFrames, true ball position in Truth()
+};
+
+enum Capture_Format {
+    CAPTURE_FORMAT_ANY,   // whatever the driver picks
+    CAPTURE_FORMAT_MJPEG, // compressed, the high fps / resolution modes of USB cameras
+    CAPTURE_FORMAT_YUYV   // uncompressed, no decoding, limited by USB bandwidth
+};
+
+struct CaptureSettings {
+    Capture_Source source = CAPTURE_CAMERA;
+    int device = 0;
+    std::string file;       // CAPTURE_FILE
+    int width = 640;        // 0 = driver default
+    int height = 480;
+    double fps = 60.0;      // camera request, pace of synthetic frames (files use their own)
+    Capture_Format format = CAPTURE_FORMAT_MJPEG;
+    int buffers = 1;        // driver queue length, 0 = driver default
+    bool loop = true;       // files start again at the end
+    int max_frames = 0;     // Read() fails after this many frames, 0 = no limit
+};
+
+// what the source actually delivers
+struct CaptureMode {
+    std::string backend;
+    int width = 0;
+    int height = 0;
+    double fps = 0.0;
+    std::string fourcc; // "MJPG", "YUYV", ... (empty when the backend doesn't say)
+    int buffers = 0;    // 0 = unknown
+
+    std::string Describe() const;
+};
+
+class CaptureSource {
+
+public:
+    // false when the source can't be opened
+    bool Open(const CaptureSettings& settings);
+    bool IsOpen() const;
+    void Close();
+
+    // next frame (BGR), blocks until it is there: a camera's next frame or the file / synthetic pace
+    bool Read(cv::Mat& frame);
+
+    const CaptureMode& Mode() const { return mode; }
+    Capture_Source Source() const { return settings.source; }
+
+    // true ball position of the last synthetic frame
+    glm::vec2 Truth() const { return truth; }
+
+    // parses "mjpeg" / "yuyv" / "any"
+    static bool FormatFromName(const char* name, Capture_Format& format);
+
+private:
+    CaptureSettings settings;
+    CaptureMode mode;
+    cv::VideoCapture capture;
+    std::unique_ptr<SyntheticFrames> synthetic;
+    glm::vec2 truth = glm::vec2(0.0f);
+    double period = 0.0;  // paced sources: seconds per frame
+    double next_time = 0.0;
+    uint64_t synthetic_frames = 0;
+    uint64_t frames_read = 0;
+    bool opened = false;
+
+    bool openCamera();
+    bool openFile();
+
+};
@@ -0,0 +1,281 @@
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "ChunkStreamer.h"
+#include "Random.h"
+#include "Terrain.h"
+#include "Trace.h"
+
+// random streams of a chunk (xor-ed with its key), trees and gameplay never share numbers
+static const uint64_t TREE_STREAM = 0x5452454553ULL;
+static const uint64_t GAMEPLAY_STREAM = 0x47414d45ULL;
+static const uint64_t DENSITY_STREAM = 0x44454e53ULL;
+
+
+ChunkCoord ChunkCoord::Of(const glm::vec3& position)
+{
+    ChunkCoord coord;
+    coord.x = (int)std::floor(position.x / CHUNK_SIZE);
+    coord.z = (int)std::floor(position.z / CHUNK_SIZE);
+    return coord;
+}
+
+int ChunkCoord::Distance(const ChunkCoord& other) const
+{
+    return std::max(std::abs(x - other.x), std::abs(z - other.z));
+}
+
+// random 0..1 at a corner of the density grid
+static float densityCorner(unsigned int seed, int x, int z)
+{
+    ChunkCoord corner;
+    corner.x = x;
+    corner.z = z;
+    return Random(seed, corner.Key() ^ DENSITY_STREAM).Float();
+}
+
+static int floorDiv(int a, int b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+float ChunkTreeDensity(unsigned int seed, ChunkCoord coord)
+{
+    // value noise: corners every DENSITY_CELL chunks, smoothly interpolated in between
+    int cx = floorDiv(coord.x, DENSITY_CELL), cz = floorDiv(coord.z, DENSITY_CELL);
+    float fx = (coord.x - cx * DENSITY_CELL + 0.5f) / DENSITY_CELL;
+    float fz = (coord.z - cz * DENSITY_CELL + 0.5f) / DENSITY_CELL;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fz = fz * fz * (3.0f - 2.0f * fz);
+    float a = glm::mix(densityCorner(seed, cx, cz), densityCorner(seed, cx + 1, cz), fx);
+    float b = glm::mix(densityCorner(seed, cx, cz + 1), densityCorner(seed, cx + 1, cz + 1), fx);
+    float noise = glm::mix(a, b, fz);
+    // stretch it so both empty fields and full forests show up
+    return glm::clamp((noise - 0.2f) / 0.6f, 0.0f, 1.0f);
+}
+
+void ChunkTrees(unsigned int seed, ChunkCoord coord, std::vector<glm::vec4>& trees)
+{
+    Random random(seed, coord.Key() ^ TREE_STREAM);
+    glm::vec3 origin = coord.Origin();
+    trees.clear();
+    int count = (int)(ChunkTreeDensity(seed, coord) * MAX_TREES_PER_CHUNK + random.Float());
+    for (int i = 0; i < count; i++) {
+        glm::vec3 base = origin + glm::vec3(random.Range(1.0f, CHUNK_SIZE - 1.0f), 0.0f, random.Range(1.0f, CHUNK_SIZE - 1.0f));
+        base.y = TerrainHeight(seed, base.x, base.z);
+        float height = random.Range(2.5f, 5.0f);
+        if (!InHomeField(base))
+            trees.push_back(glm::vec4(base, height));
+    }
+}
+
+void ChunkGameplay(unsigned int seed, ChunkCoord coord, std::vector<glm::vec3>& coins, std::vector<glm::vec3>& bombs)
+{
+    static thread_local std::vector<glm::vec4> trees;
+    ChunkTrees(seed, coord, trees);
+
+    Random random(seed, coord.Key() ^ GAMEPLAY_STREAM);
+    glm::vec3 origin = coord.Origin();
+    auto place = [&](float minY, float maxY, std::vector<glm::vec3>& out) {
+        for (int attempt = 0; attempt < 8; attempt++) {
+            glm::vec3 p = origin + random.InBox(glm::vec3(1.0f, minY, 1.0f), glm::vec3(CHUNK_SIZE - 1.0f, maxY, CHUNK_SIZE - 1.0f));
+            p.y += TerrainHeight(seed, p.x, p.z);
+            bool blocked = InHomeField(p);
+            for (const glm::vec4& tree : trees) {
+                glm::vec2 d = glm::vec2(p.x - tree.x, p.z - tree.z);
+                if (glm::dot(d, d) < 2.0f * 2.0f && p.y < tree.y + tree.w + 0.5f)
+                    blocked = true;
+            }
+            if (!blocked) {
+                out.push_back(p);
+                return;
+            }
+        }
+    };
+
+    coins.clear();
+    bombs.clear();
+    for (int i = 0; i < COINS_PER_CHUNK; i++)
+        place(0.5f, 4.0f, coins);
+    for (int i = 0; i < BOMBS_PER_CHUNK; i++)
+        place(0.6f, 3.5f, bombs);
+}
+
+void BuildChunkMesh(unsigned int seed, ChunkMesh& mesh)
+{
+    ChunkTrees(seed, mesh.coord, mesh.trees);
+}
+
+
+ChunkStreamer::ChunkStreamer(unsigned int seed, int loadRadius, int workerCount)
+    : seed(seed), loadRadius(loadRadius)
+{
+    // leave cores to the render, simulation and tracking threads
+    if (workerCount <= 0)
+        workerCount = std::clamp((int)std::thread::hardware_concurrency() - 3, 1, 2);
+    for (int i = 0; i < workerCount; i++)
+        workers.emplace_back(&ChunkStreamer::workerLoop, this);
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void ChunkStreamer::workerLoop()
+{
+    TraceThreadName("chunk worker");
+    for (;;) {
+        Job job;
+        ChunkMesh* mesh;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            job = jobs.front();
+            jobs.pop_front();
+            if (spare.empty()) {
+                meshes.push_back(std::make_unique<ChunkMesh>());
+                spare.push_back(meshes.back().get());
+            }
+            mesh = spare.back();
+            spare.pop_back();
+        }
+
+        mesh->coord = job.coord;
+        mesh->request_time = job.request_time;
+        {
+            TRACE_SCOPE("chunk build");
+            BuildChunkMesh(seed, *mesh);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        done.push_back({ mesh, job.request });
+    }
+}
+
+void ChunkStreamer::Update(const glm::vec3& position)
+{
+    TRACE_SCOPE("chunk update");
+    // finished builds, dropped when their chunk was evicted (or requested again) meanwhile
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(finished, done);
+    }
+    for (const Done& result : finished) {
+        auto it = chunks.find(result.mesh->coord);
+        if (it != chunks.end() && it->second.request == result.request && it->second.state == CHUNK_QUEUED) {
+            it->second.state = CHUNK_READY;
+            ready.push_back(result.mesh);
+        }
+        else
+            recycle(result.mesh);
+    }
+    finished.clear();
+
+    ChunkCoord now = ChunkCoord::Of(position);
+    if (started && now == center)
+        return;
+    started = true;
+    center = now;
+
+    // evict everything beyond the load radius + 1 (the margin stops flicker on chunk borders)
+    for (auto it = chunks.begin(); it != chunks.end();) {
+        if (it->first.Distance(center) <= loadRadius + 1) {
+            ++it;
+            continue;
+        }
+        if (it->second.state == CHUNK_RESIDENT) {
+            evicted.push_back(it->first);
+            resident--;
+        }
+        else if (it->second.state == CHUNK_READY) {
+            ChunkCoord coord = it->first;
+            auto mesh = std::find_if(ready.begin(), ready.end(), [&](ChunkMesh* m) { return m->coord == coord; });
+            recycle(*mesh);
+            ready.erase(mesh);
+        }
+        it = chunks.erase(it);
+    }
+
+    // request the missing chunks ring by ring, nearest first
+    double requestTime = NowSeconds();
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [&](const Job& job) {
+        auto it = chunks.find(job.coord);
+        return it == chunks.end() || it->second.request != job.request;
+    }), jobs.end());
+    for (int ring = 0; ring <= loadRadius; ring++) {
+        for (int dz = -ring; dz <= ring; dz++) {
+            for (int dx = -ring; dx <= ring; dx++) {
+                if (std::max(std::abs(dx), std::abs(dz)) != ring)
+                    continue;
+                ChunkCoord coord;
+                coord.x = center.x + dx;
+                coord.z = center.z + dz;
+                if (chunks.count(coord))
+                    continue;
+                uint64_t request = nextRequest++;
+                chunks[coord] = { CHUNK_QUEUED, request };
+                jobs.push_back({ coord, request, requestTime });
+            }
+        }
+    }
+    // older requests still in range go by distance to the new center too
+    std::stable_sort(jobs.begin(), jobs.end(), [&](const Job& a, const Job& b) {
+        return a.coord.Distance(center) < b.coord.Distance(center);
+    });
+    wake.notify_all();
+}
+
+ChunkMesh* ChunkStreamer::PopReady()
+{
+    if (ready.empty())
+        return nullptr;
+    ChunkMesh* mesh = ready.front();
+    ready.pop_front();
+    chunks[mesh->coord].state = CHUNK_RESIDENT;
+    resident++;
+    return mesh;
+}
+
+void ChunkStreamer::Recycle(ChunkMesh* mesh)
+{
+    double now = NowSeconds();
+    double ms = (now - mesh->request_time) * 1000.0;
+    load_stats.AddSample(ms, now);
+    load_ms_worst = std::max(load_ms_worst, ms);
+    loaded++;
+    recycle(mesh);
+}
+
+void ChunkStreamer::recycle(ChunkMesh* mesh)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    spare.push_back(mesh);
+}
+
+bool ChunkStreamer::PopEvicted(ChunkCoord& coord)
+{
+    if (evicted.empty())
+        return false;
+    coord = evicted.front();
+    evicted.pop_front();
+    return true;
+}
+
+size_t ChunkStreamer::CpuBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return meshes.size() * ChunkMesh::Bytes();
+}
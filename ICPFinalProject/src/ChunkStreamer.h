@@ -0,0 +1,170 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+
+#include "Timing.h"
+
+/*
+	Open world split into CHUNK_SIZE x CHUNK_SIZE squares on the ground plane.
+
+	Content of a chunk is a pure function of (seed, chunk coordinate), so any thread can make
+	it and a chunk that comes back after eviction is the same as before:
+	- ChunkTreeDensity / ChunkTrees / ChunkGameplay: tree, coin and bomb placement (the
+	  simulation uses the gameplay part, the vegetation renderer the trees)
+	- BuildChunkMesh: the chunk's render data, its tree list (the ground is Terrain.h,
+	  trees are drawn instanced, see Vegetation.h)
+
+	ChunkStreamer keeps the meshes of all chunks within a radius of a point: missing ones are
+	built on worker threads (nearest first), ones that fall out of radius + 1 are evicted.
+	Mesh objects are recycled, so memory stays the same however far the point moves.
+	No OpenGL here, VegetationRenderer takes the finished chunks.
+*/
+
+const float CHUNK_SIZE = 25.0f;
+const int MAX_TREES_PER_CHUNK = 48;
+const int DENSITY_CELL = 4; // chunks per side of one density noise cell (forests and clearings)
+const int COINS_PER_CHUNK = 3; // at most 32, the simulation keeps collected ones as bits
+const int BOMBS_PER_CHUNK = 2;
+
+// the original 10 x 10 play field (wooden map, first coins) stays free of generated content
+inline bool InHomeField(const glm::vec3& p)
+{
+    return p.x > -15.0f && p.x < 15.0f && p.z > -15.0f && p.z < 15.0f;
+}
+
+struct ChunkCoord {
+    int x = 0;
+    int z = 0;
+
+    bool operator==(const ChunkCoord& other) const { return x == other.x && z == other.z; }
+    bool operator!=(const ChunkCoord& other) const { return !(*this == other); }
+
+    static ChunkCoord Of(const glm::vec3& position);
+    glm::vec3 Origin() const { return glm::vec3(x * CHUNK_SIZE, 0.0f, z * CHUNK_SIZE); }
+    // chunks in between along the worse axis (rings around a chunk)
+    int Distance(const ChunkCoord& other) const;
+    // unique per coordinate, seeds the chunk's random stream
+    uint64_t Key() const { return ((uint64_t)(uint32_t)x << 32) | (uint32_t)z; }
+};
+
+struct ChunkCoordHash {
+    size_t operator()(const ChunkCoord& coord) const { return (size_t)(coord.Key() * 0x9E3779B97F4A7C15ULL >> 16); }
+};
+
+// 0 (clearing) .. 1 (forest), smooth across chunks
+float ChunkTreeDensity(unsigned int seed, ChunkCoord coord);
+
+// trees of a chunk (density * MAX_TREES_PER_CHUNK of them): xyz = base on the terrain, w = height
+void ChunkTrees(unsigned int seed, ChunkCoord coord, std::vector<glm::vec4>& trees);
+
+// coin and bomb positions of a chunk, above the terrain (none in the home field, away from trees)
+void ChunkGameplay(unsigned int seed, ChunkCoord coord, std::vector<glm::vec3>& coins, std::vector<glm::vec3>& bombs);
+
+// renderable content of one chunk
+struct ChunkMesh {
+    ChunkCoord coord;
+    std::vector<glm::vec4> trees; // world space, drawn by VegetationRenderer
+    double request_time = 0.0; // NowSeconds() when the chunk was requested
+
+    // buffers are sized for the largest chunk once, so they never grow
+    ChunkMesh()
+    {
+        trees.reserve(MAX_TREES_PER_CHUNK);
+    }
+
+    static size_t Bytes()
+    {
+        return MAX_TREES_PER_CHUNK * sizeof(glm::vec4) + sizeof(ChunkMesh);
+    }
+};
+
+// fills mesh (coord set) with the tree list, reuses its buffers
+void BuildChunkMesh(unsigned int seed, ChunkMesh& mesh);
+
+class ChunkStreamer {
+
+public:
+    // workers 0 = pick from the core count
+    ChunkStreamer(unsigned int seed, int loadRadius = 3, int workers = 0);
+    ~ChunkStreamer();
+
+    // once per frame (owner thread): requests chunks around the position, evicts far ones,
+    // collects finished meshes
+    void Update(const glm::vec3& position);
+
+    // next finished mesh or nullptr; hand it back with Recycle once uploaded
+    ChunkMesh* PopReady();
+    // counts the mesh as loaded (latency = now - request time) and keeps it for reuse
+    void Recycle(ChunkMesh* mesh);
+    // next chunk whose uploaded data should be dropped, false when none
+    bool PopEvicted(ChunkCoord& coord);
+
+    int LoadRadius() const { return loadRadius; }
+    // most chunks that can be loaded at the same time (the resident area + the eviction margin)
+    int MaxResident() const { return (2 * loadRadius + 3) * (2 * loadRadius + 3); }
+
+    // metrics
+    int Resident() const { return resident; }   // popped and not evicted
+    int Pending() const { return (int)chunks.size() - resident; } // queued, building or waiting for upload
+    size_t CpuBytes() const;                     // all mesh objects, in use or spare
+    unsigned long long Loaded() const { return loaded; }
+    TimingStats load_stats;                      // request -> Recycle, per second window
+    double load_ms_worst = 0.0;                  // since start
+
+private:
+    enum Chunk_State {
+        CHUNK_QUEUED,  // waiting for / on a worker
+        CHUNK_READY,   // built, waiting for PopReady
+        CHUNK_RESIDENT // handed out
+    };
+    struct ChunkEntry {
+        Chunk_State state;
+        uint64_t request; // id of the latest request, older worker results are dropped
+    };
+    struct Job {
+        ChunkCoord coord;
+        uint64_t request;
+        double request_time;
+    };
+    struct Done {
+        ChunkMesh* mesh;
+        uint64_t request;
+    };
+
+    unsigned int seed;
+    int loadRadius;
+    ChunkCoord center;
+    bool started = false;
+
+    // owner thread only
+    std::unordered_map<ChunkCoord, ChunkEntry, ChunkCoordHash> chunks;
+    std::deque<ChunkMesh*> ready;
+    std::deque<ChunkCoord> evicted;
+    std::vector<Done> finished; // taken from `done` under the lock
+    uint64_t nextRequest = 1;
+    int resident = 0;
+    unsigned long long loaded = 0;
+
+    // shared with the workers
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    std::vector<Done> done;
+    std::vector<std::unique_ptr<ChunkMesh>> meshes; // all ever made
+    std::vector<ChunkMesh*> spare;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void workerLoop();
+    void recycle(ChunkMesh* mesh);
+
+};
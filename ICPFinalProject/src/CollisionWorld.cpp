@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <cmath>
+
+#include "CollisionWorld.h"
+
+
+enum { SLOT_FREE = 0, SLOT_GRID = 1, SLOT_LARGE = 2 };
+
+static int roundUpPow2(int n)
+{
+    int p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+CollisionWorld::CollisionWorld(float cellSize, int bucketCount)
+    : cellSize(cellSize), invCellSize(1.0f / cellSize)
+{
+    rehash(bucketCount);
+}
+
+glm::ivec3 CollisionWorld::cellOf(const glm::vec3& p) const
+{
+    return glm::ivec3((int)std::floor(p.x * invCellSize), (int)std::floor(p.y * invCellSize), (int)std::floor(p.z * invCellSize));
+}
+
+uint32_t CollisionWorld::bucketOf(const glm::ivec3& cell) const
+{
+    // classic spatial hash primes (Teschner et al.)
+    return ((uint32_t)cell.x * 73856093u ^ (uint32_t)cell.y * 19349663u ^ (uint32_t)cell.z * 83492791u) & bucketMask;
+}
+
+void CollisionWorld::link(int handle)
+{
+    if (spheres.radius[handle] * 2.0f > cellSize) {
+        where[handle] = SLOT_LARGE;
+        large.push_back(handle);
+        return;
+    }
+    where[handle] = SLOT_GRID;
+    cells[handle] = cellOf(spheres.Center(handle));
+    uint32_t bucket = bucketOf(cells[handle]);
+    next[handle] = buckets[bucket];
+    buckets[bucket] = handle;
+    maxRadius = std::max(maxRadius, spheres.radius[handle]);
+}
+
+void CollisionWorld::unlink(int handle)
+{
+    if (where[handle] == SLOT_LARGE) {
+        large.erase(std::find(large.begin(), large.end(), handle));
+        return;
+    }
+    int* link = &buckets[bucketOf(cells[handle])];
+    while (*link != handle)
+        link = &next[*link];
+    *link = next[handle];
+}
+
+void CollisionWorld::rehash(int bucketCount)
+{
+    bucketMask = (uint32_t)roundUpPow2(bucketCount) - 1;
+    buckets.assign(bucketMask + 1, -1);
+    large.clear();
+    for (int handle = 0; handle < (int)where.size(); handle++) {
+        if (where[handle] != SLOT_FREE)
+            link(handle);
+    }
+}
+
+int CollisionWorld::Insert(const glm::vec3& center, float radius, uint32_t layer, int id)
+{
+    int handle;
+    if (freeList >= 0) {
+        handle = freeList;
+        freeList = next[handle];
+    }
+    else {
+        handle = (int)spheres.Size();
+        spheres.Push(glm::vec3(0.0f), 0.0f);
+        layers.push_back(0);
+        ids.push_back(0);
+        cells.emplace_back();
+        next.push_back(-1);
+        where.push_back(SLOT_FREE);
+    }
+    spheres.Set(handle, center);
+    spheres.radius[handle] = radius;
+    layers[handle] = layer;
+    ids[handle] = id;
+    link(handle);
+    count++;
+
+    // keep buckets about as many as colliders, chains stay short
+    if (count > (int)buckets.size())
+        rehash((int)buckets.size() * 2);
+    return handle;
+}
+
+void CollisionWorld::Move(int handle, const glm::vec3& center)
+{
+    spheres.Set(handle, center);
+    if (where[handle] == SLOT_GRID && cellOf(center) != cells[handle]) {
+        unlink(handle);
+        link(handle);
+    }
+}
+
+void CollisionWorld::Remove(int handle)
+{
+    unlink(handle);
+    where[handle] = SLOT_FREE;
+    next[handle] = freeList;
+    freeList = handle;
+    count--;
+}
+
+void CollisionWorld::Clear()
+{
+    spheres.Clear();
+    layers.clear();
+    ids.clear();
+    cells.clear();
+    next.clear();
+    where.clear();
+    large.clear();
+    std::fill(buckets.begin(), buckets.end(), -1);
+    freeList = -1;
+    count = 0;
+    maxRadius = 0.0f;
+}
+
+bool CollisionWorld::wide(const glm::vec3& lo, const glm::vec3& hi) const
+{
+    glm::ivec3 size = cellOf(hi + glm::vec3(maxRadius)) - cellOf(lo - glm::vec3(maxRadius)) + glm::ivec3(1);
+    return (double)size.x * size.y * size.z > (double)spheres.Size();
+}
+
+template <typename F>
+void CollisionWorld::visit(const glm::vec3& lo, const glm::vec3& hi, uint32_t layerMask, F test) const
+{
+    glm::ivec3 c0 = cellOf(lo - glm::vec3(maxRadius));
+    glm::ivec3 c1 = cellOf(hi + glm::vec3(maxRadius));
+
+    if (wide(lo, hi)) {
+        // query bigger than the world - walking every collider is cheaper than every cell
+        for (int handle = 0; handle < (int)where.size(); handle++) {
+            if (where[handle] == SLOT_GRID && (layers[handle] & layerMask))
+                test(handle);
+        }
+    }
+    else {
+        for (int x = c0.x; x <= c1.x; x++)
+            for (int y = c0.y; y <= c1.y; y++)
+                for (int z = c0.z; z <= c1.z; z++) {
+                    glm::ivec3 cell(x, y, z);
+                    for (int handle = buckets[bucketOf(cell)]; handle >= 0; handle = next[handle]) {
+                        // buckets are shared by distant cells, skip colliders of other cells
+                        if (cells[handle] == cell && (layers[handle] & layerMask))
+                            test(handle);
+                    }
+                }
+    }
+
+    for (int handle : large) {
+        if (layers[handle] & layerMask)
+            test(handle);
+    }
+}
+
+int CollisionWorld::QuerySphere(const glm::vec3& center, float r, uint32_t layerMask, std::vector<CollisionHit>& hits) const
+{
+    int found = 0;
+    if (wide(center - glm::vec3(r), center + glm::vec3(r))) {
+        // every collider (large ones and free slots included) in one batch, then filter the bits
+        mask.resize((spheres.Size() + 63) / 64);
+        SphereOverlapMask(spheres, center, r, mask.data());
+        tested += spheres.Size();
+        ForEachHit(mask.data(), spheres.Size(), [&](size_t handle) {
+            if (where[handle] != SLOT_FREE && (layers[handle] & layerMask)) {
+                hits.push_back({ (int)handle, ids[handle], layers[handle], 0.0f });
+                found++;
+            }
+        });
+        return found;
+    }
+
+    visit(center - glm::vec3(r), center + glm::vec3(r), layerMask, [&](int handle) {
+        tested++;
+        glm::vec3 d = spheres.Center(handle) - center;
+        float reach = r + spheres.radius[handle];
+        if (glm::dot(d, d) <= reach * reach) {
+            hits.push_back({ handle, ids[handle], layers[handle], 0.0f });
+            found++;
+        }
+    });
+    return found;
+}
+
+int CollisionWorld::QuerySegment(const glm::vec3& p0, const glm::vec3& p1, float r, uint32_t layerMask, std::vector<CollisionHit>& hits) const
+{
+    glm::vec3 d = p1 - p0;
+    float dd = glm::dot(d, d);
+    size_t first = hits.size();
+
+    // the broadphase candidates in one batch through the SIMD kernel against the sphere around
+    // the whole swept segment (a little bigger for rounding, it only may keep too many)
+    candidates.clear();
+    batch.Clear();
+    visit(glm::min(p0, p1) - glm::vec3(r), glm::max(p0, p1) + glm::vec3(r), layerMask, [&](int handle) {
+        candidates.push_back(handle);
+        batch.Push(spheres.Center(handle), spheres.radius[handle]);
+    });
+    tested += candidates.size();
+    float bound = (r + 0.5f * std::sqrt(dd)) * 1.001f + 1e-4f;
+    mask.resize((batch.Size() + 63) / 64);
+    SphereOverlapMask(batch, p0 + 0.5f * d, bound, mask.data());
+
+    // exact swept test of the ones it kept, in the broadphase order
+    ForEachHit(mask.data(), batch.Size(), [&](size_t i) {
+        int handle = candidates[i];
+        glm::vec3 m = p0 - spheres.Center(handle);
+        float reach = r + spheres.radius[handle];
+        float c = glm::dot(m, m) - reach * reach;
+        if (c <= 0.0f) { // touching already at p0
+            hits.push_back({ handle, ids[handle], layers[handle], 0.0f });
+            return;
+        }
+        if (dd == 0.0f)
+            return;
+        // |m + t d|^2 = reach^2, first root in 0..1
+        float b = glm::dot(m, d);
+        if (b >= 0.0f) // moving away
+            return;
+        float discriminant = b * b - dd * c;
+        if (discriminant < 0.0f)
+            return;
+        float t = (-b - std::sqrt(discriminant)) / dd;
+        if (t <= 1.0f)
+            hits.push_back({ handle, ids[handle], layers[handle], t });
+    });
+
+    std::sort(hits.begin() + first, hits.end(), [](const CollisionHit& a, const CollisionHit& b) {
+        return a.t < b.t || (a.t == b.t && a.handle < b.handle);
+    });
+    return (int)(hits.size() - first);
+}
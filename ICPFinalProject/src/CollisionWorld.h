@@ -0,0 +1,97 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <vector>
+#include <cstdint>
+
+#include "SphereBatch.h"
+
+/*
+	Sphere colliders in a spatial hash (uniform grid of cellSize cubes hashed into buckets).
+
+	- every collider sits in the cell of its center, queries visit the cells their bounds
+	  (expanded by the largest collider radius) touch; colliders bigger than half a cell are kept
+	  in a separate list that every query checks
+	- all tests use squared distances, a square root is taken only for the time of impact of a hit
+	- colliders are stored as SoA floats; sphere queries wider than the grid run the SIMD batch
+	  kernel (SphereBatch.h) over all of them instead of walking cells, segment queries run
+	  their broadphase candidates through it against the sphere around the segment before the
+	  exact swept test (the game's coin and bomb checks)
+	- queries use internal scratch buffers, one thread at a time
+	- QuerySegment = "everything within r of the segment p0-p1" = swept sphere of radius r,
+	  so a fast object can't skip through a small one between two ticks
+	- handles stay valid until Remove(), freed slots are reused
+*/
+
+// collider kinds, queries take a mask of them
+enum Collider_Layer : uint32_t {
+    LAYER_COIN = 1 << 0,
+    LAYER_BOMB = 1 << 1,
+    LAYER_ALL = 0xFFFFFFFF
+};
+
+struct CollisionHit {
+    int handle;
+    int id;         // user id given to Insert (e.g. coin index)
+    uint32_t layer;
+    float t;        // segment queries: first touch along p0 -> p1 (0..1), sphere queries: 0
+};
+
+class CollisionWorld {
+
+public:
+    CollisionWorld(float cellSize = 2.0f, int bucketCount = 1024);
+
+    int Insert(const glm::vec3& center, float radius, uint32_t layer, int id);
+    void Move(int handle, const glm::vec3& center);
+    void Remove(int handle);
+    void Clear();
+
+    int Count() const { return count; }
+    glm::vec3 Center(int handle) const { return spheres.Center(handle); }
+
+    // colliders within r of the point (hits appended to `hits`), returns number of hits
+    int QuerySphere(const glm::vec3& center, float r, uint32_t layers, std::vector<CollisionHit>& hits) const;
+
+    // colliders within r of the segment p0-p1, hits sorted by t
+    int QuerySegment(const glm::vec3& p0, const glm::vec3& p1, float r, uint32_t layers, std::vector<CollisionHit>& hits) const;
+
+    // narrow phase pairs tested by the last queries (how well the broadphase prunes)
+    mutable unsigned long long tested = 0;
+
+private:
+    float cellSize;
+    float invCellSize;
+    uint32_t bucketMask;
+    int count = 0;
+    float maxRadius = 0.0f; // of the colliders in the grid
+
+    // per collider (struct of arrays, index = handle)
+    SphereSoA spheres;
+    std::vector<uint32_t> layers;
+    std::vector<int> ids;
+    std::vector<glm::ivec3> cells;
+    std::vector<int> next;   // next collider in the same bucket, or next free slot
+    std::vector<int8_t> where; // 0 = free slot, 1 = grid, 2 = large list
+
+    std::vector<int> buckets; // first collider of every bucket, -1 = empty
+    std::vector<int> large;   // colliders bigger than half a cell
+    int freeList = -1;
+    mutable std::vector<uint64_t> mask; // hit bits of the batch kernel
+    mutable std::vector<int> candidates; // broadphase result of a segment query
+    mutable SphereSoA batch;             // their spheres, the kernel's input
+
+    glm::ivec3 cellOf(const glm::vec3& p) const;
+    uint32_t bucketOf(const glm::ivec3& cell) const;
+    void link(int handle);
+    void unlink(int handle);
+    void rehash(int bucketCount);
+
+    // the box lo..hi (grown by the largest radius) covers more cells than there are colliders
+    bool wide(const glm::vec3& lo, const glm::vec3& hi) const;
+
+    // calls test(handle) for every collider of the layers whose sphere can touch the box lo..hi
+    template <typename F>
+    void visit(const glm::vec3& lo, const glm::vec3& hi, uint32_t layerMask, F test) const;
+
+};
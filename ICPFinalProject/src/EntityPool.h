@@ -0,0 +1,150 @@
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+/*
+	Entities of one kind (coins, bombs, particles...) with their components stored as
+	structure-of-arrays: one dense std::vector per component, live entities only, no holes.
+
+	- Add / Remove are O(1): removing moves the last entity into the hole (order is not kept,
+	  but it is deterministic, so replays stay bit-exact)
+	- EntityHandle stays valid until its entity is removed; a reused slot gets a new
+	  generation, so old handles are recognised as dead
+	- systems walk Column<C>() pointers over [0, Size())
+
+	Components are addressed by index, kinds name them with an enum:
+		enum { COIN_POSITION, COIN_COOLDOWN };
+		EntityPool<glm::vec3, float> coins;
+		float* cooldowns = coins.Column<COIN_COOLDOWN>();
+*/
+
+struct EntityHandle {
+    uint32_t slot = 0xFFFFFFFF;
+    uint32_t generation = 0;
+
+    bool operator==(const EntityHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+template <typename... Components>
+class EntityPool {
+
+public:
+    EntityHandle Add(const Components&... values)
+    {
+        uint32_t slot;
+        if (free_slots.empty()) {
+            slot = (uint32_t)slots.size();
+            slots.push_back({ 0, 0 });
+        }
+        else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        }
+        slots[slot].dense = (uint32_t)owners.size();
+        owners.push_back(slot);
+        push(std::index_sequence_for<Components...>(), values...);
+        return { slot, slots[slot].generation };
+    }
+
+    // returns false for handles of entities that are already gone
+    bool Remove(EntityHandle handle)
+    {
+        if (!Alive(handle))
+            return false;
+        uint32_t dense = slots[handle.slot].dense;
+        uint32_t last = (uint32_t)owners.size() - 1;
+        moveLast(std::index_sequence_for<Components...>(), dense);
+        owners[dense] = owners[last];
+        slots[owners[dense]].dense = dense;
+        owners.pop_back();
+
+        slots[handle.slot].generation++;
+        free_slots.push_back(handle.slot);
+        return true;
+    }
+
+    bool Alive(EntityHandle handle) const
+    {
+        return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation
+            && slots[handle.slot].dense < owners.size() && owners[slots[handle.slot].dense] == handle.slot;
+    }
+
+    size_t Size() const { return owners.size(); }
+
+    // dense arrays of one component, valid until the next Add / Remove
+    template <size_t C>
+    auto* Column() { return std::get<C>(columns).data(); }
+    template <size_t C>
+    const auto* Column() const { return std::get<C>(columns).data(); }
+
+    // position of a live entity in the dense arrays
+    uint32_t IndexOf(EntityHandle handle) const { return slots[handle.slot].dense; }
+
+    template <size_t C>
+    auto& Get(EntityHandle handle) { return std::get<C>(columns)[slots[handle.slot].dense]; }
+
+    EntityHandle HandleAt(size_t index) const
+    {
+        uint32_t slot = owners[index];
+        return { slot, slots[slot].generation };
+    }
+
+    // handle of the entity currently in a slot (slots are what other systems, e.g. collision ids, store)
+    EntityHandle HandleOfSlot(uint32_t slot) const { return { slot, slots[slot].generation }; }
+
+    void Reserve(size_t count)
+    {
+        reserve(std::index_sequence_for<Components...>(), count);
+        owners.reserve(count);
+        slots.reserve(count);
+    }
+
+    void Clear()
+    {
+        clear(std::index_sequence_for<Components...>());
+        owners.clear();
+        slots.clear();
+        free_slots.clear();
+    }
+
+private:
+    struct Slot {
+        uint32_t dense;      // index into the component arrays
+        uint32_t generation; // bumped on every Remove
+    };
+
+    std::tuple<std::vector<Components>...> columns;
+    std::vector<uint32_t> owners; // dense index -> slot
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+
+    template <size_t... I>
+    void push(std::index_sequence<I...>, const Components&... values)
+    {
+        (std::get<I>(columns).push_back(values), ...);
+    }
+
+    template <size_t... I>
+    void moveLast(std::index_sequence<I...>, uint32_t dense)
+    {
+        ((std::get<I>(columns)[dense] = std::move(std::get<I>(columns).back()), std::get<I>(columns).pop_back()), ...);
+    }
+
+    template <size_t... I>
+    void reserve(std::index_sequence<I...>, size_t count)
+    {
+        (std::get<I>(columns).reserve(count), ...);
+    }
+
+    template <size_t... I>
+    void clear(std::index_sequence<I...>)
+    {
+        (std::get<I>(columns).clear(), ...);
+    }
+
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <cstdint>
+
+/*
+	Image buffers of the tracking pipeline, allocated once for the mode the camera agreed to.
+
+	Every stage owns one buffer at a time and the stages hand buffer indices to each other
+	(LatestSlot swaps them: whoever publishes gets a free index back), so frames are written
+	in place and never copied. Reading a frame of the same size into a buffer reuses its
+	memory; a frame of another size makes cv::Mat reallocate it, Reallocated() notices that.
+*/
+class FramePool {
+
+public:
+    // count BGR buffers of width x height (0 x 0 = unknown, the first frame allocates them)
+    void Allocate(int count, int width, int height)
+    {
+        buffers.assign(count, cv::Mat());
+        memory.assign(count, nullptr);
+        for (int i = 0; i < count; i++) {
+            if (width > 0 && height > 0)
+                buffers[i].create(height, width, CV_8UC3);
+            memory[i] = buffers[i].data;
+        }
+    }
+
+    int Size() const { return (int)buffers.size(); }
+    cv::Mat& operator[](int index) { return buffers[index]; }
+
+    // true when the buffer's memory changed since the last call (or Allocate), by its owner only
+    bool Reallocated(int index)
+    {
+        if (buffers[index].data == memory[index])
+            return false;
+        memory[index] = buffers[index].data;
+        return true;
+    }
+
+private:
+    std::vector<cv::Mat> buffers;
+    std::vector<const uint8_t*> memory;
+
+};
@@ -5,10 +5,13 @@
 #include <iostream>
 #include <filesystem>
 #include "stb_image.h" // loading image textures library
-#include <random>
 #include <opencv2\opencv.hpp>
 #include <chrono>
 #include <thread>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <fstream>
 
 
 
@@ -19,6 +22,23 @@
 #include "Camera.h"
 #include "Plane.h"
 #include "Model.h"
+#include "Skybox.h"
+#include "ChunkStreamer.h"
+#include "TerrainRenderer.h"
+#include "VegetationRenderer.h"
+#include "PreviewOverlay.h"
+#include "HudOverlay.h"
+#include "MetricHistory.h"
+#include "RenderStats.h"
+#include "GpuTimer.h"
+#include "Trace.h"
+#include "Benchmark.h"
+#include "Simulation.h"
+#include "Timing.h"
+
+// GPU timed render passes (GpuTimer), in drawing order
+enum Gpu_Pass { PASS_COINS, PASS_GROUND, PASS_LEVEL, PASS_PLANE, PASS_BOMBS, PASS_TREES, PASS_FLAME, PASS_LIGHTS, PASS_SKYBOX, PASS_OVERLAY, PASS_COUNT };
+static const char* PASS_NAMES[PASS_COUNT] = { "coins", "ground", "level", "plane", "bombs", "trees", "flame", "lights", "skybox", "overlay" };
 
 
 
@@ -47,26 +67,6 @@
 */
 
 
-float randomFloatInRange(float min, float max) {
-	// Set up random number generation
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<float> dis(min, max);
-
-	// Generate random float
-	return dis(gen);
-}
-
-bool areVectorsInRange(glm::vec3 vector1, glm::vec3 vector2, float range) {
-	double distanceSquared = 0.0;
-	for (int i = 0; i < 3; ++i) {
-		double diff = vector1[i] - vector2[i];
-		distanceSquared += diff * diff;
-	}
-	double distance = std::sqrt(distanceSquared);
-	return distance <= range;
-}
-
 //glm::vec3 getRotationsFromVectors(const glm::vec3& front, const glm::vec3& up) {
 //	// Step 1: Normalize the vectors
 //	glm::vec3 normalizedFront = glm::normalize(front);
@@ -88,140 +88,25 @@ bool areVectorsInRange(glm::vec3 vector1, glm::vec3 vector2, float range) {
 
 void GameApp::init_opencv()
 {
-	//open first available camera
-	capture = cv::VideoCapture(cv::CAP_DSHOW);
-
-	if (!capture.isOpened())
+	//open the camera (or the source given on the command line)
+	if (!tracking.source.Open(captureSettings) && captureSettings.source == CAPTURE_CAMERA)
 	{
 		std::cerr << "no camera source? Fallback to video..." << std::endl;
 
 		//open video file
-		capture = cv::VideoCapture("resources/letadlo.mp4");
-		if (!capture.isOpened())
-		{
-			std::cerr << "no source?... " << std::endl;
-			exit(EXIT_FAILURE);
-		}
-	}
-}
-
-cv::Point2f GameApp::find_center_normalized_hsv(cv::Mat& frame)
-{
-	// convert to grayscale, create threshold, sum white pixels
-	// compute centroid of white pixels (average X,Y coordinate of all white pixels)
-	cv::Point2f center;
-	cv::Point2f center_normalized = cv::Point2f(0.0f, 0.0f);
-	//double h_low = 150.0;
-	//double s_low = 50.0;
-	//double v_low = 50.0;
-
-	//double h_hi = 180.0;
-	//double s_hi = 100.0;
-	//double v_hi = 100.0;
-
-	//lubosova plet
-	double h_low = 170.0;
-	double s_low = 150.0;
-	double v_low = 150.0;
-
-	double h_hi = 180.0;
-	double s_hi = 255.0;
-	double v_hi = 250.0;
-
-	cv::Mat scene_hsv, scene_threshold;
-
-	cv::cvtColor(frame, scene_hsv, cv::COLOR_BGR2HSV);
-
-	cv::Scalar lower_threshold = cv::Scalar(h_low, s_low, v_low);
-	cv::Scalar upper_threshold = cv::Scalar(h_hi, s_hi, v_hi);
-	cv::inRange(scene_hsv, lower_threshold, upper_threshold, scene_threshold);
-
-	int sy = 0, sx = 0, s = 0;
-	for (int y = 0; y < frame.rows; y++){
-		for (int x = 0; x < frame.cols; x++){
-			if (scene_threshold.at<unsigned char>(y, x) < 255) {
-
-			}
-			else {
-				sx += x;
-				sy += y;
-				s++;
-			}
-		}
-	}
-	cv::imshow("Frame", scene_threshold);
-	if (s == 0) {
-		return center_normalized;
-	}
-	center = cv::Point2f(sx / (float)s, sy / (float)s);
-	center_normalized = cv::Point2f(center.x / frame.cols, center.y / frame.rows);
-
-	//std::cout << "Center absolute: " << center << '\n';
-	//std::cout << "Center normalized: " << center_normalized << '\n';
-
-	return center_normalized;
-}
-
-void GameApp::draw_cross_normalized(cv::Mat& img, cv::Point2f center_normalized, int size)
-{
-	center_normalized.x = std::clamp(center_normalized.x, 0.0f, 1.0f);
-	center_normalized.y = std::clamp(center_normalized.y, 0.0f, 1.0f);
-	//size = std::clamp(size, 1, std::min(img.cols, img.rows));
-
-	cv::Point2f center_absolute(center_normalized.x * img.cols, center_normalized.y * img.rows);
-
-	cv::Point2f p1(center_absolute.x - size / 2, center_absolute.y);
-	cv::Point2f p2(center_absolute.x + size / 2, center_absolute.y);
-	cv::Point2f p3(center_absolute.x, center_absolute.y - size / 2);
-	cv::Point2f p4(center_absolute.x, center_absolute.y + size / 2);
-
-	cv::line(img, p1, p2, CV_RGB(0, 255, 0), 3);
-	cv::line(img, p3, p4, CV_RGB(0, 255, 0), 3);
-}
-
-void GameApp::ObjectDetection(void)
-{
-	cv::Mat frame;
-
-	try {
-		while (true)
-		{
-			capture >> frame;
-
-			if (frame.empty()) {
-				if (GameEnd)
-				{
-					capture.release();
-					break;
-				}
-				continue;
-			}
-			cv::namedWindow("Frame"); // Create a window
-
-			cv::Point2f center_normalized = find_center_normalized_hsv(frame);
-
-			draw_cross_normalized(frame, center_normalized, 20);
-
-			//cv::imshow("Frame", frame); // Show our image inside the created window.
-
-			cv::waitKey(100); // Wait for any keystroke in the window
-
-			centre = center_normalized;
-
-			if (GameEnd)
-			{
-				capture.release();
-				break;
-			}
-		}
+		CaptureSettings video = captureSettings;
+		video.source = CAPTURE_FILE;
+		video.file = "resources/letadlo.mp4";
+		tracking.source.Open(video);
 	}
-	catch (std::exception const& e) {
-		std::cerr << "App failed : " << e.what() << std::endl;
+	if (!tracking.source.IsOpen())
+	{
+		std::cerr << "no source?... " << std::endl;
 		exit(EXIT_FAILURE);
 	}
+	std::cout << "Capture: " << tracking.source.Mode().Describe() << std::endl;
 }
 
-
 //constructor
 GameApp::GameApp() {
 
@@ -250,8 +135,8 @@ GLFWwindow* GameApp::game_init_window() {
 	// make window current context
 	glfwSetWindowUserPointer(window, this);
 	glfwMakeContextCurrent(window);
-	//Vsync 0-off 1-on
-	glfwSwapInterval(0);
+	//Vsync 0-off 1-on (the simulation runs its own fixed step either way)
+	glfwSwapInterval(swapInterval);
 	// some window setups
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED); // hide cursor
 
@@ -267,8 +152,20 @@ GLFWwindow* GameApp::game_init_window() {
 
 int GameApp::run_game() {
 
+	// window, shaders, models and textures (their own scopes show up inside this one)
+	TraceScope startup("startup");
+	// benchmark: the same world every run, generated camera frames instead of whatever camera there is, no HUD
+	if (benchmark) {
+		if (!hasSeed) {
+			seed = Benchmark::SEED;
+			hasSeed = true;
+		}
+		if (captureSettings.source == CAPTURE_CAMERA)
+			captureSettings.source = CAPTURE_SYNTHETIC;
+		showHud = false;
+	}
 	GLFWwindow* window = game_init_window();
-	std::thread DetectionThread(&GameApp::ObjectDetection, this);
+	tracking.Start();
 
 	if (window == NULL)
 		return -1;
@@ -294,7 +191,9 @@ int GameApp::run_game() {
 	// build and compile shaders
 	// ------------------------------------
 	ShaderProgram ourShader("resources/shaders/vertex_shader.vert", "resources/shaders/fragment_shader.frag");
+	ShaderProgram terrainShader("resources/shaders/terrain.vert", "resources/shaders/fragment_shader.frag");
 	ShaderProgram lightShader("resources/shaders/light_vertex_shader.vert", "resources/shaders/light_fragment_shader.frag");
+	ShaderProgram skyboxShader("resources/shaders/skybox_vertex_shader.vert", "resources/shaders/skybox_fragment_shader.frag");
 
 	// Just for info: Getm maximun num of vertex attributes supported by GPU
 	int nrAttributes;
@@ -306,62 +205,34 @@ int GameApp::run_game() {
 	Model textured_cube = Model("resources/objects/cube_textured/cube_textured_opengl.obj");
 	Model bomb_model = Model("resources/objects/bomb/bomba.obj");
 	Model coin_model = Model("resources/objects/coin/mince.obj");
-	Model ground = Model("resources/objects/ground/ground.obj");
-	Model skybox = Model("resources/objects/skybox/skybox.obj");
+	Model wooden_map = Model("resources/objects/wooden_map/Wooden.obj");
+	Skybox skybox = Skybox("resources/objects/skybox/SkyboxColor.png");
 	Model light = Model("resources/objects/cube/cube_triangles_normals_tex.obj");
 
 	Model hull = Model("resources/objects/plane/Moje_letadlo_hull.obj");
 	Model rotor = Model("resources/objects/plane/Moje_letadlo_vrtule.obj");
 	Model cockpit = Model("resources/objects/plane/Moje_letadlo_cockpit.obj");
-	/* MAIN PROGRAM LOOP */
-	double previousTime = glfwGetTime();
-	double previousTick = glfwGetTime();
-	int frameCount = 0;
-
-
-	//coin positions (right,up,backward)
-	glm::vec3 coin_positions[] = {
-	glm::vec3(randomFloatInRange(-5.0f,-2.0f),  randomFloatInRange(0.2f,3.0f),randomFloatInRange(-5.0f,-2.0f)),
-	glm::vec3(randomFloatInRange(-5.0f,-2.0f),   randomFloatInRange(0.2f,3.0f),randomFloatInRange(-1.5f,1.5f)),
-	glm::vec3(randomFloatInRange(-5.0f,-2.0f),   randomFloatInRange(0.2f,3.0f),randomFloatInRange(2.0f,5.0f)),
-	glm::vec3(randomFloatInRange(-1.5f,1.5f),   randomFloatInRange(0.2f,3.0f),randomFloatInRange(-5.0f,-2.0f)),
-	glm::vec3(randomFloatInRange(-1.5f,1.5f),   randomFloatInRange(0.2f,3.0f),randomFloatInRange(-1.5f,1.5f)),
-	glm::vec3(randomFloatInRange(-1.5f,1.5f),   randomFloatInRange(0.2f,3.0f),randomFloatInRange(2.0f,5.0f)),
-	glm::vec3(randomFloatInRange(2.0f,5.0f),   randomFloatInRange(0.2f,3.0f),randomFloatInRange(-5.0f,-2.0f)),
-	glm::vec3(randomFloatInRange(2.0f,5.0f),   randomFloatInRange(0.2f,3.0f),randomFloatInRange(-1.5f,1.5f)),
-	glm::vec3(randomFloatInRange(2.0f,5.0f),   randomFloatInRange(0.2f,3.0f),randomFloatInRange(2.0f,5.0f)),
-	};
-
-	glm::vec3 bombs[99];
-	for (unsigned int i = 0; i < 99; i++) {
-		bombs[i] = glm::vec3(randomFloatInRange(-5.0f, 5.0f), randomFloatInRange(0.5f, 3.0f), randomFloatInRange(-5.0f, 5.0f));
-	}
-
-	//flame particles
-	glm::vec3 flame_forwards[100];
-	float flame_lifecycle[100];
-	float flame_lifespan[100];
-	for (unsigned int i = 0; i < 100; i++) {
-		flame_forwards[i] = glm::vec3(randomFloatInRange(-10.0f, 10.0f), randomFloatInRange(-10.0f, 10.0f), randomFloatInRange(-50.0f, -30.0f));
-		flame_lifecycle[i] = randomFloatInRange(0.01f, 0.02f);
-		flame_lifespan[i] = randomFloatInRange(0.1f, 0.5f);
+	// tracking camera picture-in-picture (the tracker hands over small previews, streamed through PBOs)
+	PreviewOverlay trackingPreview;
+	// performance HUD: rolling graphs, percentiles and counters (H shows / hides it)
+	HudOverlay hud;
+	MetricHistory frameHistory, cpuHistory, gpuHistory, tickHistory, latencyHistory;
+	static const int HUD_LINES = 11;
+	char hudText[HUD_LINES][160] = {};
+	double hudTextTime = 0.0;
+	unsigned long long lastHudTick = 0;
+	// GPU time per pass, read back a few frames late (never waits for the GPU), optionally into a CSV
+	GpuTimer gpuTimer(PASS_COUNT);
+	std::ofstream gpuCsv;
+	if (!gpuCsvPath.empty()) {
+		gpuCsv.open(gpuCsvPath);
+		gpuCsv << "frame,gpu_ms";
+		for (const char* name : PASS_NAMES)
+			gpuCsv << ',' << name << "_ms";
+		gpuCsv << '\n';
 	}
-
-
-	int coin_cooldowns[] = { 0,0,0,0,0,0,0,0,0 };
-	float coin_angles[] = { 
-		randomFloatInRange(0.0f, 360.0f),
-		randomFloatInRange(0.0f, 360.0f),
-		randomFloatInRange(0.0f, 360.0f),
-		randomFloatInRange(0.0f, 360.0f),
-		randomFloatInRange(0.0f, 360.0f),
-		randomFloatInRange(0.0f, 360.0f),
-		randomFloatInRange(0.0f, 360.0f),
-		randomFloatInRange(0.0f, 360.0f),
-		randomFloatInRange(0.0f, 360.0f),
-	};
-	float coin_angle = 0.0f;
-	float rotor_angle = 0.0f;
+	/* MAIN PROGRAM LOOP */
+	TimingStats frameStats;
 
 	int NUM_OF_POINT_LIGHTS = 1;
 	glm::vec3 pointLightPositions[] = {
@@ -371,128 +242,141 @@ int GameApp::run_game() {
 	glm::vec3(0.0f,  0.0f, -3.0f)
 	};
 
+	// seed: from the replayed recording, the command line or random
+	if (!replayPath.empty()) {
+		if (!player.Open(replayPath))
+			return -1;
+		seed = player.Seed();
+		std::cout << "Replaying " << replayPath << " (seed " << seed << ", " << player.TotalTicks() << " ticks)" << std::endl;
+	}
+	else if (!hasSeed) {
+		seed = std::random_device{}();
+	}
+	if (Simulation::LoadTerrain(terrain))
+		std::cout << "Terrain BVH: " << terrain.TriangleCount() << " triangles, " << terrain.NodeCount() << " nodes, built in " << terrain.build_seconds * 1000.0 << " ms" << std::endl;
+	simulation = Simulation(seed, terrain.Empty() ? nullptr : &terrain);
+	if (!recordPath.empty() && recorder.Open(recordPath, seed, Simulation::TICK_DT))
+		std::cout << "Recording into " << recordPath << " (seed " << seed << ")" << std::endl;
+
+	// ground tiles and trees around the viewer, built on worker threads (same seed = same world)
+	ChunkStreamer chunks(seed);
+	// trees of those chunks: instanced meshes up close, baked impostors further away
+	VegetationRenderer vegetation(chunks);
+	// heightmap ground under all of it, same seed = same hills
+	TerrainRenderer ground(seed);
+	VegetationBatch trees;
+
+	// initial state for the renderer, then hand the game logic over to its own thread
+	simulation.WriteSnapshot(snapshots.WriteBuffer());
+	snapshots.Publish();
+	snapshots.Acquire();
+	inputs.WriteBuffer() = input;
+	inputs.Publish();
+	std::thread SimulationThread(&GameApp::SimulationLoop, this);
+	startup.End();
+
+	// the render loop doesn't print anything, the numbers are on the HUD
+	std::cout << "Ovladani: Kamera: Mys a WSAD  ,, Letadlo: sipky" << std::endl;
+	std::cout << "1:pohled ze zeme   2:fixni pohled ze 3.osoby  3:rotacni pohled ze treti osoby" << std::endl;
+	std::cout << "T/U:zapnuti/vypnuti ovladani kamerou" << std::endl;
+	std::cout << "F/V:fulscreen/windowed" << std::endl;
+	std::cout << "H:vykon (HUD)" << std::endl;
+	Game_Over finalState = GAME_RUNNING;
+	int finalScore = 0;
+	uint64_t frameIndex = 0;
+	bool benchmarkCompleted = false;
 
 
 	while (!glfwWindowShouldClose(window))
 	{
+		TRACE_SCOPE("frame");
 
 		// Measure FPS speed
 		float currentFrame = glfwGetTime();
+		double frameStart = NowSeconds();
 		// count delta time
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
-		frameCount++;
-		// If a second has passed.
-		if (currentFrame - previousTime >= 1.0)
-		{
-			system("cls");
-			// Display the frame count here any way you want.
-			std::cout << "FPS: " << frameCount << std::endl;
-
-			std::cout << "Ovladani: Kamera: Mys a WSAD  ,, Letadlo: sipky" << std::endl;
-			std::cout << "1:pohled ze zeme   2:fixni pohled ze 3.osoby  3:rotacni pohled ze treti osoby" << std::endl;
-			std::cout << "T/U:zapnuti/vypnuti ovladani kamerou" << std::endl;
-			std::cout << "F/V:fulscreen/windowed" << std::endl << std::endl;
-			std::cout << "Score: " << score << std::endl;
-			std::cout << "Tracking: " << centre << std::endl;
-			frameCount = 0;
-			previousTime = currentFrame;
-		}
-		//game tick 60hz
-		if (currentFrame - previousTick >= 0.016) {
-			if (GameFreeze == false) {
-				if (controllMode == 1) {
-					plane.Yaw += (centre.x - 0.5f) * 2.0f;
-					plane.Pitch += (centre.y - 0.5f) * 2.0f;
-					if (plane.Yaw > 360) plane.Yaw -= 360;
-					if (plane.Yaw < 0) plane.Yaw += 360;
-					if (plane.Pitch > 89.0f) plane.Pitch = 89.0f;
-					if (plane.Pitch < -89.0f) plane.Pitch = -89.0f;
-					plane.updatePlaneVectors();
-
-				}
-				//movement
-				plane.Position += plane.Front * plane.MovementSpeed * 0.001f;
-
-				//baloon cooldowns
-				for (unsigned int i = 0; i < 9; i++)
-				{
-					if (coin_cooldowns[i] > 0) {
-						coin_cooldowns[i] -= 1;
-					}
-				}
-				//flame
-				for (unsigned int i = 0; i < 100; i++) {
-					flame_lifecycle[i] += 0.03f;
-				}
 
+		// latest finished game tick (keeps the previous one if the simulation has nothing new)
+		snapshots.Acquire();
+		const WorldSnapshot& world = snapshots.ReadBuffer();
 
-				if (coin_angle > 360.0f) {
-					coin_angle -= 360.f;
-				}
-				else {
-					coin_angle += 1.0f;
-				}
-
-				if (rotor_angle > 360.0f) {
-					rotor_angle -= 360.f;
-				}
-				else {
-					rotor_angle += 25.0f;
-				}
-				//colisions
-
-				//coins
-				for (unsigned int i = 0; i < 9; i++)
-				{
-					if (areVectorsInRange(plane.Position + plane.Front * 0.3f, coin_positions[i], 0.5f) == true) {
-						if (coin_cooldowns[i] == 0) {
-							coin_positions[i] = glm::vec3(randomFloatInRange(-5.0f, 5.0f), randomFloatInRange(0.0f, 3.0f), randomFloatInRange(-5.0f, 5.0f)),
-								score += 1;
-							coin_cooldowns[i] = 600;
-						}
-
-					}
-				}
-				//bombs
-				for (int i = 0; i < int(score / 2); i++)
-				{
-					if (areVectorsInRange(plane.Position + plane.Front * 0.3f, bombs[i], 0.6f) == true) {
-						std::cout << "Boom, to byla bomba... Finalni skore: " << score << std::endl;
-						glfwSetWindowShouldClose(window, true);
-					}
-				}
-
-				//ground
-				if (plane.Position.y < 0) {
-					std::cout << "Boom, havaroval jsi... Finalni skore: " << score << std::endl;
-					glfwSetWindowShouldClose(window, true);
-				}
-				//skybox
-				if (areVectorsInRange(plane.Position + plane.Front * 0.5f, glm::vec3(0.0f, 0.0f, 0.0f), 10.0f) == false) {
-					std::cout << "Boom, mapa neni nekonecna... Finalni skore: " << score << std::endl << std::endl << std::endl;
-					glfwSetWindowShouldClose(window, true);
-				}
-			}
-			previousTick = currentFrame;
+		FrameRenderStats() = RenderStats();
+		// tick time of every tick the render thread sees (most of them, it runs faster)
+		if (world.tick != lastHudTick) {
+			lastHudTick = world.tick;
+			tickHistory.Add(world.tick_ms);
 		}
-		// check keyboard inputs
-		processInput(window);
-
-		
-		
-
-
-		
-
-
-
 
+		if (world.game_over != GAME_RUNNING) {
+			finalState = world.game_over;
+			finalScore = world.score;
+			glfwSetWindowShouldClose(window, true);
+		}
+		if (world.replay_finished)
+			glfwSetWindowShouldClose(window, true);
 
+		// check keyboard inputs and pass them to the simulation
+		processInput(window);
+		// newest tracking sample, extrapolated over the pipeline latency to now
+		TrackingResult tracked = tracking.Latest();
+		if (tracked.frame != lastTrackedFrame) {
+			lastTrackedFrame = tracked.frame;
+			TrackingSample sample;
+			sample.capture_time = tracked.capture_time;
+			sample.result_time = tracked.result_time;
+			sample.center = tracked.center;
+			sample.confidence = tracked.confidence;
+			trackingPredictor.Add(sample);
+			latencyHistory.Add((float)((tracked.result_time - tracked.capture_time) * 1000.0));
+			if (recorder.IsOpen())
+				trackingSamples.push_back(sample);
+		}
+		input.tracking = trackingPredictor.Predict(NowSeconds());
+		// the flythrough replaces the player, the game itself stands still (nothing to crash into)
+		if (benchmark) {
+			input.GameFreeze = true;
+			input.controllMode = 0;
+		}
+		inputs.WriteBuffer() = input;
+		inputs.Publish();
+
+		// render one tick behind the simulation and blend the last two ticks
+		float alpha = (float)((frameStart - world.state_time) / Simulation::TICK_DT);
+		alpha = std::clamp(alpha, 0.0f, 1.0f);
+		PlaneState plane = Interpolate(world.previous_plane, world.plane, alpha);
+		float rotor_angle = LerpAngle(world.previous_rotor_angle, world.rotor_angle, alpha);
+		float coin_angle = LerpAngle(world.previous_coin_angle, world.coin_angle, alpha);
+		CameraState camera = world.camera;
+		camera.Position = glm::mix(world.previous_camera_position, world.camera.Position, alpha);
+		int activeView = world.activeView;
+		if (benchmark)
+			bench.Pose(frameIndex, seed, plane, camera, activeView, rotor_angle, coin_angle);
+
+		// stream the world around whatever the view follows, at most a few uploads per frame
+		TraceScope scene("scene");
+		chunks.Update(activeView == 0 ? camera.Position : plane.Position);
+		vegetation.Sync(chunks);
 
 
 		/* rendering commands ... */
 
+		// results of every frame the GPU got through since the last one, a frame or two back
+		while (gpuTimer.Resolve()) {
+			gpuHistory.Add(gpuTimer.FrameMs());
+			TRACE_COUNTER("gpu ms", gpuTimer.FrameMs());
+			if (benchmark)
+				bench.RecordGpu(gpuTimer.ResolvedFrame() - 1, gpuTimer.FrameMs()); // BeginFrame() counts from 1
+			if (gpuCsv.is_open()) {
+				gpuCsv << gpuTimer.ResolvedFrame() << ',' << gpuTimer.FrameMs();
+				for (int pass = 0; pass < PASS_COUNT; pass++)
+					gpuCsv << ',' << gpuTimer.PassMs(pass);
+				gpuCsv << '\n';
+			}
+		}
+		gpuTimer.BeginFrame();
+
 		// first clear the colorbuffer and depth buffer
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -503,67 +387,71 @@ int GameApp::run_game() {
 		glm::vec3 ambientColor(0.1f, 0.1f, 0.1f);
 
 
+		// the ground has its own vertex shader, the same fragment shader and lights
 		// don't forget to enable shader before setting uniforms
+		for (ShaderProgram* lit : { &ourShader, &terrainShader }) {
+			lit->use();
+			lit->setVec3("viewPos", camera.Position);
+			lit->setFloat("material.shininess", 32.0f);
+
+
+			/*
+			   Here we set all the uniforms for the 5/6 types of lights we have. We have to set them manually and index
+			   the proper PointLight struct in the array to set each uniform variable. This can be done more code-friendly
+			   by defining light types as classes and set their values in there, or by using a more efficient uniform approach
+			   by using 'Uniform buffer objects', but that is something we'll discuss in the 'Advanced GLSL' tutorial.
+			*/
+			// directional light
+			lit->setVec3("dirLight.direction", -0.2f, -1.0f, -0.3f);
+			lit->setVec3("dirLight.ambient", 0.05f, 0.05f, 0.05f);
+			lit->setVec3("dirLight.diffuse", 0.4f, 0.4f, 0.4f);
+			lit->setVec3("dirLight.specular", 0.5f, 0.5f, 0.5f);
+			// point light 1
+			lit->setVec3("pointLights[0].position", pointLightPositions[0]);
+			lit->setVec3("pointLights[0].ambient", 0.05f, 0.05f, 0.05f);
+			lit->setVec3("pointLights[0].diffuse", 0.8f, 0.8f, 0.8f);
+			lit->setVec3("pointLights[0].specular", 1.0f, 1.0f, 1.0f);
+			lit->setFloat("pointLights[0].constant", 1.0f);
+			lit->setFloat("pointLights[0].linear", 0.09f);
+			lit->setFloat("pointLights[0].quadratic", 0.032f);
+			// point light 2
+			//lit->setVec3("pointLights[1].position", pointLightPositions[1]);
+			//lit->setVec3("pointLights[1].ambient", 0.05f, 0.05f, 0.05f);
+			//lit->setVec3("pointLights[1].diffuse", 0.8f, 0.8f, 0.8f);
+			//lit->setVec3("pointLights[1].specular", 1.0f, 1.0f, 1.0f);
+			//lit->setFloat("pointLights[1].constant", 1.0f);
+			//lit->setFloat("pointLights[1].linear", 0.09f);
+			//lit->setFloat("pointLights[1].quadratic", 0.032f);
+			////// point light 3
+			//lit->setVec3("pointLights[2].position", pointLightPositions[2]);
+			//lit->setVec3("pointLights[2].ambient", 0.05f, 0.05f, 0.05f);
+			//lit->setVec3("pointLights[2].diffuse", 0.8f, 0.8f, 0.8f);
+			//lit->setVec3("pointLights[2].specular", 1.0f, 1.0f, 1.0f);
+			//lit->setFloat("pointLights[2].constant", 1.0f);
+			//lit->setFloat("pointLights[2].linear", 0.09f);
+			//lit->setFloat("pointLights[2].quadratic", 0.032f);
+			////// point light 4
+			//lit->setVec3("pointLights[3].position", pointLightPositions[3]);
+			//lit->setVec3("pointLights[3].ambient", 0.05f, 0.05f, 0.05f);
+			//lit->setVec3("pointLights[3].diffuse", 0.8f, 0.8f, 0.8f);
+			//lit->setVec3("pointLights[3].specular", 1.0f, 1.0f, 1.0f);
+			//lit->setFloat("pointLights[3].constant", 1.0f);
+			//lit->setFloat("pointLights[3].linear", 0.09f);
+			//lit->setFloat("pointLights[3].quadratic", 0.032f);
+			// Spotlight
+			glm::vec3 spotlight_position = plane.Position + plane.Front * 0.5f;
+			lit->setVec3("spotLight.position", spotlight_position);
+			lit->setVec3("spotLight.direction", plane.Front);
+			lit->setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
+			lit->setVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
+			lit->setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
+			lit->setFloat("spotLight.constant", 0.4f);
+			lit->setFloat("spotLight.linear", 0.0001f);
+			lit->setFloat("spotLight.quadratic", 0.0001f);
+			lit->setFloat("spotLight.cutOff", glm::cos(glm::radians(10.0f)));
+			lit->setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
+		}
 		ourShader.use();
-		ourShader.setVec3("viewPos", camera.Position);
-		ourShader.setFloat("material.shininess", 32.0f);
-
-
-		/*
-		   Here we set all the uniforms for the 5/6 types of lights we have. We have to set them manually and index
-		   the proper PointLight struct in the array to set each uniform variable. This can be done more code-friendly
-		   by defining light types as classes and set their values in there, or by using a more efficient uniform approach
-		   by using 'Uniform buffer objects', but that is something we'll discuss in the 'Advanced GLSL' tutorial.
-		*/
-		// directional light
-		ourShader.setVec3("dirLight.direction", -0.2f, -1.0f, -0.3f);
-		ourShader.setVec3("dirLight.ambient", 0.05f, 0.05f, 0.05f);
-		ourShader.setVec3("dirLight.diffuse", 0.4f, 0.4f, 0.4f);
-		ourShader.setVec3("dirLight.specular", 0.5f, 0.5f, 0.5f);
-		// point light 1
-		ourShader.setVec3("pointLights[0].position", pointLightPositions[0]);
-		ourShader.setVec3("pointLights[0].ambient", 0.05f, 0.05f, 0.05f);
-		ourShader.setVec3("pointLights[0].diffuse", 0.8f, 0.8f, 0.8f);
-		ourShader.setVec3("pointLights[0].specular", 1.0f, 1.0f, 1.0f);
-		ourShader.setFloat("pointLights[0].constant", 1.0f);
-		ourShader.setFloat("pointLights[0].linear", 0.09f);
-		ourShader.setFloat("pointLights[0].quadratic", 0.032f);
-		// point light 2
-		//ourShader.setVec3("pointLights[1].position", pointLightPositions[1]);
-		//ourShader.setVec3("pointLights[1].ambient", 0.05f, 0.05f, 0.05f);
-		//ourShader.setVec3("pointLights[1].diffuse", 0.8f, 0.8f, 0.8f);
-		//ourShader.setVec3("pointLights[1].specular", 1.0f, 1.0f, 1.0f);
-		//ourShader.setFloat("pointLights[1].constant", 1.0f);
-		//ourShader.setFloat("pointLights[1].linear", 0.09f);
-		//ourShader.setFloat("pointLights[1].quadratic", 0.032f);
-		////// point light 3
-		//ourShader.setVec3("pointLights[2].position", pointLightPositions[2]);
-		//ourShader.setVec3("pointLights[2].ambient", 0.05f, 0.05f, 0.05f);
-		//ourShader.setVec3("pointLights[2].diffuse", 0.8f, 0.8f, 0.8f);
-		//ourShader.setVec3("pointLights[2].specular", 1.0f, 1.0f, 1.0f);
-		//ourShader.setFloat("pointLights[2].constant", 1.0f);
-		//ourShader.setFloat("pointLights[2].linear", 0.09f);
-		//ourShader.setFloat("pointLights[2].quadratic", 0.032f);
-		////// point light 4
-		//ourShader.setVec3("pointLights[3].position", pointLightPositions[3]);
-		//ourShader.setVec3("pointLights[3].ambient", 0.05f, 0.05f, 0.05f);
-		//ourShader.setVec3("pointLights[3].diffuse", 0.8f, 0.8f, 0.8f);
-		//ourShader.setVec3("pointLights[3].specular", 1.0f, 1.0f, 1.0f);
-		//ourShader.setFloat("pointLights[3].constant", 1.0f);
-		//ourShader.setFloat("pointLights[3].linear", 0.09f);
-		//ourShader.setFloat("pointLights[3].quadratic", 0.032f);
-		// Spotlight
-		glm::vec3 spotlight_position = plane.Position + plane.Front * 0.5f;
-		ourShader.setVec3("spotLight.position", spotlight_position);
-		ourShader.setVec3("spotLight.direction", plane.Front);
-		ourShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
-		ourShader.setVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
-		ourShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
-		ourShader.setFloat("spotLight.constant", 0.4f);
-		ourShader.setFloat("spotLight.linear", 0.0001f);
-		ourShader.setFloat("spotLight.quadratic", 0.0001f);
-		ourShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(10.0f)));
-		ourShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
 
 		/* Going 3D */
 
@@ -615,12 +503,13 @@ int GameApp::run_game() {
 
 		glm::mat4 model = glm::mat4(1.0f);
 		// coins
-		for (unsigned int i = 0; i < 9; i++)
+		gpuTimer.Begin(PASS_COINS);
+		for (size_t i = 0; i < world.coin_positions.size(); i++)
 		{
-			if (coin_cooldowns[i] == 0) {
+			if (world.coin_visible[i]) {
 				model = glm::mat4(1.0f);
-				model = glm::translate(model, coin_positions[i]);
-				model = glm::rotate(model, glm::radians(coin_angles[i]+coin_angle), glm::vec3(0.0f, 1.0f, 0.0f));
+				model = glm::translate(model, world.coin_positions[i]);
+				model = glm::rotate(model, glm::radians(world.coin_angles[i] + coin_angle), glm::vec3(0.0f, 1.0f, 0.0f));
 				model = glm::scale(model, glm::vec3(0.001f));
 				ourShader.setMat4("model", model);
 				coin_model.Draw(ourShader);
@@ -629,12 +518,21 @@ int GameApp::run_game() {
 		}
 
 
-		//ground
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, glm::vec3(0.0f, 0.0f, -1.0f));
-		model = glm::scale(model, glm::vec3(10.0f));
-		ourShader.setMat4("model", model);
-		ground.Draw(ourShader);
+		gpuTimer.End();
+
+		//ground, patches around wherever the active view is
+		gpuTimer.Begin(PASS_GROUND);
+		glm::mat4 inverseView = glm::inverse(view);
+		glm::vec3 eye = glm::vec3(inverseView[3]);
+		glm::vec3 forward = -glm::vec3(inverseView[2]);
+		ground.Draw(terrainShader, view, projection, eye, forward);
+		gpuTimer.End();
+		ourShader.use();
+
+		//wooden map (the plane collides with it)
+		gpuTimer.Begin(PASS_LEVEL);
+		ourShader.setMat4("model", Simulation::WoodenMapTransform());
+		wooden_map.Draw(ourShader);
 		
 		
 		//textured_cube
@@ -644,12 +542,6 @@ int GameApp::run_game() {
 		ourShader.setMat4("model", model);
 		textured_cube.Draw(ourShader);
 
-		//skybox
-		model = glm::mat4(1.0f);
-		model = glm::scale(model, glm::vec3(5.0f));
-		ourShader.setMat4("model", model);
-		skybox.Draw(ourShader);
-
 
 		//zcube test
 		//model = glm::mat4(1.0f);
@@ -658,7 +550,10 @@ int GameApp::run_game() {
 		//ourShader.setMat4("model", model);
 		//qube.Draw(ourShader);
 
+		gpuTimer.End();
+
 		//plane
+		gpuTimer.Begin(PASS_PLANE);
 		model = glm::mat4(1.0f);
 		model = glm::translate(model, plane.Position);
 		model = glm::rotate(model, glm::radians(plane.Yaw), glm::vec3(0.0f, 1.0f, 0.0f));
@@ -688,20 +583,34 @@ int GameApp::run_game() {
 		rotor.Draw(ourShader);
 
 
+		gpuTimer.End();
+
 		//bombs
-		for (int i = 0; i < int(score / 2); i++)
+		gpuTimer.Begin(PASS_BOMBS);
+		for (size_t i = 0; i < world.bombs.size(); i++)
 		{
 			model = glm::mat4(1.0f);
-			model = glm::translate(model, bombs[i]);
+			model = glm::translate(model, world.bombs[i]);
 			model = glm::scale(model, glm::vec3(0.001f));
 			ourShader.setMat4("model", model);
 			bomb_model.Draw(ourShader);
 
 		}
+
+		gpuTimer.End();
+
+		//trees
+		trees.Begin(eye, forward);
+		vegetation.Collect(trees);
+		gpuTimer.Begin(PASS_TREES);
+		vegetation.Draw(trees, view, projection, eye);
+		gpuTimer.End();
+
 		lightShader.use();
 		lightShader.setMat4("view", view);
 		lightShader.setMat4("projection", projection);
 		//flame
+		gpuTimer.Begin(PASS_FLAME);
 		glm::mat4 flame_model = glm::mat4(1.0f);
 		model = glm::mat4(1.0f);
 		model = glm::translate(model, plane.Position);
@@ -718,13 +627,8 @@ int GameApp::run_game() {
 		model = glm::rotate(model, glm::radians(plane.Yaw), glm::vec3(0.0f, 1.0f, 0.0f));
 		model = glm::rotate(model, -glm::radians(plane.Pitch), glm::vec3(1.0f, 0.0f, 0.0f));
 
-		for (unsigned int i = 0; i < 100; i++) {
-			if (flame_lifecycle[i] > flame_lifespan[i]) {
-				flame_forwards[i] = glm::vec3(randomFloatInRange(-10.0f, 10.0f), randomFloatInRange(-10.0f, 10.0f), randomFloatInRange(-50.0f, -30.0f));
-				flame_lifecycle[i] = randomFloatInRange(0.01f, 0.02f);
-				flame_lifespan[i] = randomFloatInRange(0.1f, 0.5f);
-			}
-			flame_model = glm::translate(model, flame_forwards[i] * flame_lifecycle[i]);
+		for (size_t i = 0; i < world.flame_offsets.size(); i++) {
+			flame_model = glm::translate(model, world.flame_offsets[i]);
 			flame_model = glm::scale(flame_model, glm::vec3(0.8f));
 			lightShader.setMat4("model", flame_model);
 			light.Draw(lightShader);
@@ -747,7 +651,10 @@ int GameApp::run_game() {
 		//}
 
 
+		gpuTimer.End();
+
 		/* Light */
+		gpuTimer.Begin(PASS_LIGHTS);
 		// don't forget to use the corresponding shader program first (to set the uniform)
 		lightShader.setMat4("view", view);
 		lightShader.setMat4("projection", projection);
@@ -760,18 +667,229 @@ int GameApp::run_game() {
 			light.Draw(lightShader);
 		}
 
+		gpuTimer.End();
+
+		//skybox - last, fills only the pixels no opaque geometry has covered
+		gpuTimer.Begin(PASS_SKYBOX);
+		skybox.Draw(skyboxShader, view, projection);
+		gpuTimer.End();
+
+		// camera preview over everything, a new image only when the tracker made one
+		gpuTimer.Begin(PASS_OVERLAY);
+		if (tracking.AcquirePreview()) {
+			const cv::Mat& image = tracking.Preview().image;
+			trackingPreview.Upload(image.data, image.cols, image.rows, image.step);
+		}
+		int framebufferWidth, framebufferHeight;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		trackingPreview.Draw(framebufferWidth, framebufferHeight);
+
+		// performance HUD: graphs every frame, the numbers 4 times a second (readable, and the sort isn't free)
+		RenderStats rendered = FrameRenderStats(); // the scene, without the overlays
+		scene.End();
+		TRACE_COUNTER("draw calls", rendered.draw_calls);
+		TRACE_COUNTER("triangles", rendered.triangles);
+		if (showHud) {
+			TRACE_SCOPE("hud");
+			if (frameStart - hudTextTime >= 0.25) {
+				hudTextTime = frameStart;
+				float p50, p95, p99;
+				frameHistory.Percentiles(p50, p95, p99);
+				std::snprintf(hudText[0], sizeof(hudText[0]), "frame %6.2f ms  p50 %.2f  p95 %.2f  p99 %.2f  (%.0f FPS)", frameHistory.Last(), p50, p95, p99, frameStats.rate);
+				cpuHistory.Percentiles(p50, p95, p99);
+				std::snprintf(hudText[1], sizeof(hudText[1]), "cpu   %6.2f ms  p50 %.2f  p95 %.2f  p99 %.2f", cpuHistory.Last(), p50, p95, p99);
+				gpuHistory.Percentiles(p50, p95, p99);
+				std::snprintf(hudText[7], sizeof(hudText[7]), "gpu   %6.2f ms  p50 %.2f  p95 %.2f  p99 %.2f  (%llu frames late, %llu unmeasured)", gpuHistory.Last(), p50, p95, p99,
+					(unsigned long long)gpuTimer.Latency(), (unsigned long long)gpuTimer.Unmeasured());
+				// per pass, two lines
+				for (int half = 0; half < 2; half++) {
+					int length = 0;
+					for (int pass = half * PASS_COUNT / 2; pass < (half + 1) * PASS_COUNT / 2; pass++)
+						length += std::snprintf(hudText[8 + half] + length, sizeof(hudText[8]) - length, "%s %.2f  ", PASS_NAMES[pass], gpuTimer.PassMs(pass));
+				}
+				tickHistory.Percentiles(p50, p95, p99);
+				std::snprintf(hudText[2], sizeof(hudText[2]), "tick  %6.2f ms  p50 %.2f  p95 %.2f  p99 %.2f  (%.0f/s, %llu dropped, collisions %.3f ms)", tickHistory.Last(), p50, p95, p99,
+					world.ticks_per_second, world.ticks_dropped, world.collision_ms_avg);
+				std::snprintf(hudText[3], sizeof(hudText[3]), "draws %d  triangles %zu  trees %zu + %zu impostors  terrain %zu patches  chunks %d (%d pending)",
+					rendered.draw_calls, rendered.triangles, trees.Near().size(), trees.Far().size(), ground.Patches(), vegetation.Chunks(), chunks.Pending());
+				std::snprintf(hudText[10], sizeof(hudText[10]), "chunk load %.1f ms avg  %.1f max  %.1f worst  (%llu loaded, %zu kB)  terrain %zu vertices  %zu kB GPU",
+					chunks.load_stats.avg_ms, chunks.load_stats.max_ms, chunks.load_ms_worst, chunks.Loaded(), chunks.CpuBytes() / 1024, ground.Vertices(), ground.GpuBytes() / 1024);
+				latencyHistory.Percentiles(p50, p95, p99);
+				std::snprintf(hudText[4], sizeof(hudText[4]), "track %6.2f ms  p50 %.2f  p95 %.2f  p99 %.2f  (%.0f fps, %llu of %llu dropped)", latencyHistory.Last(), p50, p95, p99,
+					tracking.Stats().rate, (unsigned long long)tracking.Dropped(), (unsigned long long)tracking.Captured());
+				TrackingLoad trackingLoad = tracking.Load();
+				std::snprintf(hudText[5], sizeof(hudText[5]), "track load %.0f px/frame (%s)  cpu %.0f %%  skipped %.0f %%  stage allocations %llu",
+					trackingLoad.pixels_per_frame, tracking.roi_tracking ? "ROI" : "full frame", trackingLoad.cpu_percent, trackingLoad.skipped_percent,
+					(unsigned long long)trackingLoad.allocations);
+				std::snprintf(hudText[6], sizeof(hudText[6]), "score %d", world.score);
+			}
+
+			const float scale = 2.0f, line = HudOverlay::CELL_HEIGHT * scale, graphWidth = 480.0f, graphHeight = 60.0f;
+			const glm::vec4 white(1.0f), green(0.3f, 1.0f, 0.3f, 0.9f), yellow(1.0f, 0.85f, 0.2f, 0.9f), cyan(0.3f, 0.8f, 1.0f, 0.9f), magenta(1.0f, 0.4f, 1.0f, 0.9f),
+				red(1.0f, 0.45f, 0.35f, 0.9f);
+			float x = 16.0f, y = 16.0f;
+			hud.Begin(framebufferWidth, framebufferHeight);
+			hud.Rect(x - 8.0f, y - 8.0f, 1000.0f, HUD_LINES * line + 4 * (graphHeight + 8.0f) + 16.0f, glm::vec4(0.0f, 0.0f, 0.0f, 0.45f));
+			// frame (green) and its CPU part (yellow) against a 33 ms scale, the line is 60 FPS
+			hud.Text(x, y, hudText[0], green, scale);
+			hud.Text(x, y + line, hudText[1], yellow, scale);
+			y += 2 * line;
+			hud.Graph(x, y, graphWidth, graphHeight, frameHistory, 33.3f, green, 16.7f);
+			hud.Graph(x, y, graphWidth, graphHeight, cpuHistory, 33.3f, yellow);
+			y += graphHeight + 8.0f;
+			// GPU time of the whole frame and of its passes
+			hud.Text(x, y, hudText[7], red, scale);
+			hud.Text(x, y + line, hudText[8], red, scale);
+			hud.Text(x, y + 2 * line, hudText[9], red, scale);
+			y += 3 * line;
+			hud.Graph(x, y, graphWidth, graphHeight, gpuHistory, 33.3f, red, 16.7f);
+			y += graphHeight + 8.0f;
+			hud.Text(x, y, hudText[2], cyan, scale);
+			y += line;
+			hud.Graph(x, y, graphWidth, graphHeight, tickHistory, 4.0f, cyan, Simulation::TICK_DT * 1000.0f);
+			y += graphHeight + 8.0f;
+			hud.Text(x, y, hudText[3], white, scale);
+			hud.Text(x, y + line, hudText[10], white, scale);
+			hud.Text(x, y + 2 * line, hudText[4], magenta, scale);
+			hud.Text(x, y + 3 * line, hudText[5], magenta, scale);
+			y += 4 * line;
+			hud.Graph(x, y, graphWidth, graphHeight, latencyHistory, 100.0f, magenta, 50.0f);
+			y += graphHeight + 8.0f;
+			hud.Text(x, y, hudText[6], white, scale);
+			hud.End();
+		}
+		gpuTimer.EndFrame();
+		float cpuMs = (float)((NowSeconds() - frameStart) * 1000.0);
+		cpuHistory.Add(cpuMs);
+
 		// check and call events and swap the buffers
-		glfwSwapBuffers(window);
+		{
+			TRACE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
 		glfwPollEvents();
+
+		double frameEnd = NowSeconds();
+		frameStats.AddSample((frameEnd - frameStart) * 1000.0, frameEnd);
+		frameHistory.Add((float)((frameEnd - frameStart) * 1000.0));
+
+		if (benchmark) {
+			bench.Record(frameIndex, cpuMs, (float)((frameEnd - frameStart) * 1000.0), rendered.draw_calls, rendered.triangles);
+			// a few frames past the last one, their GPU times come in late
+			if (bench.Done(frameIndex + 1, GpuTimer::RING)) {
+				benchmarkCompleted = true;
+				glfwSetWindowShouldClose(window, true);
+			}
+		}
+		frameIndex++;
 	}
 	GameEnd = true;
-	DetectionThread.join();
+	SimulationThread.join();
+	if (finalState == GAME_OVER_BOMB)
+		std::cout << "Boom, to byla bomba... Finalni skore: " << finalScore << std::endl;
+	else if (finalState != GAME_RUNNING)
+		std::cout << "Boom, havaroval jsi... Finalni skore: " << finalScore << std::endl;
+	tracking.Stop();
+	// raw tracking samples of the recorded session, for measuring the prediction offline (ICPBench prediction)
+	if (!trackingSamples.empty() && SaveTrackingSamples(recordPath + ".tracking", trackingSamples))
+		std::cout << "Tracking samples saved into " << recordPath << ".tracking" << std::endl;
+	// --trace: the whole session (as much of it as the rings still hold)
+	if (!tracePath.empty() && TraceEnabled())
+		writeTrace();
+	if (benchmark)
+		return bench.Finish(benchmarkCsv, benchmarkCompleted);
 	return 0;
 
 
 }
 
 
+// CPU trace of all threads, into --trace or trace.json
+void GameApp::writeTrace()
+{
+	std::string path = tracePath.empty() ? "trace.json" : tracePath;
+	if (TraceWrite(path))
+		std::cout << "Trace saved into " << path << " (chrome://tracing, ui.perfetto.dev)" << std::endl;
+	else
+		std::cerr << "Trace: can't write " << path << std::endl;
+}
+
+
+// game tick loop (simulation thread)
+// fixed step: the accumulator collects elapsed time and runs as many TICK_DT ticks as it covers,
+// then the newest state is published together with the previous one for render interpolation
+void GameApp::SimulationLoop(void)
+{
+	TraceThreadName("simulation");
+	TimingStats tickStats;
+	TimingStats collisionStats;
+	unsigned long long ticksDropped = 0;
+	float lastTickMs = 0.0f;
+	double accumulator = 0.0;
+	double previousTime = NowSeconds();
+	bool replaying = !replayPath.empty();
+	bool replayFinished = false;
+
+	while (!GameEnd)
+	{
+		double now = NowSeconds();
+		accumulator += now - previousTime;
+		previousTime = now;
+
+		int ticks = 0;
+		while (accumulator >= Simulation::TICK_DT && ticks < Simulation::MAX_CATCHUP_TICKS && !replayFinished)
+		{
+			TRACE_SCOPE("tick");
+			double tickStart = NowSeconds();
+
+			inputs.Acquire();
+			const InputState& input = replaying ? player.InputFor(simulation.tick) : inputs.ReadBuffer();
+			recorder.Record(simulation.tick, input);
+			simulation.Tick(input, Simulation::TICK_DT);
+			accumulator -= Simulation::TICK_DT;
+			ticks++;
+
+			double tickEnd = NowSeconds();
+			lastTickMs = (float)((tickEnd - tickStart) * 1000.0);
+			tickStats.AddSample((tickEnd - tickStart) * 1000.0, tickEnd);
+			collisionStats.AddSample(simulation.collision_seconds * 1000.0, tickEnd);
+
+			if (replaying && player.Finished(simulation.tick)) {
+				replayFinished = true;
+				if (!player.Verifiable())
+					std::cout << "Replay finished (no state hash to verify against)" << std::endl;
+				else if (simulation.StateHash() == player.ExpectedHash())
+					std::cout << "Replay finished: bit-exact" << std::endl;
+				else
+					std::cout << "Replay finished: DIVERGED from the recording" << std::endl;
+			}
+		}
+		// stalled for longer than the catch-up cap (debugger, window drag...) - drop the rest instead of spiralling
+		if (accumulator >= Simulation::TICK_DT) {
+			ticksDropped += (unsigned long long)(accumulator / Simulation::TICK_DT);
+			accumulator = std::fmod(accumulator, (double)Simulation::TICK_DT);
+		}
+
+		if (ticks > 0) {
+			WorldSnapshot& snapshot = snapshots.WriteBuffer();
+			simulation.WriteSnapshot(snapshot);
+			snapshot.tick_time = NowSeconds();
+			snapshot.state_time = now - accumulator;
+			snapshot.ticks_per_second = tickStats.rate;
+			snapshot.tick_ms = lastTickMs;
+			snapshot.ticks_dropped = ticksDropped;
+			snapshot.collision_ms_avg = collisionStats.avg_ms;
+			snapshot.replay_finished = replayFinished;
+			snapshots.Publish();
+		}
+
+		// sleep until the next tick is due
+		SleepUntil(previousTime + (Simulation::TICK_DT - accumulator));
+	}
+
+	recorder.Close(simulation.tick, simulation.StateHash());
+}
+
 //destructor
 GameApp::~GameApp() {
 
@@ -790,40 +908,45 @@ void GameApp::processInput(GLFWwindow* window)
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
 
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-		camera.ProcessKeyboard(FORWARD, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-		camera.ProcessKeyboard(BACKWARD, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-		camera.ProcessKeyboard(LEFT, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-		camera.ProcessKeyboard(RIGHT, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
-		plane.ProcessKeyboard(P_FORWARD, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
-		plane.ProcessKeyboard(P_BACKWARD, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
-		plane.ProcessKeyboard(P_LEFT, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
-		plane.ProcessKeyboard(P_RIGHT, deltaTime);
+	// camera and plane movement is applied by the simulation every tick
+	input.camera_forward = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS;
+	input.camera_backward = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS;
+	input.camera_left = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
+	input.camera_right = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
+	input.plane_up = glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS;
+	input.plane_down = glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS;
+	input.plane_left = glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS;
+	input.plane_right = glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS;
 	if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
-		activeView = 0;
+		input.activeView = 0;
 	if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
-		activeView = 1;
+		input.activeView = 1;
 	if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
-		activeView = 2;
+		input.activeView = 2;
 	if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS)
 		glfwSetWindowMonitor(window, glfwGetPrimaryMonitor(), 0, 0, 1920, 1080,60);
 	if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS)
 		glfwSetWindowMonitor(window, nullptr, 100, 100, 1024, 576, 60);
 	if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS)
-		controllMode = 1;
+		input.controllMode = 1;
 	if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS)
-		controllMode = 0;
+		input.controllMode = 0;
 	if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
-		GameFreeze = true;
+		input.GameFreeze = true;
 	if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS)
-		GameFreeze = false;
+		input.GameFreeze = false;
+	// H: performance HUD on / off (on the press, not while held)
+	bool hudKey = glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS;
+	if (hudKey && !hudKeyDown)
+		showHud = !showHud;
+	hudKeyDown = hudKey;
+	// J/K: start tracing / stop it and write the trace
+	if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS)
+		TraceEnable(true);
+	if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS && TraceEnabled()) {
+		TraceEnable(false);
+		writeTrace();
+	}
 
 }
 
@@ -848,7 +971,7 @@ void GameApp::mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
 
 		gameApp->lastX = xpos;
 		gameApp->lastY = ypos;
-		gameApp->camera.ProcessMouseMovement(xoffset, yoffset);
+		gameApp->input.mouse_total += glm::vec2(xoffset, yoffset);
 		//gameApp->plane.ProcessMouseMovement(xoffset, yoffset);
 
 	}
@@ -863,6 +986,6 @@ void GameApp::scroll_callback(GLFWwindow* window, double xoffset, double yoffset
 
 	// Call the class-specific function
 	if (gameApp)
-		gameApp->camera.ProcessMouseScroll(static_cast<float>(yoffset));
+		gameApp->input.scroll_total += static_cast<float>(yoffset);
 
 }
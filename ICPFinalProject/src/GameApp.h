@@ -6,18 +6,22 @@
 #include <glm/ext.hpp>
 
 #include <opencv2\opencv.hpp>
+#include <string>
 
 #include "Camera.h"
 #include "Plane.h"
+#include "GameState.h"
+#include "Simulation.h"
+#include "TriangleBVH.h"
+#include "TripleBuffer.h"
+#include "InputRecording.h"
+#include "TrackingPipeline.h"
+#include "TrackingPredictor.h"
+#include "Benchmark.h"
 
 class GameApp {
 
 public:
-	cv::Point2f find_center_normalized_hsv(cv::Mat& frame);
-	void draw_cross_normalized(cv::Mat& img, cv::Point2f center_relative, int size);
-
-
-	cv::Point2f centre;
 	// settings
 	const unsigned int SCR_WIDTH = 1920;
 	const unsigned int SCR_HEIGHT = 1080;
@@ -25,18 +29,43 @@ public:
 	// timing
 	float deltaTime = 0.0f;	// Time between current frame and last frame
 	float lastFrame = 0.0f; // Time of last frame
-	int score = 0;
-	int activeView = 1;
-	int controllMode = 0; //0=arrows,1=tracking
-	bool GameFreeze = false;
-	// camera
+	int swapInterval = 0; //Vsync 0-off 1-on
+	// camera (the camera itself is part of the simulation, the window only feeds it mouse offsets)
 	float lastX = SCR_WIDTH / 2.0f;
 	float lastY = SCR_HEIGHT / 2.0f;
 	bool firstMouse = true;
-	Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, 0.0f);
+	// performance HUD
+	bool showHud = true;
+	bool hudKeyDown = false;
+
+	// record / replay (set from the command line before run_game)
+	std::string recordPath; // record the session into this file
+	std::string replayPath; // replay this recording instead of live input
+	bool hasSeed = false;
+	unsigned int seed = 0; // simulation seed, random when not given
+	std::string gpuCsvPath; // GPU pass timings of every measured frame into this CSV
+	std::string tracePath; // CPU trace from the start, written on exit (J/K trace on demand without it)
+	// --benchmark: scripted flythrough, per-frame times into benchmarkCsv, run_game() returns the exit code
+	bool benchmark = false;
+	Benchmark bench;
+	std::string benchmarkCsv = "benchmark.csv";
+
+	// level collision geometry (read-only once loaded) and the game logic, owned by the simulation thread once the game loop starts
+	TriangleBVH terrain;
+	Simulation simulation = Simulation(0);
 
-	// plane(position/front/yaw/pitch)
-	Plane plane = Plane(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, 0.0f);
+	// simulation -> render (world state) and render -> simulation (inputs)
+	TripleBuffer<WorldSnapshot> snapshots;
+	TripleBuffer<InputState> inputs;
+	InputState input; // filled by processInput on the render thread
+	InputRecorder recorder;
+	InputPlayer player;
+	// camera -> hand position, on its own threads
+	TrackingPipeline tracking;
+	CaptureSettings captureSettings; // camera mode / file / synthetic, from the command line
+	TrackingPredictor trackingPredictor; // render thread side, latency compensation
+	std::vector<TrackingSample> trackingSamples; // raw samples while recording
+	uint64_t lastTrackedFrame = 0;
 
 
 	GameApp();
@@ -51,9 +80,9 @@ public:
 private:
 	GLFWwindow* game_init_window();
 	void processInput(GLFWwindow* window);
-	void ObjectDetection(void);
+	void SimulationLoop(void);
 	void init_opencv();
-	cv::VideoCapture capture;
+	void writeTrace();
 	std::atomic<bool> GameEnd = false;
 
 };
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <vector>
+
+// world object counts at the start of a session (they live in EntityPools, so these are no hard limits)
+const int NUM_COINS = 9;
+const int NUM_FLAMES = 100;
+// bombs keep spawning with the score up to this many
+const int MAX_BOMBS = 99;
+
+enum Game_Over {
+    GAME_RUNNING,
+    GAME_OVER_BOMB,
+    GAME_OVER_GROUND
+};
+
+// what the simulation needs from the window/tracking inputs, sampled by the render thread
+// (this is also exactly what gets recorded for a replay)
+struct InputState {
+    bool plane_up = false;
+    bool plane_down = false;
+    bool plane_left = false;
+    bool plane_right = false;
+    bool camera_forward = false;
+    bool camera_backward = false;
+    bool camera_left = false;
+    bool camera_right = false;
+    int controllMode = 0; //0=arrows,1=tracking
+    bool GameFreeze = false;
+    int activeView = 1;
+    // mouse offsets and scroll summed since the start, so no movement is lost when the
+    // render thread publishes more often than the simulation ticks
+    glm::vec2 mouse_total = glm::vec2(0.0f, 0.0f);
+    float scroll_total = 0.0f;
+    glm::vec2 tracking = glm::vec2(0.5f, 0.5f); // normalized centroid of the tracked marker
+};
+
+// free camera as seen by the renderer
+struct CameraState {
+    glm::vec3 Position;
+    glm::vec3 Front;
+    glm::vec3 Up;
+    float Zoom;
+
+    glm::mat4 GetViewMatrix() const { return glm::lookAt(Position, Position + Front, Up); }
+};
+
+// plane orientation as seen by the renderer
+struct PlaneState {
+    glm::vec3 Position;
+    glm::vec3 Front;
+    glm::vec3 Up;
+    glm::vec3 Right;
+    float Yaw;
+    float Pitch;
+
+    glm::mat4 GetViewMatrix() const { return glm::lookAt(Position, Position + Front, Up); }
+};
+
+// angle lerp in degrees along the shorter way around
+inline float LerpAngle(float a, float b, float alpha)
+{
+    float diff = b - a;
+    if (diff > 180.0f) diff -= 360.0f;
+    if (diff < -180.0f) diff += 360.0f;
+    return a + diff * alpha;
+}
+
+// plane state between two ticks, alpha 0 = a, 1 = b
+inline PlaneState Interpolate(const PlaneState& a, const PlaneState& b, float alpha)
+{
+    PlaneState state;
+    state.Position = glm::mix(a.Position, b.Position, alpha);
+    state.Front = glm::normalize(glm::mix(a.Front, b.Front, alpha));
+    state.Up = glm::normalize(glm::mix(a.Up, b.Up, alpha));
+    state.Right = glm::normalize(glm::mix(a.Right, b.Right, alpha));
+    state.Yaw = LerpAngle(a.Yaw, b.Yaw, alpha);
+    state.Pitch = glm::mix(a.Pitch, b.Pitch, alpha);
+    return state;
+}
+
+/*
+	Immutable copy of everything the renderer draws, produced once per game tick.
+	Written by the simulation thread, read by the render thread through a TripleBuffer.
+*/
+struct WorldSnapshot {
+    unsigned long long tick = 0;
+    double tick_time = 0.0; // NowSeconds() when the tick finished
+    // NowSeconds() the current state belongs to on the fixed-step timeline (tick_time minus the unsimulated remainder)
+    double state_time = 0.0;
+
+    // state after the last tick and before it, the renderer blends them
+    PlaneState plane;
+    PlaneState previous_plane;
+    float rotor_angle = 0.0f;
+    float previous_rotor_angle = 0.0f;
+    float coin_angle = 0.0f; // shared spin of all coins
+    float previous_coin_angle = 0.0f;
+
+    CameraState camera;
+    glm::vec3 previous_camera_position;
+    int activeView = 1;
+
+    // one entry per entity, the buffers are reused so steady state copies don't allocate
+    std::vector<glm::vec3> coin_positions;
+    std::vector<float> coin_angles; // per coin offset of the spin
+    std::vector<char> coin_visible;
+
+    std::vector<glm::vec3> bombs;
+
+    std::vector<glm::vec3> flame_offsets; // in plane model space (before the 0.01 scale)
+
+    int score = 0;
+    Game_Over game_over = GAME_RUNNING;
+    bool replay_finished = false; // all ticks of the replayed recording are done
+
+    // simulation thread timing (last one second window)
+    float ticks_per_second = 0.0f;
+    float tick_ms = 0.0f; // the newest tick alone (HUD graph)
+    unsigned long long ticks_dropped = 0; // lost to the catch-up cap since start
+    float collision_ms_avg = 0.0f; // collision part of a tick (HUD tick line)
+};
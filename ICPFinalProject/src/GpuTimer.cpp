@@ -0,0 +1,101 @@
+#include <algorithm>
+
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer(int passCount)
+    : pass_count(std::min(passCount, MAX_PASSES))
+{
+    for (Slot& slot : ring) {
+        glGenQueries(pass_count, slot.passes);
+        glGenQueries(1, &slot.frame_begin);
+        glGenQueries(1, &slot.frame_end);
+        slot.in_flight = false;
+        slot.frame = 0;
+    }
+}
+
+GpuTimer::~GpuTimer()
+{
+    for (Slot& slot : ring) {
+        glDeleteQueries(pass_count, slot.passes);
+        glDeleteQueries(1, &slot.frame_begin);
+        glDeleteQueries(1, &slot.frame_end);
+    }
+}
+
+// reads the slot if the GPU got through it, never waits
+bool GpuTimer::resolve(Slot& slot)
+{
+    // queries finish in order, the frame's last one being done means all of them are
+    GLint available = 0;
+    glGetQueryObjectiv(slot.frame_end, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return false;
+
+    for (int i = 0; i < pass_count; i++) {
+        GLuint64 ns = 0;
+        if (slot.issued[i])
+            glGetQueryObjectui64v(slot.passes[i], GL_QUERY_RESULT, &ns);
+        pass_ms[i] = (float)(ns / 1.0e6);
+    }
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(slot.frame_begin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(slot.frame_end, GL_QUERY_RESULT, &end);
+    frame_ms = (float)((end - begin) / 1.0e6);
+    resolved_frame = slot.frame;
+    slot.in_flight = false;
+    return true;
+}
+
+bool GpuTimer::Resolve()
+{
+    // the GPU finishes frames in order, when the oldest one isn't done nothing newer is
+    Slot* oldest = nullptr;
+    for (Slot& slot : ring) {
+        if (slot.in_flight && (!oldest || slot.frame < oldest->frame))
+            oldest = &slot;
+    }
+    return oldest && resolve(*oldest);
+}
+
+void GpuTimer::BeginFrame()
+{
+    frames++;
+    Slot& slot = ring[frames % RING];
+    if (slot.in_flight) {
+        current = nullptr;
+        unmeasured++;
+        return;
+    }
+    current = &slot;
+    current->frame = frames;
+    std::fill(current->issued, current->issued + MAX_PASSES, false);
+    glQueryCounter(current->frame_begin, GL_TIMESTAMP);
+}
+
+void GpuTimer::Begin(int pass)
+{
+    if (!current || pass < 0 || pass >= pass_count || open_pass >= 0)
+        return;
+    glBeginQuery(GL_TIME_ELAPSED, current->passes[pass]);
+    current->issued[pass] = true;
+    open_pass = pass;
+}
+
+void GpuTimer::End()
+{
+    if (open_pass < 0)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    open_pass = -1;
+}
+
+void GpuTimer::EndFrame()
+{
+    End();
+    if (!current)
+        return;
+    glQueryCounter(current->frame_end, GL_TIMESTAMP);
+    current->in_flight = true;
+    current = nullptr;
+}
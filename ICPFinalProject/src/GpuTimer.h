@@ -0,0 +1,69 @@
+#pragma once
+
+#include <GL/glew.h> // GLEW provides efficient run-time mechanisms for determining which OpenGL extensions are supported on the target platform.
+#include <cstdint>
+
+/*
+	GPU time of the render passes of one frame, from OpenGL timer queries (core since 3.3).
+
+	- every pass is a GL_TIME_ELAPSED query between Begin(pass) and End(); passes can't nest
+	  (one elapsed query at a time), a pass not drawn in a frame reads 0
+	- two GL_TIMESTAMP queries bracket the whole frame (GPU frame time, including the gaps
+	  between the passes)
+	- the queries of a frame live in one slot of a ring of RING frames; Resolve() reads the
+	  slots back oldest first once their last query is available, usually a frame or two
+	  later (Latency()), so the CPU never waits for the GPU. A frame whose slot is still in
+	  flight from RING frames before is simply not measured
+*/
+class GpuTimer {
+
+public:
+    static const int MAX_PASSES = 16;
+    static const int RING = 4;
+
+    // needs a current OpenGL context
+    explicit GpuTimer(int passCount);
+    ~GpuTimer();
+
+    // reads back the oldest frame the GPU got through, false when there's none; call it until
+    // false before BeginFrame(), every true is one more frame's results, in frame order
+    bool Resolve();
+    // once per frame before the first pass
+    void BeginFrame();
+    void Begin(int pass);
+    void End();
+    // after the last pass (before the buffer swap)
+    void EndFrame();
+
+    // the results Resolve() read last
+    float PassMs(int pass) const { return pass_ms[pass]; }
+    float FrameMs() const { return frame_ms; }
+    // BeginFrame() count of the frame the results belong to, and how many frames old they are
+    uint64_t ResolvedFrame() const { return resolved_frame; }
+    uint64_t Latency() const { return frames - resolved_frame; }
+    // frames skipped because the ring slot was still in flight
+    uint64_t Unmeasured() const { return unmeasured; }
+
+private:
+    struct Slot {
+        unsigned int passes[MAX_PASSES];
+        unsigned int frame_begin, frame_end;
+        bool issued[MAX_PASSES];
+        bool in_flight;
+        uint64_t frame;
+    };
+
+    int pass_count;
+    Slot ring[RING];
+    Slot* current = nullptr; // slot of the frame being drawn, nullptr = not measured
+    int open_pass = -1;
+    uint64_t frames = 0;
+
+    float pass_ms[MAX_PASSES] = {};
+    float frame_ms = 0.0f;
+    uint64_t resolved_frame = 0;
+    uint64_t unmeasured = 0;
+
+    bool resolve(Slot& slot);
+
+};
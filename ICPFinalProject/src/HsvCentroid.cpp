@@ -0,0 +1,371 @@
+#include "HsvCentroid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HSV_CENTROID_X86 1
+#include <immintrin.h>
+#else
+#define HSV_CENTROID_X86 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)
+#endif
+
+// OpenCV's fixed point BGR -> HSV (color_hsv.simd.hpp): divisions by v and by v - min are table lookups
+static const int HSV_SHIFT = 12;
+static const int HSV_ROUND = 1 << (HSV_SHIFT - 1);
+
+struct HsvTables {
+    int sdiv[256]; // (255 << 12) / v
+    int hdiv[256]; // (180 << 12) / (6 * diff)
+
+    HsvTables()
+    {
+        sdiv[0] = hdiv[0] = 0;
+        for (int i = 1; i < 256; i++) {
+            // nearbyint rounds half to even like OpenCV's saturate_cast<int>(double)
+            sdiv[i] = (int)std::nearbyint((255 << HSV_SHIFT) / (1.0 * i));
+            hdiv[i] = (int)std::nearbyint((180 << HSV_SHIFT) / (6.0 * i));
+        }
+    }
+};
+
+static const HsvTables& tables()
+{
+    static const HsvTables t;
+    return t;
+}
+
+static inline void pixelHsv(int b, int g, int r, const HsvTables& t, int& h, int& s, int& v)
+{
+    v = std::max(std::max(b, g), r);
+    int diff = v - std::min(std::min(b, g), r);
+    int vr = v == r ? -1 : 0;
+    int vg = v == g ? -1 : 0;
+
+    s = (diff * t.sdiv[v] + HSV_ROUND) >> HSV_SHIFT;
+    h = (vr & (g - b)) + (~vr & ((vg & (b - r + 2 * diff)) + (~vg & (r - g + 4 * diff))));
+    h = (h * t.hdiv[diff] + HSV_ROUND) >> HSV_SHIFT;
+    h += h < 0 ? 180 : 0;
+}
+
+static inline bool pixelInside(const uint8_t* p, const HsvRange& range, const HsvTables& t)
+{
+    int h, s, v;
+    pixelHsv(p[0], p[1], p[2], t, h, s, v);
+    return h >= range.low[0] && h <= range.high[0]
+        && s >= range.low[1] && s <= range.high[1]
+        && v >= range.low[2] && v <= range.high[2];
+}
+
+void BgrToHsv(uint8_t b, uint8_t g, uint8_t r, uint8_t hsv[3])
+{
+    int h, s, v;
+    pixelHsv(b, g, r, tables(), h, s, v);
+    hsv[0] = (uint8_t)h;
+    hsv[1] = (uint8_t)s;
+    hsv[2] = (uint8_t)v;
+}
+
+bool HsvInside(uint8_t b, uint8_t g, uint8_t r, const HsvRange& range)
+{
+    uint8_t p[3] = { b, g, r };
+    return pixelInside(p, range, tables());
+}
+
+// pixels [x, width) of one row, adds the matches to count / sum_x
+static inline void scalarPixels(const uint8_t* row, int x, int width, const HsvRange& range, const HsvTables& t,
+    uint64_t& count, uint64_t& sum_x)
+{
+    for (; x < width; x++) {
+        if (pixelInside(row + x * 3, range, t)) {
+            count++;
+            sum_x += x;
+        }
+    }
+}
+
+typedef void (*HsvKernelFn)(const uint8_t* bgr, int width, size_t stride, int rowBegin, int rowEnd,
+    const HsvRange& range, HsvMoments& moments);
+
+static void scalarKernel(const uint8_t* bgr, int width, size_t stride, int rowBegin, int rowEnd,
+    const HsvRange& range, HsvMoments& moments)
+{
+    const HsvTables& t = tables();
+    for (int y = rowBegin; y < rowEnd; y++) {
+        uint64_t count = 0, sum_x = 0;
+        scalarPixels(bgr + y * stride, 0, width, range, t, count, sum_x);
+        moments.count += count;
+        moments.sum_x += sum_x;
+        moments.sum_y += count * (uint64_t)y;
+    }
+}
+
+#if HSV_CENTROID_X86
+
+// 8 pixels (32 bit lanes) of the 16 deinterleaved ones, returns -1 in the lanes inside the range
+SIMD_TARGET("avx2")
+static inline __m256i avx2Inside(__m128i b8, __m128i g8, __m128i r8, __m128i v8, __m128i d8, __m128i vr8, __m128i vg8,
+    const HsvTables& t, const __m256i* low, const __m256i* high)
+{
+    __m256i b = _mm256_cvtepu8_epi32(b8);
+    __m256i g = _mm256_cvtepu8_epi32(g8);
+    __m256i r = _mm256_cvtepu8_epi32(r8);
+    __m256i v = _mm256_cvtepu8_epi32(v8);
+    __m256i diff = _mm256_cvtepu8_epi32(d8);
+    __m256i vr = _mm256_cvtepi8_epi32(vr8);
+    __m256i vg = _mm256_cvtepi8_epi32(vg8);
+    __m256i round = _mm256_set1_epi32(HSV_ROUND);
+
+    __m256i s = _mm256_mullo_epi32(diff, _mm256_i32gather_epi32(t.sdiv, v, 4));
+    s = _mm256_srai_epi32(_mm256_add_epi32(s, round), HSV_SHIFT);
+
+    __m256i hr = _mm256_sub_epi32(g, b);
+    __m256i hg = _mm256_add_epi32(_mm256_sub_epi32(b, r), _mm256_add_epi32(diff, diff));
+    __m256i hb = _mm256_add_epi32(_mm256_sub_epi32(r, g), _mm256_slli_epi32(diff, 2));
+    __m256i h = _mm256_blendv_epi8(_mm256_blendv_epi8(hb, hg, vg), hr, vr);
+    h = _mm256_mullo_epi32(h, _mm256_i32gather_epi32(t.hdiv, diff, 4));
+    h = _mm256_srai_epi32(_mm256_add_epi32(h, round), HSV_SHIFT);
+    h = _mm256_add_epi32(h, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), h), _mm256_set1_epi32(180)));
+
+    // low <= x <= high  ==  !(low > x) && !(x > high)
+    __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(low[0], h), _mm256_cmpgt_epi32(h, high[0]));
+    outside = _mm256_or_si256(outside, _mm256_or_si256(_mm256_cmpgt_epi32(low[1], s), _mm256_cmpgt_epi32(s, high[1])));
+    outside = _mm256_or_si256(outside, _mm256_or_si256(_mm256_cmpgt_epi32(low[2], v), _mm256_cmpgt_epi32(v, high[2])));
+    return _mm256_andnot_si256(outside, _mm256_set1_epi32(-1));
+}
+
+SIMD_TARGET("avx2")
+static uint64_t avx2Sum(__m256i lanes)
+{
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(sum);
+}
+
+// 16 pixels (48 bytes) per step, split into B, G and R with byte shuffles
+SIMD_TARGET("avx2")
+static void avx2Kernel(const uint8_t* bgr, int width, size_t stride, int rowBegin, int rowEnd,
+    const HsvRange& range, HsvMoments& moments)
+{
+    const HsvTables& t = tables();
+    const __m128i b0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i g0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i g1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i r0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+    __m256i low[3], high[3];
+    for (int c = 0; c < 3; c++) {
+        low[c] = _mm256_set1_epi32(range.low[c]);
+        high[c] = _mm256_set1_epi32(range.high[c]);
+    }
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        const uint8_t* row = bgr + y * stride;
+        // per lane 32 bit sums are enough for one row (x < 2^16)
+        __m256i count = _mm256_setzero_si256();
+        __m256i sum_x = _mm256_setzero_si256();
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            const uint8_t* p = row + x * 3;
+            __m128i a = _mm_loadu_si128((const __m128i*)p);
+            __m128i b = _mm_loadu_si128((const __m128i*)(p + 16));
+            __m128i c = _mm_loadu_si128((const __m128i*)(p + 32));
+            __m128i B = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, b0), _mm_shuffle_epi8(b, b1)), _mm_shuffle_epi8(c, b2));
+            __m128i G = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, g0), _mm_shuffle_epi8(b, g1)), _mm_shuffle_epi8(c, g2));
+            __m128i R = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, r0), _mm_shuffle_epi8(b, r1)), _mm_shuffle_epi8(c, r2));
+
+            __m128i V = _mm_max_epu8(_mm_max_epu8(B, G), R);
+            __m128i D = _mm_subs_epu8(V, _mm_min_epu8(_mm_min_epu8(B, G), R));
+            __m128i VR = _mm_cmpeq_epi8(V, R);
+            __m128i VG = _mm_cmpeq_epi8(V, G);
+
+            for (int half = 0; half < 2; half++) {
+                __m256i inside = avx2Inside(B, G, R, V, D, VR, VG, t, low, high);
+                count = _mm256_sub_epi32(count, inside);
+                sum_x = _mm256_add_epi32(sum_x, _mm256_and_si256(inside, _mm256_add_epi32(lane, _mm256_set1_epi32(x + half * 8))));
+                B = _mm_srli_si128(B, 8);
+                G = _mm_srli_si128(G, 8);
+                R = _mm_srli_si128(R, 8);
+                V = _mm_srli_si128(V, 8);
+                D = _mm_srli_si128(D, 8);
+                VR = _mm_srli_si128(VR, 8);
+                VG = _mm_srli_si128(VG, 8);
+            }
+        }
+
+        uint64_t row_count = avx2Sum(count);
+        uint64_t row_sum_x = avx2Sum(sum_x);
+        scalarPixels(row, x, width, range, t, row_count, row_sum_x);
+        moments.count += row_count;
+        moments.sum_x += row_sum_x;
+        moments.sum_y += row_count * (uint64_t)y;
+    }
+}
+
+#endif
+
+static Simd_Level selectedLevel = SIMD_SCALAR;
+static HsvKernelFn selectedKernel = nullptr;
+
+void SetHsvKernel(Simd_Level level)
+{
+    Simd_Level supported = DetectSimdLevel();
+    if (level > supported)
+        level = supported;
+
+    // the kernel needs gathers: SSE runs the scalar one, AVX-512 the AVX2 one
+    selectedLevel = SIMD_SCALAR;
+    selectedKernel = scalarKernel;
+#if HSV_CENTROID_X86
+    if (level >= SIMD_AVX2) {
+        selectedLevel = SIMD_AVX2;
+        selectedKernel = avx2Kernel;
+    }
+#endif
+}
+
+Simd_Level HsvKernel()
+{
+    if (!selectedKernel)
+        SetHsvKernel(SIMD_AVX512);
+    return selectedLevel;
+}
+
+HsvMoments HsvThresholdMoments(const uint8_t* bgr, int width, size_t stride, int rowBegin, int rowEnd, const HsvRange& range)
+{
+    if (!selectedKernel)
+        SetHsvKernel(SIMD_AVX512);
+
+    HsvMoments moments;
+    selectedKernel(bgr, width, stride, rowBegin, rowEnd, range, moments);
+    return moments;
+}
+
+HsvMoments HsvThresholdMomentsRect(const uint8_t* bgr, size_t stride, int x0, int y0, int x1, int y1, const HsvRange& range)
+{
+    if (!selectedKernel)
+        SetHsvKernel(SIMD_AVX512);
+
+    HsvMoments moments;
+    if (x1 <= x0 || y1 <= y0)
+        return moments;
+    selectedKernel(bgr + x0 * 3, x1 - x0, stride, y0, y1, range, moments);
+    moments.sum_x += moments.count * (uint64_t)x0;
+    return moments;
+}
+
+HsvMoments HsvThresholdMomentsSubsampled(const uint8_t* bgr, int width, int height, size_t stride, int step, const HsvRange& range)
+{
+    // too sparse for the SIMD kernels to pay off, a few thousand pixels
+    const HsvTables& t = tables();
+    HsvMoments moments;
+    for (int y = step / 2; y < height; y += step) {
+        const uint8_t* row = bgr + y * stride;
+        uint64_t count = 0, sum_x = 0;
+        for (int x = step / 2; x < width; x += step) {
+            if (pixelInside(row + x * 3, range, t)) {
+                count++;
+                sum_x += x;
+            }
+        }
+        moments.count += count;
+        moments.sum_x += sum_x;
+        moments.sum_y += count * (uint64_t)y;
+    }
+    return moments;
+}
+
+HsvCentroid::HsvCentroid(int threads)
+{
+    if (threads <= 0) {
+        // leave cores to the render, simulation and chunk threads
+        int cores = (int)std::thread::hardware_concurrency();
+        threads = std::max(1, std::min(4, cores - 3));
+    }
+    tables(); // built here, not on the first frame
+    HsvKernel();
+
+    results.resize(threads - 1);
+    for (int i = 0; i < threads - 1; i++)
+        workers.emplace_back(&HsvCentroid::workerLoop, this, i);
+}
+
+HsvCentroid::~HsvCentroid()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+// part 0 is the caller's, part i + 1 is worker i's
+void HsvCentroid::rows(int part, int& begin, int& end) const
+{
+    int parts = Threads();
+    begin = (int)((long long)job.height * part / parts);
+    end = (int)((long long)job.height * (part + 1) / parts);
+}
+
+HsvMoments HsvCentroid::Run(const uint8_t* bgr, int width, int height, size_t stride, const HsvRange& range)
+{
+    // small frames aren't worth waking anybody
+    if (workers.empty() || (long long)width * height < 64 * 1024)
+        return HsvThresholdMoments(bgr, width, stride, 0, height, range);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = Job{ bgr, width, height, stride, range };
+        pending = (int)workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    int begin, end;
+    rows(0, begin, end);
+    HsvMoments moments = HsvThresholdMoments(bgr, width, stride, begin, end, range);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]() { return pending == 0; });
+    for (const HsvMoments& part : results)
+        moments.Add(part);
+    return moments;
+}
+
+void HsvCentroid::workerLoop(int index)
+{
+    uint64_t done = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&]() { return stopping || generation != done; });
+        if (stopping)
+            return;
+        done = generation;
+        Job current = job;
+        int begin, end;
+        rows(index + 1, begin, end);
+        lock.unlock();
+
+        HsvMoments part = HsvThresholdMoments(current.bgr, current.width, current.stride, begin, end, current.range);
+
+        lock.lock();
+        results[index] = part;
+        if (--pending == 0)
+            finished.notify_one();
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+
+#include "SphereBatch.h" // Simd_Level, DetectSimdLevel
+
+/*
+	Colour tracking in one pass: BGR -> HSV, threshold and the moments of the pixels inside
+	(count, sum of x, sum of y), without any intermediate image.
+
+	- HSV is exactly OpenCV's 8 bit cv::COLOR_BGR2HSV (H 0..180, fixed point tables), so the
+	  thresholds mean the same as with cv::cvtColor + cv::inRange and the results are identical
+	- sums are 64 bit (the old int sums overflow on big frames, 4K has 8.3 M pixels)
+	- kernels: scalar and AVX2 (16 pixels per step, the divisions are table gathers);
+	  SSE has no gather, it runs the scalar kernel, AVX-512 runs AVX2
+	- HsvCentroid splits the rows over a few worker threads that sleep between frames
+*/
+
+// inclusive bounds, H 0..180, S and V 0..255
+struct HsvRange {
+    uint8_t low[3];
+    uint8_t high[3];
+};
+
+struct HsvMoments {
+    uint64_t count = 0;
+    uint64_t sum_x = 0;
+    uint64_t sum_y = 0;
+
+    void Add(const HsvMoments& other)
+    {
+        count += other.count;
+        sum_x += other.sum_x;
+        sum_y += other.sum_y;
+    }
+
+    // centroid relative to the frame (0..1), (0, 0) when no pixel matched (as before)
+    glm::vec2 Normalized(int width, int height) const
+    {
+        if (count == 0)
+            return glm::vec2(0.0f);
+        return glm::vec2((float)((double)sum_x / count / width), (float)((double)sum_y / count / height));
+    }
+};
+
+// kernel used by HsvThresholdMoments, defaults to the best the CPU runs
+void SetHsvKernel(Simd_Level level);
+Simd_Level HsvKernel();
+
+// rows [rowBegin, rowEnd) of a BGR frame (3 bytes per pixel, stride bytes per row), this thread only
+HsvMoments HsvThresholdMoments(const uint8_t* bgr, int width, size_t stride, int rowBegin, int rowEnd, const HsvRange& range);
+
+// pixels [x0, x1) x rows [y0, y1) of a frame, coordinates stay the frame's
+HsvMoments HsvThresholdMomentsRect(const uint8_t* bgr, size_t stride, int x0, int y0, int x1, int y1, const HsvRange& range);
+
+// every step-th pixel of every step-th row (a downscaled frame), in full resolution coordinates,
+// count = sampled pixels inside
+HsvMoments HsvThresholdMomentsSubsampled(const uint8_t* bgr, int width, int height, size_t stride, int step, const HsvRange& range);
+
+// single pixel, reference for the kernels
+bool HsvInside(uint8_t b, uint8_t g, uint8_t r, const HsvRange& range);
+// OpenCV's HSV of one pixel (h, s, v)
+void BgrToHsv(uint8_t b, uint8_t g, uint8_t r, uint8_t hsv[3]);
+
+class HsvCentroid {
+
+public:
+    // threads 0 = pick from the core count (the caller's thread always takes a part)
+    HsvCentroid(int threads = 0);
+    ~HsvCentroid();
+
+    HsvMoments Run(const uint8_t* bgr, int width, int height, size_t stride, const HsvRange& range);
+
+    int Threads() const { return (int)workers.size() + 1; }
+
+private:
+    struct Job {
+        const uint8_t* bgr;
+        int width, height;
+        size_t stride;
+        HsvRange range;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<HsvMoments> results; // one per worker
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    Job job;
+    uint64_t generation = 0; // bumped per frame, workers run once per value
+    int pending = 0;
+    bool stopping = false;
+
+    void workerLoop(int index);
+    void rows(int part, int& begin, int& end) const;
+
+};
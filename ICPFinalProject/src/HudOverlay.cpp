@@ -0,0 +1,184 @@
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "HudOverlay.h"
+
+// 5x7 font for ASCII 32-126, five columns per glyph, bit 0 = top row (bit 7 for descenders)
+static const uint8_t FONT[95][5] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 }, { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, // space ! " #
+    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, { 0x36, 0x49, 0x56, 0x20, 0x50 }, { 0x00, 0x08, 0x07, 0x03, 0x00 }, // $ % & '
+    { 0x00, 0x1C, 0x22, 0x41, 0x00 }, { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A }, { 0x08, 0x08, 0x3E, 0x08, 0x08 }, // ( ) * +
+    { 0x00, 0x80, 0x70, 0x30, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x00, 0x60, 0x60, 0x00 }, { 0x20, 0x10, 0x08, 0x04, 0x02 }, // , - . /
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, { 0x72, 0x49, 0x49, 0x49, 0x46 }, { 0x21, 0x41, 0x49, 0x4D, 0x33 }, // 0 1 2 3
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x31 }, { 0x41, 0x21, 0x11, 0x09, 0x07 }, // 4 5 6 7
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x46, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x00, 0x14, 0x00, 0x00 }, { 0x00, 0x40, 0x34, 0x00, 0x00 }, // 8 9 : ;
+    { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x59, 0x09, 0x06 }, // < = > ?
+    { 0x3E, 0x41, 0x5D, 0x59, 0x4E }, { 0x7C, 0x12, 0x11, 0x12, 0x7C }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 }, // @ A B C
+    { 0x7F, 0x41, 0x41, 0x41, 0x3E }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x09, 0x01 }, { 0x3E, 0x41, 0x41, 0x51, 0x73 }, // D E F G
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, // H I J K
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 }, { 0x7F, 0x02, 0x1C, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E }, // L M N O
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 }, { 0x26, 0x49, 0x49, 0x49, 0x32 }, // P Q R S
+    { 0x03, 0x01, 0x7F, 0x01, 0x03 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, // T U V W
+    { 0x63, 0x14, 0x08, 0x14, 0x63 }, { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x59, 0x49, 0x4D, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x41 }, // X Y Z [
+    { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x41, 0x7F }, { 0x04, 0x02, 0x01, 0x02, 0x04 }, { 0x40, 0x40, 0x40, 0x40, 0x40 }, // \ ] ^ _
+    { 0x00, 0x03, 0x07, 0x08, 0x00 }, { 0x20, 0x54, 0x54, 0x78, 0x40 }, { 0x7F, 0x28, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x28 }, // ` a b c
+    { 0x38, 0x44, 0x44, 0x28, 0x7F }, { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x00, 0x08, 0x7E, 0x09, 0x02 }, { 0x18, 0xA4, 0xA4, 0x9C, 0x78 }, // d e f g
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x40, 0x3D, 0x00 }, { 0x7F, 0x10, 0x28, 0x44, 0x00 }, // h i j k
+    { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x78, 0x04, 0x78 }, { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, // l m n o
+    { 0xFC, 0x18, 0x24, 0x24, 0x18 }, { 0x18, 0x24, 0x24, 0x18, 0xFC }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x24 }, // p q r s
+    { 0x04, 0x04, 0x3F, 0x44, 0x24 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C }, { 0x3C, 0x40, 0x30, 0x40, 0x3C }, // t u v w
+    { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x4C, 0x90, 0x90, 0x90, 0x7C }, { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, // x y z {
+    { 0x00, 0x00, 0x77, 0x00, 0x00 }, { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x02, 0x01, 0x02, 0x04, 0x02 },                                     // | } ~
+};
+
+// atlas: 16 x 6 cells of 6 x 8 texels, characters 32-127, 127 is the solid block
+static const int ATLAS_COLUMNS = 16;
+static const int ATLAS_ROWS = 6;
+static const int GLYPH_TEXELS_X = 6;
+static const int GLYPH_TEXELS_Y = 8;
+static const int ATLAS_WIDTH = ATLAS_COLUMNS * GLYPH_TEXELS_X;
+static const int ATLAS_HEIGHT = ATLAS_ROWS * GLYPH_TEXELS_Y;
+static const char SOLID = 127;
+
+static glm::vec2 cellOrigin(char c)
+{
+    int index = c - 32;
+    return glm::vec2((float)(index % ATLAS_COLUMNS * GLYPH_TEXELS_X) / ATLAS_WIDTH, (float)(index / ATLAS_COLUMNS * GLYPH_TEXELS_Y) / ATLAS_HEIGHT);
+}
+
+HudOverlay::HudOverlay()
+    : shader("resources/shaders/hud.vert", "resources/shaders/hud.frag")
+{
+    buildFont();
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)offsetof(HudVertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)offsetof(HudVertex, uv));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (void*)offsetof(HudVertex, color));
+    glBindVertexArray(0);
+
+    vertices.reserve(16 * 1024);
+}
+
+HudOverlay::~HudOverlay()
+{
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteTextures(1, &fontTexture);
+}
+
+void HudOverlay::buildFont()
+{
+    std::vector<uint8_t> texels(ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+    for (int c = 32; c <= 127; c++) {
+        int index = c - 32;
+        int cx = index % ATLAS_COLUMNS * GLYPH_TEXELS_X;
+        int cy = index / ATLAS_COLUMNS * GLYPH_TEXELS_Y;
+        for (int x = 0; x < GLYPH_TEXELS_X; x++) {
+            for (int y = 0; y < GLYPH_TEXELS_Y; y++) {
+                bool on = c == SOLID || (x < 5 && (FONT[index][x] >> y & 1));
+                texels[(cy + y) * ATLAS_WIDTH + cx + x] = on ? 255 : 0;
+            }
+        }
+    }
+
+    glGenTextures(1, &fontTexture);
+    glBindTexture(GL_TEXTURE_2D, fontTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // crisp pixels at integer scales
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void HudOverlay::Begin(int viewportWidth, int viewportHeight)
+{
+    viewport = glm::vec2((float)std::max(1, viewportWidth), (float)std::max(1, viewportHeight));
+    vertices.clear();
+}
+
+void HudOverlay::quad(float x0, float y0, float x1, float y1, glm::vec2 uv0, glm::vec2 uv1, const glm::vec4& color)
+{
+    HudVertex a = { glm::vec2(x0, y0), uv0, color };
+    HudVertex b = { glm::vec2(x1, y0), glm::vec2(uv1.x, uv0.y), color };
+    HudVertex c = { glm::vec2(x1, y1), uv1, color };
+    HudVertex d = { glm::vec2(x0, y1), glm::vec2(uv0.x, uv1.y), color };
+    vertices.push_back(a);
+    vertices.push_back(b);
+    vertices.push_back(c);
+    vertices.push_back(a);
+    vertices.push_back(c);
+    vertices.push_back(d);
+}
+
+void HudOverlay::Rect(float x, float y, float width, float height, const glm::vec4& color)
+{
+    // middle of the solid glyph, every texel of it is covered
+    glm::vec2 solid = cellOrigin(SOLID) + glm::vec2(3.0f / ATLAS_WIDTH, 4.0f / ATLAS_HEIGHT);
+    quad(x, y, x + width, y + height, solid, solid, color);
+}
+
+void HudOverlay::Text(float x, float y, const char* text, const glm::vec4& color, float scale)
+{
+    glm::vec2 cell((float)GLYPH_TEXELS_X / ATLAS_WIDTH, (float)GLYPH_TEXELS_Y / ATLAS_HEIGHT);
+    for (const char* c = text; *c; c++, x += CELL_WIDTH * scale) {
+        char glyph = (*c < 32 || *c >= SOLID) ? '?' : *c;
+        if (glyph == ' ')
+            continue;
+        glm::vec2 uv = cellOrigin(glyph);
+        quad(x, y, x + GLYPH_TEXELS_X * scale, y + GLYPH_TEXELS_Y * scale, uv, uv + cell, color);
+    }
+}
+
+void HudOverlay::Graph(float x, float y, float width, float height, const MetricHistory& history, float top, const glm::vec4& color, float mark)
+{
+    if (top <= 0.0f)
+        return;
+    float bar = width / MetricHistory::CAPACITY;
+    // newest sample at the right edge
+    float start = x + width - history.Count() * bar;
+    for (int i = 0; i < history.Count(); i++) {
+        float h = std::min(history.At(i) / top, 1.0f) * height;
+        Rect(start + i * bar, y + height - h, bar, h, color);
+    }
+    if (mark > 0.0f && mark < top)
+        Rect(x, y + height - mark / top * height, width, 1.0f, glm::vec4(1.0f, 1.0f, 1.0f, 0.6f));
+}
+
+void HudOverlay::End()
+{
+    if (vertices.empty())
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (vertices.size() > capacity)
+        capacity = vertices.capacity();
+    // fresh storage every frame (orphaning), the GPU may still be drawing last frame's
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(HudVertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(HudVertex), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    shader.use();
+    shader.setVec2("viewport", viewport);
+    shader.setInt("font", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, fontTexture);
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
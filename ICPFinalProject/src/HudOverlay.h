@@ -0,0 +1,60 @@
+#pragma once
+
+#include <GL/glew.h> // GLEW provides efficient run-time mechanisms for determining which OpenGL extensions are supported on the target platform.
+#include <glm/glm.hpp> // ibrary for math operations
+#include <vector>
+
+#include "ShaderProgram.h"
+#include "MetricHistory.h"
+
+/*
+	Screen space text, boxes and graphs over the finished frame (the performance HUD).
+
+	- text uses a built-in 5x7 pixel font (ASCII 32-126) baked into one small texture
+	- everything between Begin() and End() is collected into one vertex array and drawn with
+	  a single draw call, blended over the frame without depth
+	- coordinates are pixels from the top left corner of the viewport
+	- the vertex array is kept between frames, no allocations once it has grown to size
+*/
+class HudOverlay {
+
+public:
+    // font cell in font pixels (glyph + spacing)
+    static const int CELL_WIDTH = 6;
+    static const int CELL_HEIGHT = 9;
+
+    // needs a current OpenGL context
+    HudOverlay();
+    ~HudOverlay();
+
+    void Begin(int viewportWidth, int viewportHeight);
+
+    void Rect(float x, float y, float width, float height, const glm::vec4& color);
+    // one line, scale = screen pixels per font pixel
+    void Text(float x, float y, const char* text, const glm::vec4& color, float scale = 2.0f);
+    // samples as bars, the newest at the right edge, `top` is the value at the graph's top edge (higher ones
+    // are clipped); a line marks `mark` (e.g. the frame budget), none when mark <= 0; no background, graphs
+    // drawn over each other overlap
+    void Graph(float x, float y, float width, float height, const MetricHistory& history, float top, const glm::vec4& color, float mark = 0.0f);
+
+    // draws everything collected since Begin()
+    void End();
+
+private:
+    struct HudVertex {
+        glm::vec2 position;
+        glm::vec2 uv;
+        glm::vec4 color;
+    };
+
+    ShaderProgram shader;
+    unsigned int VAO, VBO;
+    unsigned int fontTexture;
+    size_t capacity = 0; // vertices the VBO holds
+    std::vector<HudVertex> vertices;
+    glm::vec2 viewport = glm::vec2(1.0f);
+
+    void quad(float x0, float y0, float x1, float y1, glm::vec2 uv0, glm::vec2 uv1, const glm::vec4& color);
+    void buildFont();
+
+};
@@ -0,0 +1,196 @@
+#include <iostream>
+#include <cstring>
+
+#include "InputRecording.h"
+
+
+static const char RECORDING_MAGIC[4] = { 'I', 'C', 'P', 'R' };
+static const uint32_t RECORDING_VERSION = 1;
+static const uint32_t END_MARKER = 0xFFFFFFFF;
+
+// key flag bits
+enum {
+    REC_PLANE_UP = 1 << 0,
+    REC_PLANE_DOWN = 1 << 1,
+    REC_PLANE_LEFT = 1 << 2,
+    REC_PLANE_RIGHT = 1 << 3,
+    REC_CAMERA_FORWARD = 1 << 4,
+    REC_CAMERA_BACKWARD = 1 << 5,
+    REC_CAMERA_LEFT = 1 << 6,
+    REC_CAMERA_RIGHT = 1 << 7,
+    REC_TRACKING_MODE = 1 << 8,
+    REC_FREEZE = 1 << 9
+};
+
+static InputRecord packInput(uint32_t tick, const InputState& input)
+{
+    InputRecord record;
+    record.tick = tick;
+    record.flags = 0;
+    if (input.plane_up) record.flags |= REC_PLANE_UP;
+    if (input.plane_down) record.flags |= REC_PLANE_DOWN;
+    if (input.plane_left) record.flags |= REC_PLANE_LEFT;
+    if (input.plane_right) record.flags |= REC_PLANE_RIGHT;
+    if (input.camera_forward) record.flags |= REC_CAMERA_FORWARD;
+    if (input.camera_backward) record.flags |= REC_CAMERA_BACKWARD;
+    if (input.camera_left) record.flags |= REC_CAMERA_LEFT;
+    if (input.camera_right) record.flags |= REC_CAMERA_RIGHT;
+    if (input.controllMode == 1) record.flags |= REC_TRACKING_MODE;
+    if (input.GameFreeze) record.flags |= REC_FREEZE;
+    record.activeView = (uint8_t)input.activeView;
+    record.unused = 0;
+    record.mouse_x = input.mouse_total.x;
+    record.mouse_y = input.mouse_total.y;
+    record.scroll = input.scroll_total;
+    record.tracking_x = input.tracking.x;
+    record.tracking_y = input.tracking.y;
+    return record;
+}
+
+static InputState unpackInput(const InputRecord& record)
+{
+    InputState input;
+    input.plane_up = (record.flags & REC_PLANE_UP) != 0;
+    input.plane_down = (record.flags & REC_PLANE_DOWN) != 0;
+    input.plane_left = (record.flags & REC_PLANE_LEFT) != 0;
+    input.plane_right = (record.flags & REC_PLANE_RIGHT) != 0;
+    input.camera_forward = (record.flags & REC_CAMERA_FORWARD) != 0;
+    input.camera_backward = (record.flags & REC_CAMERA_BACKWARD) != 0;
+    input.camera_left = (record.flags & REC_CAMERA_LEFT) != 0;
+    input.camera_right = (record.flags & REC_CAMERA_RIGHT) != 0;
+    input.controllMode = (record.flags & REC_TRACKING_MODE) != 0 ? 1 : 0;
+    input.GameFreeze = (record.flags & REC_FREEZE) != 0;
+    input.activeView = record.activeView;
+    input.mouse_total = glm::vec2(record.mouse_x, record.mouse_y);
+    input.scroll_total = record.scroll;
+    input.tracking = glm::vec2(record.tracking_x, record.tracking_y);
+    return input;
+}
+
+static bool sameInput(const InputRecord& a, const InputRecord& b)
+{
+    return a.flags == b.flags && a.activeView == b.activeView
+        && std::memcmp(&a.mouse_x, &b.mouse_x, 5 * sizeof(float)) == 0;
+}
+
+template <typename T>
+static void writeValue(std::ofstream& file, const T& value)
+{
+    file.write((const char*)&value, sizeof(T));
+}
+
+template <typename T>
+static bool readValue(std::ifstream& file, T& value)
+{
+    return (bool)file.read((char*)&value, sizeof(T));
+}
+
+
+bool InputRecorder::Open(const std::string& path, unsigned int seed, float tickDt)
+{
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Can't create recording: " << path << std::endl;
+        return false;
+    }
+    file.write(RECORDING_MAGIC, 4);
+    writeValue(file, RECORDING_VERSION);
+    writeValue(file, (uint32_t)seed);
+    writeValue(file, tickDt);
+    has_last = false;
+    return true;
+}
+
+void InputRecorder::Record(unsigned long long tick, const InputState& input)
+{
+    if (!file.is_open())
+        return;
+
+    InputRecord record = packInput((uint32_t)tick, input);
+    if (has_last && sameInput(record, last))
+        return;
+
+    writeValue(file, record.tick);
+    writeValue(file, record.flags);
+    writeValue(file, record.activeView);
+    writeValue(file, record.unused);
+    writeValue(file, record.mouse_x);
+    writeValue(file, record.mouse_y);
+    writeValue(file, record.scroll);
+    writeValue(file, record.tracking_x);
+    writeValue(file, record.tracking_y);
+    last = record;
+    has_last = true;
+}
+
+void InputRecorder::Close(unsigned long long ticks, unsigned long long stateHash)
+{
+    if (!file.is_open())
+        return;
+    writeValue(file, END_MARKER);
+    writeValue(file, (uint64_t)ticks);
+    writeValue(file, (uint64_t)stateHash);
+    file.close();
+}
+
+
+bool InputPlayer::Open(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Can't open recording: " << path << std::endl;
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0, fileSeed = 0;
+    if (!file.read(magic, 4) || std::memcmp(magic, RECORDING_MAGIC, 4) != 0
+        || !readValue(file, version) || version != RECORDING_VERSION
+        || !readValue(file, fileSeed) || !readValue(file, tick_dt)) {
+        std::cerr << "Not a recording (or unsupported version): " << path << std::endl;
+        return false;
+    }
+    seed = fileSeed;
+
+    records.clear();
+    has_end = false;
+    total_ticks = 0;
+    for (;;) {
+        InputRecord record;
+        if (!readValue(file, record.tick))
+            break;
+        if (record.tick == END_MARKER) {
+            uint64_t ticks = 0, hash = 0;
+            readValue(file, ticks);
+            readValue(file, hash);
+            total_ticks = ticks;
+            expected_hash = hash;
+            has_end = true;
+            break;
+        }
+        if (!readValue(file, record.flags) || !readValue(file, record.activeView) || !readValue(file, record.unused)
+            || !readValue(file, record.mouse_x) || !readValue(file, record.mouse_y) || !readValue(file, record.scroll)
+            || !readValue(file, record.tracking_x) || !readValue(file, record.tracking_y))
+            break;
+        records.push_back(record);
+    }
+
+    // cut off without an end marker (crash) - replay what is there, nothing to verify against
+    if (!has_end && !records.empty()) {
+        std::cerr << "Recording has no end marker, replaying without verification" << std::endl;
+        total_ticks = records.back().tick + 1ULL;
+    }
+
+    next_record = 0;
+    current = InputState();
+    return true;
+}
+
+const InputState& InputPlayer::InputFor(unsigned long long tick)
+{
+    while (next_record < records.size() && records[next_record].tick <= tick) {
+        current = unpackInput(records[next_record]);
+        next_record++;
+    }
+    return current;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+#include "GameState.h"
+
+/*
+	Record / replay of a game session.
+
+	A recording is the simulation seed plus the per-tick InputState stream (keyboard, mouse
+	totals, tracking centroid) - everything the simulation consumes. Since the simulation is
+	deterministic, replaying it reproduces the session bit-exactly, in the game or headless.
+
+	File layout (little-endian):
+		header:  "ICPR", u32 version, u32 seed, f32 tick length
+		records: u32 tick, u16 key flags, u8 active view, u8 unused, f32 mouse x/y, f32 scroll, f32 tracking x/y
+		         (a record is written only when the input differs from the previous tick)
+		end:     u32 0xFFFFFFFF, u64 total ticks, u64 final Simulation::StateHash()
+*/
+
+// one tick-stamped input record as stored in the file
+struct InputRecord {
+    uint32_t tick;
+    uint16_t flags;
+    uint8_t activeView;
+    uint8_t unused;
+    float mouse_x, mouse_y;
+    float scroll;
+    float tracking_x, tracking_y;
+};
+
+class InputRecorder {
+
+public:
+    // starts a new recording, returns false when the file can't be created
+    bool Open(const std::string& path, unsigned int seed, float tickDt);
+    bool IsOpen() const { return file.is_open(); }
+
+    // input consumed by the given tick (0 = first tick)
+    void Record(unsigned long long tick, const InputState& input);
+
+    // writes the end marker with the final state hash and closes the file
+    void Close(unsigned long long ticks, unsigned long long stateHash);
+
+private:
+    std::ofstream file;
+    InputRecord last;
+    bool has_last = false;
+
+};
+
+class InputPlayer {
+
+public:
+    // loads the whole recording, returns false when it is missing or malformed
+    bool Open(const std::string& path);
+
+    unsigned int Seed() const { return seed; }
+    float TickDt() const { return tick_dt; }
+    unsigned long long TotalTicks() const { return total_ticks; }
+    unsigned long long ExpectedHash() const { return expected_hash; }
+
+    // recorded input for the given tick, ticks have to be asked for in increasing order
+    const InputState& InputFor(unsigned long long tick);
+
+    // the recording was closed properly and carries a final state hash to verify against
+    bool Verifiable() const { return has_end; }
+
+    // all recorded ticks have been replayed
+    bool Finished(unsigned long long tick) const { return tick >= total_ticks; }
+
+private:
+    std::vector<InputRecord> records;
+    size_t next_record = 0;
+    InputState current;
+    unsigned int seed = 0;
+    float tick_dt = 0.0f;
+    unsigned long long total_ticks = 0;
+    unsigned long long expected_hash = 0;
+    bool has_end = false;
+
+};
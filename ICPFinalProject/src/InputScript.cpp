@@ -0,0 +1,101 @@
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "InputScript.h"
+
+
+InputScript::InputScript(Input_Script type, unsigned int seed)
+    : type(type), random(seed, 1) // stream 1: never the same numbers as the simulation
+{
+}
+
+bool InputScript::FromName(const char* name, Input_Script& type)
+{
+    if (std::strcmp(name, "idle") == 0)
+        type = SCRIPT_IDLE;
+    else if (std::strcmp(name, "random") == 0)
+        type = SCRIPT_RANDOM;
+    else if (std::strcmp(name, "autopilot") == 0)
+        type = SCRIPT_AUTOPILOT;
+    else
+        return false;
+    return true;
+}
+
+InputState InputScript::Next(const Simulation& simulation)
+{
+    if (type == SCRIPT_RANDOM)
+        nextRandom();
+    else if (type == SCRIPT_AUTOPILOT)
+        nextAutopilot(simulation);
+    return input;
+}
+
+void InputScript::nextRandom()
+{
+    if (hold_ticks-- > 0)
+        return;
+
+    // pick a new combination of arrows and hold it for 0.1 - 1 s
+    int k = random.Int(0, 15);
+    input.plane_up = (k & 1) != 0;
+    input.plane_down = (k & 2) != 0 && !input.plane_up;
+    input.plane_left = (k & 4) != 0;
+    input.plane_right = (k & 8) != 0 && !input.plane_left;
+    hold_ticks = random.Int(6, 60);
+}
+
+void InputScript::nextAutopilot(const Simulation& simulation)
+{
+    if (hold_ticks-- > 0)
+        return;
+    hold_ticks = REPLAN_TICKS - 1;
+
+    simulation.WriteSnapshot(view);
+    const PlaneState& plane = view.plane;
+
+    // nearest visible coin (the chunks around the plane always have some), else straight on
+    glm::vec3 target = plane.Position + plane.Front;
+    float best = 1e30f;
+    for (size_t i = 0; i < view.coin_positions.size(); i++) {
+        if (!view.coin_visible[i])
+            continue;
+        glm::vec3 d = view.coin_positions[i] - plane.Position;
+        float distance = glm::dot(d, d);
+        if (distance < best) {
+            best = distance;
+            target = view.coin_positions[i];
+        }
+    }
+
+    glm::vec3 direction = glm::normalize(target - plane.Position);
+    // same angle convention as Plane::updatePlaneVectors
+    float desired_yaw = glm::degrees(std::atan2(direction.x, direction.z));
+    float desired_pitch = glm::degrees(std::asin(glm::clamp(direction.y, -1.0f, 1.0f)));
+    // pull up near the ground or when the level geometry is close ahead / below
+    BVHHit hit;
+    const TriangleBVH* terrain = simulation.Terrain();
+    bool obstacle = terrain && (terrain->Raycast(plane.Position, plane.Front, 2.5f, hit)
+        || terrain->Raycast(plane.Position, glm::vec3(0.0f, -1.0f, 0.0f), 1.0f, hit));
+    // and over rising ground (height just ahead of the plane)
+    glm::vec2 heading = glm::vec2(plane.Front.x, plane.Front.z);
+    if (glm::length(heading) > 0.01f)
+        heading = glm::normalize(heading) * 3.0f;
+    glm::vec2 ahead = glm::vec2(plane.Position.x, plane.Position.z) + heading;
+    float clearance = plane.Position.y - std::max(simulation.GroundHeight(plane.Position.x, plane.Position.z), simulation.GroundHeight(ahead.x, ahead.y));
+    if (clearance < 0.6f || obstacle)
+        desired_pitch = 30.0f;
+
+    float yaw_error = desired_yaw - plane.Yaw;
+    while (yaw_error > 180.0f) yaw_error -= 360.0f;
+    while (yaw_error < -180.0f) yaw_error += 360.0f;
+    float pitch_error = desired_pitch - plane.Pitch;
+
+    input.plane_left = yaw_error > 3.0f;
+    input.plane_right = yaw_error < -3.0f;
+    input.plane_up = pitch_error > 2.0f;
+    input.plane_down = pitch_error < -2.0f;
+}
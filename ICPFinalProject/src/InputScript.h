@@ -0,0 +1,38 @@
+#pragma once
+
+#include "GameState.h"
+#include "Simulation.h"
+#include "Random.h"
+
+// Scripted input sources for sessions without a player (headless runs, benchmarks)
+enum Input_Script {
+    SCRIPT_IDLE,      // no input at all, the plane flies straight
+    SCRIPT_RANDOM,    // random arrow keys held for random durations
+    SCRIPT_AUTOPILOT  // flies to the nearest coin, pulls up near the ground
+};
+
+class InputScript {
+
+public:
+    InputScript(Input_Script type, unsigned int seed);
+
+    // inputs for the next tick of the given simulation
+    InputState Next(const Simulation& simulation);
+
+    // parses "idle" / "random" / "autopilot", returns false for unknown names
+    static bool FromName(const char* name, Input_Script& type);
+
+private:
+    // the autopilot re-plans every few ticks only, steering is held in between
+    static const int REPLAN_TICKS = 6;
+
+    Input_Script type;
+    Random random;
+    InputState input;
+    int hold_ticks = 0;
+    WorldSnapshot view; // what the autopilot "sees" when re-planning
+
+    void nextRandom();
+    void nextAutopilot(const Simulation& simulation);
+
+};
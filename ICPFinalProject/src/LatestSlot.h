@@ -0,0 +1,88 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+#include <cstdint>
+
+/*
+	Single-producer / single-consumer hand-over of the newest value, where the consumer waits.
+
+	Like TripleBuffer the producer never waits and a value the consumer didn't take in time is
+	replaced by the next one (counted as dropped), but Take() sleeps until something new arrives
+	instead of polling. Values are swapped, not copied: the producer gets the slot's old value
+	back, so buffers inside (cv::Mat images) are reused rather than reallocated.
+	Close() wakes the consumer for good, Take() returns false from then on (after handing out
+	a value published before closing).
+*/
+template <typename T>
+class LatestSlot {
+
+public:
+    // swaps value into the slot, value receives an old one to overwrite next time
+    void Publish(T& value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::swap(slot, value);
+            if (fresh)
+                dropped++;
+            fresh = true;
+            published++;
+        }
+        ready.notify_one();
+    }
+
+    // waits for a value published since the last Take(), swaps it into value
+    // false once the slot is closed and the last value was taken
+    bool Take(T& value)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this]() { return fresh || closed; });
+        if (!fresh)
+            return false;
+        std::swap(slot, value);
+        fresh = false;
+        return true;
+    }
+
+    // empty and open again, the first Publish() hands `initial` back to the producer
+    void Reset(const T& initial)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slot = initial;
+        fresh = false;
+        closed = false;
+    }
+
+    void Close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+    // values replaced before the consumer took them / published at all
+    uint64_t Dropped()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dropped;
+    }
+    uint64_t Published()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return published;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    T slot{};
+    bool fresh = false;
+    bool closed = false;
+    uint64_t dropped = 0;
+    uint64_t published = 0;
+
+};
@@ -4,6 +4,7 @@
 #include <vector>
 #include "ShaderProgram.h"
 #include "Mesh.h"
+#include "RenderStats.h"
 
 
 Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
@@ -67,4 +68,5 @@ void Mesh::Draw(ShaderProgram& shader)
     glBindVertexArray(VAO);
     glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
+    FrameRenderStats().Add(1, indices.size() / 3);
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+
+/*
+	Rolling window over the last CAPACITY samples of one metric (frame time, tick time, tracking
+	latency) for the HUD: the samples in order for a graph and percentiles over them.
+	Fixed storage, neither Add() nor Percentiles() allocates.
+*/
+class MetricHistory {
+
+public:
+    static const int CAPACITY = 240;
+
+    void Add(float value)
+    {
+        samples[next] = value;
+        next = (next + 1) % CAPACITY;
+        count = std::min(count + 1, CAPACITY);
+    }
+
+    int Count() const { return count; }
+    // i-th oldest sample in the window
+    float At(int i) const { return samples[(next - count + i + CAPACITY) % CAPACITY]; }
+    // newest sample, 0 when there is none
+    float Last() const { return count ? At(count - 1) : 0.0f; }
+
+    // p50 / p95 / p99 of the window (0 when empty)
+    void Percentiles(float& p50, float& p95, float& p99) const
+    {
+        p50 = p95 = p99 = 0.0f;
+        if (count == 0)
+            return;
+        for (int i = 0; i < count; i++)
+            sorted[i] = At(i);
+        std::sort(sorted, sorted + count);
+        p50 = sorted[std::min(count - 1, count / 2)];
+        p95 = sorted[std::min(count - 1, count * 95 / 100)];
+        p99 = sorted[std::min(count - 1, count * 99 / 100)];
+    }
+
+private:
+    float samples[CAPACITY] = {};
+    mutable float sorted[CAPACITY];
+    int next = 0;
+    int count = 0;
+
+};
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <GL/glew.h> // GLEW provides efficient run-time mechanisms for determining which OpenGL extensions are supported on the target platform.
 #include <glm/glm.hpp> // ibrary for math operations
 #include <glm/ext.hpp>
 
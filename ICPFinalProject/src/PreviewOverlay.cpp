@@ -0,0 +1,109 @@
+#include <cstring>
+
+#include "PreviewOverlay.h"
+
+PreviewOverlay::PreviewOverlay()
+    : shader("resources/shaders/overlay.vert", "resources/shaders/overlay.frag")
+{
+    glGenVertexArrays(1, &VAO);
+    glGenTextures(1, &texture);
+    glGenBuffers(2, pbos);
+}
+
+PreviewOverlay::~PreviewOverlay()
+{
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteTextures(1, &texture);
+    glDeleteBuffers(2, pbos);
+}
+
+void PreviewOverlay::resize(int newWidth, int newHeight)
+{
+    width = newWidth;
+    height = newHeight;
+    pending = -1;
+    ready = false;
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // BGR rows aren't 4 byte aligned
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    for (unsigned int pbo : pbos) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)width * height * 3, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// texture <- the pending PBO, the copy runs on the GPU's side
+void PreviewOverlay::flush()
+{
+    if (pending < 0)
+        return;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[pending]);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_BGR, GL_UNSIGNED_BYTE, (void*)0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    pending = -1;
+    ready = true;
+}
+
+void PreviewOverlay::Upload(const uint8_t* bgr, int imageWidth, int imageHeight, size_t stride)
+{
+    if (imageWidth <= 0 || imageHeight <= 0)
+        return;
+    if (imageWidth != width || imageHeight != height)
+        resize(imageWidth, imageHeight);
+    // a previous image still waiting goes into the texture now, its PBO is free afterwards
+    flush();
+
+    size_t row = (size_t)width * 3;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[write]);
+    // invalidating lets the driver hand out fresh memory instead of waiting for an older copy
+    uint8_t* dst = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)(row * height),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst) {
+        for (int y = 0; y < height; y++)
+            std::memcpy(dst + row * y, bgr + stride * y, row);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        pending = write;
+        pending_frame = frames;
+        write ^= 1;
+        uploads++;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void PreviewOverlay::Draw(int viewportWidth, int viewportHeight, int drawHeight, int margin)
+{
+    // an image filled during an earlier frame has had its time to get to the GPU
+    if (pending >= 0 && pending_frame < frames)
+        flush();
+    frames++;
+    if (!ready || viewportWidth <= 0 || viewportHeight <= 0)
+        return;
+
+    float drawWidth = (float)drawHeight * width / height;
+    float x1 = 1.0f - 2.0f * margin / viewportWidth;
+    float y1 = 1.0f - 2.0f * margin / viewportHeight;
+    float x0 = x1 - 2.0f * drawWidth / viewportWidth;
+    float y0 = y1 - 2.0f * drawHeight / viewportHeight;
+
+    glDisable(GL_DEPTH_TEST);
+    shader.use();
+    shader.setVec4("rect", glm::vec4(x0, y0, x1, y1));
+    shader.setInt("image", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+}
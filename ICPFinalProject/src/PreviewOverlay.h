@@ -0,0 +1,52 @@
+#pragma once
+
+#include <GL/glew.h> // GLEW provides efficient run-time mechanisms for determining which OpenGL extensions are supported on the target platform.
+#include <glm/glm.hpp> // ibrary for math operations
+#include <cstdint>
+#include <cstddef>
+
+#include "ShaderProgram.h"
+
+/*
+	Picture-in-picture of the tracking camera, drawn over the finished frame (replaces the
+	HighGUI window the tracker used to open from its own thread).
+
+	Images are streamed through two pixel buffer objects: Upload() copies the new image into one
+	PBO, the texture is updated from it a frame later (the driver copies from the PBO on its own
+	time) while the next image goes into the other PBO. The render thread never waits for the
+	copy and never touches a buffer the GPU may still be reading.
+*/
+class PreviewOverlay {
+
+public:
+    // needs a current OpenGL context
+    PreviewOverlay();
+    ~PreviewOverlay();
+
+    // new BGR image (3 bytes per pixel, stride bytes per row), shows up from the next frame on
+    void Upload(const uint8_t* bgr, int width, int height, size_t stride);
+
+    // top right corner of the viewport, `height` pixels high, margin pixels from the edges;
+    // nothing until the first image arrived
+    void Draw(int viewportWidth, int viewportHeight, int height = 240, int margin = 16);
+
+    // uploads so far (previews that reached the GPU)
+    uint64_t Uploads() const { return uploads; }
+
+private:
+    ShaderProgram shader;
+    unsigned int VAO; // empty, the quad comes from gl_VertexID
+    unsigned int texture;
+    unsigned int pbos[2];
+    int width = 0, height = 0;
+    int write = 0;              // PBO the next image goes into
+    int pending = -1;           // PBO with an image not in the texture yet, -1 = none
+    uint64_t pending_frame = 0; // Draw() count when it was filled
+    uint64_t frames = 0;
+    uint64_t uploads = 0;
+    bool ready = false;         // the texture holds an image
+
+    void resize(int width, int height);
+    void flush();
+
+};
@@ -0,0 +1,23 @@
+#include "Random.h"
+
+void Random::FillRange(float* out, size_t count, float min, float max)
+{
+    // local copy keeps the state in registers for the whole loop
+    Random local = *this;
+    float scale = (max - min) * (1.0f / 16777216.0f);
+    for (size_t i = 0; i < count; i++)
+        out[i] = min + (local.Next() >> 8) * scale;
+    *this = local;
+}
+
+void Random::FillInBox(glm::vec3* out, size_t count, const glm::vec3& min, const glm::vec3& max)
+{
+    Random local = *this;
+    glm::vec3 scale = (max - min) * (1.0f / 16777216.0f);
+    for (size_t i = 0; i < count; i++) {
+        out[i].x = min.x + (local.Next() >> 8) * scale.x;
+        out[i].y = min.y + (local.Next() >> 8) * scale.y;
+        out[i].z = min.z + (local.Next() >> 8) * scale.z;
+    }
+    *this = local;
+}
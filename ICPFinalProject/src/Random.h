@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <cstdint>
+#include <cstddef>
+
+/*
+	Small fast random number generator (PCG32, pcg-random.org): 16 bytes of state, one
+	multiply-add per number. Replaces std::random_device + std::mt19937 + distribution objects.
+
+	- one explicit seed, several independent streams per seed; the caller passes the stream
+	  number (e.g. one per system or per chunk)
+	- floats are made from the top 24 bits, so results are the same with every compiler / standard
+	  library (std::uniform_real_distribution is not) - recordings replay the same everywhere
+	- batched fills for particle / spawn code
+*/
+class Random {
+
+public:
+    Random(uint64_t seed = 0, uint64_t stream = 0) { Seed(seed, stream); }
+
+    void Seed(uint64_t seed, uint64_t stream = 0)
+    {
+        state = 0;
+        increment = (stream << 1) | 1;
+        Next();
+        state += seed;
+        Next();
+    }
+
+    // uniform 32 bit integer
+    uint32_t Next()
+    {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31));
+    }
+
+    // uniform float in [0, 1)
+    float Float()
+    {
+        return (Next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // uniform float in [min, max)
+    float Range(float min, float max)
+    {
+        return min + (max - min) * Float();
+    }
+
+    // uniform integer in [min, max] (multiply-shift, bias is negligible for small ranges)
+    int Int(int min, int max)
+    {
+        uint32_t range = (uint32_t)(max - min) + 1u;
+        return min + (int)(((uint64_t)Next() * range) >> 32);
+    }
+
+    // uniform point in the box min..max (components drawn x, y, z in this order)
+    glm::vec3 InBox(const glm::vec3& min, const glm::vec3& max)
+    {
+        glm::vec3 v;
+        v.x = Range(min.x, max.x);
+        v.y = Range(min.y, max.y);
+        v.z = Range(min.z, max.z);
+        return v;
+    }
+
+    // batched versions, same sequence as calling the single versions in a loop
+    void FillRange(float* out, size_t count, float min, float max);
+    void FillInBox(glm::vec3* out, size_t count, const glm::vec3& min, const glm::vec3& max);
+
+private:
+    uint64_t state;
+    uint64_t increment;
+
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+// draw calls and triangles submitted by the render thread during one frame
+struct RenderStats {
+    int draw_calls = 0;
+    size_t triangles = 0;
+
+    void Add(int draws, size_t tris)
+    {
+        draw_calls += draws;
+        triangles += tris;
+    }
+};
+
+// the render thread's counters: the renderers add to them, GameApp reads and resets them every frame
+inline RenderStats& FrameRenderStats()
+{
+    static RenderStats stats;
+    return stats;
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "RoiTracker.h"
+
+void RoiTracker::Reset()
+{
+    predictor = TrackingPredictor();
+    last = RoiResult();
+    locked = false;
+    radius = 0.0f;
+    last_count = 0;
+    skipped = 0;
+    grid.clear();
+}
+
+// samples the grid into current, returns the changed samples against the last processed
+// frame (slow motion adds up until it counts), -1 when there is no reference yet
+int RoiTracker::motion(const uint8_t* bgr, int width, int height, size_t stride, uint64_t& pixels)
+{
+    int step = std::max(1, settings.motion_step);
+    int gw = (width + step - 1) / step, gh = (height + step - 1) / step;
+    bool compare = gw == grid_width && gh == grid_height && !grid.empty();
+    current.resize((size_t)gw * gh);
+    current_width = gw;
+    current_height = gh;
+
+    int changed = 0;
+    uint8_t* sample = current.data();
+    const uint8_t* reference = grid.data();
+    for (int y = 0; y < height; y += step) {
+        const uint8_t* row = bgr + y * stride + 1; // green
+        for (int x = 0; x < width; x += step, sample++) {
+            *sample = row[x * 3];
+            if (compare && std::abs((int)*sample - (int)*reference++) > settings.motion_threshold)
+                changed++;
+        }
+    }
+    pixels += (uint64_t)gw * gh;
+    return compare ? changed : -1;
+}
+
+// thresholds the window around center (pixels), false when the marker isn't (enough) in it
+bool RoiTracker::window(const uint8_t* bgr, int width, int height, size_t stride, glm::vec2 center, RoiResult& result, HsvMoments& moments)
+{
+    int half = std::max(settings.min_window, (int)std::ceil(radius * settings.window_radii));
+    result.x0 = std::clamp((int)center.x - half, 0, width);
+    result.x1 = std::clamp((int)center.x + half, 0, width);
+    result.y0 = std::clamp((int)center.y - half, 0, height);
+    result.y1 = std::clamp((int)center.y + half, 0, height);
+    moments = HsvThresholdMomentsRect(bgr, stride, result.x0, result.y0, result.x1, result.y1, range);
+    result.pixels += (uint64_t)(result.x1 - result.x0) * (result.y1 - result.y0);
+    return moments.count > 0 && (!locked || moments.count >= settings.min_kept * last_count);
+}
+
+RoiResult RoiTracker::Track(const uint8_t* bgr, int width, int height, size_t stride, double time)
+{
+    RoiResult result;
+    int changed = motion(bgr, width, height, stride, result.pixels);
+    if (changed >= 0 && changed < settings.motion_samples && skipped < settings.max_skipped) {
+        // nothing moved: the marker (or its absence) is where it was
+        skipped++;
+        TrackingSample still;
+        still.capture_time = still.result_time = time;
+        still.center = last.center;
+        still.confidence = last.confidence;
+        predictor.Add(still);
+        RoiResult same = last;
+        same.skipped = true;
+        same.searched = false;
+        same.pixels = result.pixels;
+        return same;
+    }
+    skipped = 0;
+    // this frame is the motion reference from now on
+    grid.swap(current);
+    grid_width = current_width;
+    grid_height = current_height;
+
+    HsvMoments moments;
+    bool found = false;
+    if (locked) {
+        glm::vec2 predicted = predictor.Predict(time) * glm::vec2((float)width, (float)height);
+        found = window(bgr, width, height, stride, predicted, result, moments);
+        if (found) {
+            // centroid close to a cut edge of the window: the marker sticks out, centre on it and redo
+            glm::vec2 center((float)((double)moments.sum_x / moments.count), (float)((double)moments.sum_y / moments.count));
+            float margin = radius * 1.5f;
+            if ((result.x0 > 0 && center.x - result.x0 < margin) || (result.x1 < width && result.x1 - center.x < margin)
+                || (result.y0 > 0 && center.y - result.y0 < margin) || (result.y1 < height && result.y1 - center.y < margin))
+                found = window(bgr, width, height, stride, center, result, moments);
+        }
+    }
+    if (!found) {
+        // lost: coarse search over the downscaled frame, then the window around what it found
+        int step = std::max(1, settings.coarse_step);
+        HsvMoments coarse = HsvThresholdMomentsSubsampled(bgr, width, height, stride, step, range);
+        result.searched = true;
+        result.pixels += (uint64_t)((width + step - 1) / step) * ((height + step - 1) / step);
+        if (coarse.count > 0) {
+            locked = false;
+            radius = std::sqrt(coarse.count * (float)(step * step) / 3.14159265f);
+            glm::vec2 center((float)((double)coarse.sum_x / coarse.count), (float)((double)coarse.sum_y / coarse.count));
+            found = window(bgr, width, height, stride, center, result, moments);
+        }
+    }
+
+    TrackingSample sample;
+    sample.capture_time = sample.result_time = time;
+    if (found) {
+        result.center = moments.Normalized(width, height);
+        result.confidence = (float)std::min(1.0, moments.count / ((double)width * height * settings.full_confidence));
+        radius = std::sqrt(moments.count / 3.14159265f);
+        last_count = moments.count;
+        sample.center = result.center;
+        sample.confidence = result.confidence;
+    }
+    locked = found;
+    predictor.Add(sample);
+    last = result;
+    return result;
+}
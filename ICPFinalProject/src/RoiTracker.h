@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <vector>
+#include <cstdint>
+
+#include "HsvCentroid.h"
+#include "TrackingPredictor.h"
+
+/*
+	Colour tracking that looks where the marker is going to be instead of at the whole frame.
+
+	- motion check first: a sparse grid of the frame against the last processed one, when (almost)
+	  nothing changed the frame is skipped and the last result stays
+	- while the marker is locked, only a window around the predicted centroid (TrackingPredictor
+	  over the frame times) is thresholded, in full resolution, sized by the marker's radius
+	- when the marker isn't in the window (or there is no lock), a coarse search over a
+	  downscaled frame finds it again and the window is thresholded around that
+	- Pixels() of each frame say how much work it was, against width * height for the full frame
+*/
+
+struct RoiSettings {
+    int coarse_step = 4;         // lost: every 4th pixel of every 4th row
+    float window_radii = 3.0f;   // window half size in marker radii
+    int min_window = 24;         // smallest window half size (pixels)
+    int motion_step = 8;         // motion check grid spacing (pixels)
+    int motion_threshold = 24;   // change of a grid sample (green channel) that counts as motion
+    int motion_samples = 2;      // fewer changed samples than this = no motion, frame skipped
+    int max_skipped = 15;        // frames skipped in a row at most (confidence gets refreshed)
+    float min_kept = 0.25f;      // marker below this part of its last size in the window = lost
+    float full_confidence = 0.002f; // fraction of the frame inside range for confidence 1
+};
+
+struct RoiResult {
+    glm::vec2 center = glm::vec2(0.0f); // normalized, (0, 0) = nothing found
+    float confidence = 0.0f;
+    bool skipped = false;  // no motion, the previous result
+    bool searched = false; // coarse full frame search was needed
+    uint64_t pixels = 0;   // pixels read this frame (motion grid + coarse + window)
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0; // full resolution window
+};
+
+class RoiTracker {
+
+public:
+    RoiSettings settings;
+    HsvRange range = { { 170, 150, 150 }, { 180, 255, 250 } };
+
+    // one BGR frame captured at time (seconds)
+    RoiResult Track(const uint8_t* bgr, int width, int height, size_t stride, double time);
+
+    // forgets the lock and the motion reference
+    void Reset();
+
+private:
+    TrackingPredictor predictor;
+    RoiResult last;
+    bool locked = false;
+    float radius = 0.0f; // marker radius in pixels
+    uint64_t last_count = 0;
+    int skipped = 0;
+    std::vector<uint8_t> grid, current; // motion reference (last processed frame), this frame
+    int grid_width = 0, grid_height = 0;
+    int current_width = 0, current_height = 0;
+
+    int motion(const uint8_t* bgr, int width, int height, size_t stride, uint64_t& pixels);
+    bool window(const uint8_t* bgr, int width, int height, size_t stride, glm::vec2 center, RoiResult& result, HsvMoments& moments);
+
+};
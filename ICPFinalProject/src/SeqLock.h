@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+/*
+	Single-writer / many-reader publication of a small value without locks.
+
+	The writer bumps the sequence to odd, stores the value, bumps it to even again. A reader
+	copies the value and retries if the sequence was odd or changed meanwhile, so it always gets
+	one complete value, the newest at the time. The writer never waits; readers only retry
+	while a store (a few words) is in flight.
+	The value lives in relaxed atomic words, not plain memory, so there is no data race.
+*/
+template <typename T>
+class SeqLock {
+
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock values are copied as raw words");
+
+public:
+    SeqLock() { Store(T{}); }
+
+    void Store(const T& value)
+    {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        uint64_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++)
+            data[i].store(words[i], std::memory_order_relaxed);
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    T Load() const
+    {
+        uint64_t words[WORDS];
+        while (true) {
+            uint64_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1)
+                continue;
+            for (size_t i = 0; i < WORDS; i++)
+                words[i] = data[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before)
+                break;
+        }
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    // number of Store() calls so far (the constructor stores T{})
+    uint64_t Version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    static const size_t WORDS = (sizeof(T) + 7) / 8;
+
+    std::atomic<uint64_t> sequence{ 0 };
+    std::atomic<uint64_t> data[WORDS];
+
+};
@@ -2,10 +2,12 @@
 #include <glm/ext.hpp>
 
 #include "ShaderProgram.h"
+#include "Trace.h"
 
 
 // constructor
 ShaderProgram::ShaderProgram(const char* vertexPath, const char* fragmentPath) {
+    TRACE_SCOPE("shader compile");
 
 
     // 1. retrieve the vertex/fragment source code from filePath
@@ -111,12 +113,17 @@ void ShaderProgram::setFloat(const std::string& name, float value) const
 {
     glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
 }
-void ShaderProgram::setMat4(const std::string& name, glm::mat4 &mat) const 
+void ShaderProgram::setMat4(const std::string& name, const glm::mat4 &mat) const 
 {
     glUniformMatrix4fv((glGetUniformLocation(ID, name.c_str())), 1, GL_FALSE, &mat[0][0]);
 }
 
-void ShaderProgram::setVec3(const std::string& name, glm::vec3& vec) const 
+void ShaderProgram::setVec2(const std::string& name, const glm::vec2& vec) const
+{
+    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &vec[0]);
+}
+
+void ShaderProgram::setVec3(const std::string& name, const glm::vec3& vec) const 
 {
     glUniform3fv((glGetUniformLocation(ID, name.c_str())), 1, &vec[0]);
 
@@ -127,6 +134,11 @@ void ShaderProgram::setVec3(const std::string& name, float x, float y, float z)
     glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
 }
 
+void ShaderProgram::setVec4(const std::string& name, const glm::vec4& vec) const
+{
+    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &vec[0]);
+}
+
 // destructor
 ShaderProgram::~ShaderProgram() {
 
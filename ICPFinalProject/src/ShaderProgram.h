@@ -25,9 +25,11 @@ public:
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
     void setFloat(const std::string& name, float value) const;
-    void setMat4(const std::string& name, glm::mat4 &mat) const;
-    void setVec3(const std::string& name, glm::vec3& vec) const;
+    void setMat4(const std::string& name, const glm::mat4 &mat) const;
+    void setVec2(const std::string& name, const glm::vec2& vec) const;
+    void setVec3(const std::string& name, const glm::vec3& vec) const;
     void setVec3(const std::string& name, float x, float y, float z) const;
+    void setVec4(const std::string& name, const glm::vec4& vec) const;
 
 
 };
@@ -0,0 +1,395 @@
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <cmath>
+
+#include "Simulation.h"
+#include "Timing.h"
+
+
+glm::mat4 Simulation::WoodenMapTransform()
+{
+	// centered on the play area, scaled to the 10 x 10 coin field, a bit above the ground plane
+	glm::mat4 model = glm::mat4(1.0f);
+	model = glm::translate(model, glm::vec3(0.85f, 0.01f, 1.95f));
+	return glm::scale(model, glm::vec3(0.6f));
+}
+
+bool Simulation::LoadTerrain(TriangleBVH& terrain)
+{
+	if (!terrain.AddObj("resources/objects/wooden_map/Wooden.obj", WoodenMapTransform()))
+		return false;
+	terrain.Build();
+	return true;
+}
+
+Simulation::Simulation(unsigned int seed, const TriangleBVH* terrain)
+	: seed(seed), random(seed), terrain(terrain)
+{
+	previous_camera_position = camera.Position;
+
+	//coins are spread over a 3x3 grid of cells
+	const float cells[3][2] = { { -5.0f, -2.0f }, { -1.5f, 1.5f }, { 2.0f, 5.0f } };
+	coins.Reserve(NUM_COINS);
+	for (int i = 0; i < NUM_COINS; i++) {
+		const float* x = cells[i / 3];
+		const float* z = cells[i % 3];
+		spawnCoin(glm::vec3(x[0], 0.2f, z[0]), glm::vec3(x[1], 3.0f, z[1]));
+	}
+
+	// bombs appear during the game (spawnBomb)
+	bombs.Reserve(MAX_BOMBS);
+
+	flames.Reserve(NUM_FLAMES);
+	flame_respawns.reserve(NUM_FLAMES);
+	flame_forward.resize(NUM_FLAMES);
+	flame_lifecycle.resize(NUM_FLAMES);
+	flame_lifespan.resize(NUM_FLAMES);
+	for (int i = 0; i < NUM_FLAMES; i++) {
+		flames.Add(glm::vec3(0.0f), 0.0f, 0.0f);
+		flame_respawns.push_back(i);
+	}
+	respawnFlames();
+
+	streamChunks(true);
+}
+
+// random point in the box, away from the level geometry (gives up after a few tries)
+glm::vec3 Simulation::spawnPoint(const glm::vec3& min, const glm::vec3& max, float radius)
+{
+	glm::vec3 point = random.InBox(min, max);
+	for (int attempt = 0; terrain && attempt < 16 && terrain->OverlapSphere(point, radius); attempt++)
+		point = random.InBox(min, max);
+	return point;
+}
+
+EntityHandle Simulation::addCoin(const glm::vec3& position, bool respawns)
+{
+	float angle = random.Range(0.0f, 360.0f);
+	EntityHandle coin = coins.Add(position, angle, 0.0f, -1, (char)respawns);
+	coins.Get<COIN_COLLIDER>(coin) = collision.Insert(position, COIN_RADIUS, LAYER_COIN, (int)coin.slot);
+	return coin;
+}
+
+EntityHandle Simulation::addBomb(const glm::vec3& position)
+{
+	EntityHandle bomb = bombs.Add(position, -1);
+	bombs.Get<BOMB_COLLIDER>(bomb) = collision.Insert(position, BOMB_RADIUS, LAYER_BOMB, (int)bomb.slot);
+	return bomb;
+}
+
+void Simulation::spawnCoin(const glm::vec3& min, const glm::vec3& max)
+{
+	addCoin(spawnPoint(min, max, COIN_RADIUS), true);
+}
+
+void Simulation::spawnBomb()
+{
+	addBomb(spawnPoint(glm::vec3(-5.0f, 0.5f, -5.0f), glm::vec3(5.0f, 3.0f, 5.0f), BOMB_RADIUS));
+}
+
+// keeps the coins and bombs of the chunks around the plane in the world
+// (only when the plane enters another chunk; chunk content depends on the seed only, so replays match)
+void Simulation::streamChunks(bool force)
+{
+	ChunkCoord center = ChunkCoord::Of(plane.Position);
+	if (!force && center == chunk_center)
+		return;
+	chunk_center = center;
+
+	for (size_t i = 0; i < active_chunks.size();) {
+		ActiveChunk& chunk = active_chunks[i];
+		if (chunk.coord.Distance(center) <= ACTIVE_CHUNK_RADIUS + 1) {
+			i++;
+			continue;
+		}
+		// collected coins are gone already, their handles are dead
+		for (EntityHandle coin : chunk.coins) {
+			if (coins.Alive(coin)) {
+				collision.Remove(coins.Get<COIN_COLLIDER>(coin));
+				coins.Remove(coin);
+			}
+		}
+		for (EntityHandle bomb : chunk.bombs) {
+			collision.Remove(bombs.Get<BOMB_COLLIDER>(bomb));
+			bombs.Remove(bomb);
+		}
+		active_chunks.erase(active_chunks.begin() + i);
+	}
+
+	for (int dz = -ACTIVE_CHUNK_RADIUS; dz <= ACTIVE_CHUNK_RADIUS; dz++) {
+		for (int dx = -ACTIVE_CHUNK_RADIUS; dx <= ACTIVE_CHUNK_RADIUS; dx++) {
+			ActiveChunk chunk;
+			chunk.coord.x = center.x + dx;
+			chunk.coord.z = center.z + dz;
+			bool active = false;
+			for (const ActiveChunk& other : active_chunks)
+				active = active || other.coord == chunk.coord;
+			if (active)
+				continue;
+
+			ChunkGameplay(seed, chunk.coord, chunk_coins, chunk_bombs);
+			auto collected = collected_coins.find(chunk.coord.Key());
+			uint32_t collected_bits = collected != collected_coins.end() ? collected->second : 0;
+			for (size_t c = 0; c < chunk_coins.size(); c++)
+				chunk.coins.push_back(collected_bits >> c & 1u ? EntityHandle() : addCoin(chunk_coins[c], false));
+			for (const glm::vec3& position : chunk_bombs)
+				chunk.bombs.push_back(addBomb(position));
+			active_chunks.push_back(std::move(chunk));
+		}
+	}
+}
+
+// remembers an open world coin as collected, its chunk won't bring it back
+void Simulation::collectChunkCoin(EntityHandle coin)
+{
+	for (ActiveChunk& chunk : active_chunks) {
+		for (size_t c = 0; c < chunk.coins.size(); c++) {
+			if (chunk.coins[c] == coin) {
+				collected_coins[chunk.coord.Key()] |= 1u << c;
+				chunk.coins[c] = EntityHandle();
+				return;
+			}
+		}
+	}
+}
+
+// new values for the particles in flame_respawns (indices into the flame arrays), then empties it;
+// one batch per component in a fixed order, so the sequence only depends on which particles expired
+void Simulation::respawnFlames()
+{
+	size_t count = flame_respawns.size();
+	if (count == 0)
+		return;
+	random.FillInBox(flame_forward.data(), count, glm::vec3(-10.0f, -10.0f, -50.0f), glm::vec3(10.0f, 10.0f, -30.0f));
+	random.FillRange(flame_lifecycle.data(), count, 0.01f, 0.02f);
+	random.FillRange(flame_lifespan.data(), count, 0.1f, 0.5f);
+
+	glm::vec3* forward = flames.Column<FLAME_FORWARD>();
+	float* lifecycle = flames.Column<FLAME_LIFECYCLE>();
+	float* lifespan = flames.Column<FLAME_LIFESPAN>();
+	for (size_t k = 0; k < count; k++) {
+		uint32_t i = flame_respawns[k];
+		forward[i] = flame_forward[k];
+		lifecycle[i] = flame_lifecycle[k];
+		lifespan[i] = flame_lifespan[k];
+	}
+	flame_respawns.clear();
+}
+
+void Simulation::Tick(const InputState& input, float dt)
+{
+	tick++;
+
+	// state at the start of the tick, the renderer interpolates from it
+	previous_plane = planeState();
+	previous_rotor_angle = rotor_angle;
+	previous_coin_angle = coin_angle;
+	previous_camera_position = camera.Position;
+
+	// free camera (works while paused too)
+	if (input.camera_forward)
+		camera.ProcessKeyboard(FORWARD, dt);
+	if (input.camera_backward)
+		camera.ProcessKeyboard(BACKWARD, dt);
+	if (input.camera_left)
+		camera.ProcessKeyboard(LEFT, dt);
+	if (input.camera_right)
+		camera.ProcessKeyboard(RIGHT, dt);
+	glm::vec2 mouse = input.mouse_total - last_mouse_total;
+	if (mouse.x != 0.0f || mouse.y != 0.0f)
+		camera.ProcessMouseMovement(mouse.x, mouse.y);
+	if (input.scroll_total != last_scroll_total)
+		camera.ProcessMouseScroll(input.scroll_total - last_scroll_total);
+	last_mouse_total = input.mouse_total;
+	last_scroll_total = input.scroll_total;
+	activeView = input.activeView;
+
+	// keyboard steering
+	if (input.plane_up)
+		plane.ProcessKeyboard(P_FORWARD, dt);
+	if (input.plane_down)
+		plane.ProcessKeyboard(P_BACKWARD, dt);
+	if (input.plane_left)
+		plane.ProcessKeyboard(P_LEFT, dt);
+	if (input.plane_right)
+		plane.ProcessKeyboard(P_RIGHT, dt);
+
+	if (input.GameFreeze || game_over != GAME_RUNNING)
+		return;
+
+	if (input.controllMode == 1) {
+		plane.Yaw += (input.tracking.x - 0.5f) * TRACKING_TURN_RATE * dt;
+		plane.Pitch += (input.tracking.y - 0.5f) * TRACKING_TURN_RATE * dt;
+		if (plane.Yaw > 360) plane.Yaw -= 360;
+		if (plane.Yaw < 0) plane.Yaw += 360;
+		if (plane.Pitch > 89.0f) plane.Pitch = 89.0f;
+		if (plane.Pitch < -89.0f) plane.Pitch = -89.0f;
+		plane.updatePlaneVectors();
+
+	}
+	//movement
+	plane.Position += plane.Front * plane.MovementSpeed * SPEED_SCALE * dt;
+
+	//baloon cooldowns
+	float* cooldowns = coins.Column<COIN_TIMER>();
+	for (size_t i = 0; i < coins.Size(); i++)
+	{
+		if (cooldowns[i] > 0.0f) {
+			cooldowns[i] -= dt;
+		}
+	}
+	//flame
+	float* lifecycle = flames.Column<FLAME_LIFECYCLE>();
+	const float* lifespan = flames.Column<FLAME_LIFESPAN>();
+	for (size_t i = 0; i < flames.Size(); i++) {
+		lifecycle[i] += FLAME_RATE * dt;
+		if (lifecycle[i] > lifespan[i]) {
+			flame_respawns.push_back((uint32_t)i);
+		}
+	}
+	respawnFlames();
+
+	coin_angle = std::fmod(coin_angle + COIN_SPIN * dt, 360.0f);
+	rotor_angle = std::fmod(rotor_angle + ROTOR_SPIN * dt, 360.0f);
+
+	streamChunks(false);
+
+	//colisions
+	double collisionStart = NowSeconds();
+	collide();
+	collision_seconds = NowSeconds() - collisionStart;
+}
+
+// the nose moved from where it was at the start of the tick to where it is now,
+// that whole segment is tested so a fast plane can't fly through a coin or bomb between ticks
+void Simulation::collide()
+{
+	glm::vec3 nose_from = previous_plane.Position + previous_plane.Front * 0.3f;
+	glm::vec3 nose = plane.Position + plane.Front * 0.3f;
+
+	//coins
+	hits.clear();
+	collision.QuerySegment(nose_from, nose, 0.0f, LAYER_COIN, hits);
+	for (const CollisionHit& hit : hits) {
+		EntityHandle coin = coins.HandleOfSlot((uint32_t)hit.id);
+		if (!coins.Get<COIN_RESPAWNS>(coin)) {
+			// coins of the open world are collected for good
+			collectChunkCoin(coin);
+			collision.Remove(coins.Get<COIN_COLLIDER>(coin));
+			coins.Remove(coin);
+			score += 1;
+		}
+		else if (coins.Get<COIN_TIMER>(coin) <= 0.0f) {
+			glm::vec3& position = coins.Get<COIN_POSITION>(coin);
+			position = spawnPoint(glm::vec3(-5.0f, 0.0f, -5.0f), glm::vec3(5.0f, 3.0f, 5.0f), COIN_RADIUS);
+			collision.Move(coins.Get<COIN_COLLIDER>(coin), position);
+			score += 1;
+			coins.Get<COIN_TIMER>(coin) = COIN_COOLDOWN;
+		}
+	}
+
+	//bombs in the home field, one more for every two points
+	int wanted_bombs = score / 2 < MAX_BOMBS ? score / 2 : MAX_BOMBS;
+	for (; score_bombs < wanted_bombs; score_bombs++)
+		spawnBomb();
+	hits.clear();
+	if (collision.QuerySegment(nose_from, nose, 0.0f, LAYER_BOMB, hits) > 0) {
+		game_over = GAME_OVER_BOMB;
+	}
+
+	//ground and the wooden map
+	BVHHit terrain_hit;
+	if (plane.Position.y < GroundHeight(plane.Position.x, plane.Position.z) || (terrain && terrain->SphereCast(nose_from, nose, PLANE_RADIUS, terrain_hit))) {
+		game_over = GAME_OVER_GROUND;
+	}
+}
+
+PlaneState Simulation::planeState() const
+{
+	PlaneState state;
+	state.Position = plane.Position;
+	state.Front = plane.Front;
+	state.Up = plane.Up;
+	state.Right = plane.Right;
+	state.Yaw = plane.Yaw;
+	state.Pitch = plane.Pitch;
+	return state;
+}
+
+void Simulation::WriteSnapshot(WorldSnapshot& snapshot) const
+{
+	snapshot.tick = tick;
+
+	snapshot.plane = planeState();
+	snapshot.previous_plane = tick > 0 ? previous_plane : snapshot.plane;
+	snapshot.rotor_angle = rotor_angle;
+	snapshot.previous_rotor_angle = tick > 0 ? previous_rotor_angle : rotor_angle;
+	snapshot.coin_angle = coin_angle;
+	snapshot.previous_coin_angle = tick > 0 ? previous_coin_angle : coin_angle;
+
+	snapshot.camera.Position = camera.Position;
+	snapshot.camera.Front = camera.Front;
+	snapshot.camera.Up = camera.Up;
+	snapshot.camera.Zoom = camera.Zoom;
+	snapshot.previous_camera_position = previous_camera_position;
+	snapshot.activeView = activeView;
+
+	// assign / resize keep the snapshot buffers, they only grow when the world does
+	size_t count = coins.Size();
+	const glm::vec3* coin_positions = coins.Column<COIN_POSITION>();
+	const float* coin_angles = coins.Column<COIN_ANGLE>();
+	const float* coin_cooldowns = coins.Column<COIN_TIMER>();
+	snapshot.coin_positions.assign(coin_positions, coin_positions + count);
+	snapshot.coin_angles.assign(coin_angles, coin_angles + count);
+	snapshot.coin_visible.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		snapshot.coin_visible[i] = coin_cooldowns[i] <= 0.0f;
+	}
+
+	const glm::vec3* bomb_positions = bombs.Column<BOMB_POSITION>();
+	snapshot.bombs.assign(bomb_positions, bomb_positions + bombs.Size());
+
+	const glm::vec3* forwards = flames.Column<FLAME_FORWARD>();
+	const float* lifecycle = flames.Column<FLAME_LIFECYCLE>();
+	snapshot.flame_offsets.resize(flames.Size());
+	for (size_t i = 0; i < flames.Size(); i++) {
+		snapshot.flame_offsets[i] = forwards[i] * lifecycle[i];
+	}
+
+	snapshot.score = score;
+	snapshot.game_over = game_over;
+}
+
+// FNV-1a over the raw bytes of the state
+static void hashBytes(unsigned long long& hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+}
+
+unsigned long long Simulation::StateHash() const
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	hashBytes(hash, &tick, sizeof(tick));
+	hashBytes(hash, &score, sizeof(score));
+	hashBytes(hash, &game_over, sizeof(game_over));
+	hashBytes(hash, &plane.Position, sizeof(plane.Position));
+	hashBytes(hash, &plane.Yaw, sizeof(plane.Yaw));
+	hashBytes(hash, &plane.Pitch, sizeof(plane.Pitch));
+	hashBytes(hash, &camera.Position, sizeof(camera.Position));
+	hashBytes(hash, &camera.Yaw, sizeof(camera.Yaw));
+	hashBytes(hash, &camera.Pitch, sizeof(camera.Pitch));
+	hashBytes(hash, coins.Column<COIN_POSITION>(), coins.Size() * sizeof(glm::vec3));
+	hashBytes(hash, coins.Column<COIN_TIMER>(), coins.Size() * sizeof(float));
+	hashBytes(hash, bombs.Column<BOMB_POSITION>(), bombs.Size() * sizeof(glm::vec3));
+	hashBytes(hash, flames.Column<FLAME_FORWARD>(), flames.Size() * sizeof(glm::vec3));
+	hashBytes(hash, flames.Column<FLAME_LIFECYCLE>(), flames.Size() * sizeof(float));
+	for (const auto& collected : collected_coins) {
+		hashBytes(hash, &collected.first, sizeof(collected.first));
+		hashBytes(hash, &collected.second, sizeof(collected.second));
+	}
+	return hash;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <vector>
+#include <map>
+
+#include "Plane.h"
+#include "Camera.h"
+#include "GameState.h"
+#include "Random.h"
+#include "CollisionWorld.h"
+#include "TriangleBVH.h"
+#include "EntityPool.h"
+#include "ChunkStreamer.h"
+#include "Terrain.h"
+
+/*
+	Game logic of one session: plane movement, free camera, coins, bombs, flame particles and collisions.
+	The world is open: coins and bombs of the chunks around the plane (ChunkGameplay) are added
+	when it gets close and removed again behind it; coins collected there stay collected when
+	their chunk comes back.
+	Runs on the simulation thread, the renderer only ever sees it through WorldSnapshot.
+	Fully deterministic: the same seed and the same per-tick inputs give the same session.
+*/
+class Simulation {
+
+public:
+    // game tick length in seconds (60 Hz)
+    static constexpr float TICK_DT = 1.0f / 60.0f;
+    // most ticks run to catch up in one go, the rest of a longer stall is dropped
+    static const int MAX_CATCHUP_TICKS = 5;
+
+    // gameplay rates per second (tuned when the game ran one fixed 0.016 s tick per frame)
+    static constexpr float SPEED_SCALE = 0.06f; // MovementSpeed -> units per second
+    static constexpr float TRACKING_TURN_RATE = 120.0f; // degrees per second per unit of normalized tracking offset
+    static constexpr float COIN_COOLDOWN = 10.0f; // seconds until a collected coin comes back
+    static constexpr float COIN_SPIN = 60.0f; // degrees per second
+    static constexpr float ROTOR_SPIN = 1500.0f; // degrees per second
+    static constexpr float FLAME_RATE = 1.8f; // particle lifecycle per second
+
+    // collision sizes (the plane is a point at its nose)
+    static constexpr float COIN_RADIUS = 0.5f;
+    static constexpr float BOMB_RADIUS = 0.6f;
+    static constexpr float PLANE_RADIUS = 0.05f; // swept against the level geometry
+
+    // chunks with gameplay objects around the plane, ones further than this + 1 are dropped
+    static const int ACTIVE_CHUNK_RADIUS = 2;
+
+    // plane(position/front/yaw/pitch)
+    Plane plane = Plane(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, 0.0f);
+    Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, 0.0f);
+    int activeView = 1;
+    int score = 0;
+    Game_Over game_over = GAME_RUNNING;
+    unsigned long long tick = 0;
+    unsigned int seed;
+
+    // wall time of the collision part of the last tick (measured only, not game state)
+    double collision_seconds = 0.0;
+
+    // all random placement comes from one generator seeded here
+    // terrain: level geometry (LoadTerrain), nullptr = none (the heightmap ground is always there);
+    // not owned, shared by sessions
+    Simulation(unsigned int seed, const TriangleBVH* terrain = nullptr);
+
+    // where the wooden map sits in the world (rendering uses the same transform)
+    static glm::mat4 WoodenMapTransform();
+
+    // collision geometry of the level on top of the ground: the wooden map, built into a BVH
+    static bool LoadTerrain(TriangleBVH& terrain);
+
+    // advances the game by one fixed step of dt seconds
+    void Tick(const InputState& input, float dt);
+
+    // copies the current state for the renderer
+    void WriteSnapshot(WorldSnapshot& snapshot) const;
+
+    // level geometry of this session, nullptr = none
+    const TriangleBVH* Terrain() const { return terrain; }
+    // height of the heightmap ground of this session's world (Terrain.h)
+    float GroundHeight(float x, float z) const { return TerrainHeight(seed, x, z); }
+
+    // hash of the whole game state, equal hashes after a replay = bit-exact replay
+    unsigned long long StateHash() const;
+
+private:
+    Random random;
+    const TriangleBVH* terrain;
+
+    // world objects, one EntityPool per kind, components by enum
+    // collider = CollisionWorld handle, the collision id is the entity slot
+
+    //coins (positions right,up,backward)
+    // timer = cooldown left in seconds, respawns = comes back somewhere in the home field once collected
+    enum { COIN_POSITION, COIN_ANGLE, COIN_TIMER, COIN_COLLIDER, COIN_RESPAWNS };
+    EntityPool<glm::vec3, float, float, int, char> coins;
+    float coin_angle = 0.0f;
+    float rotor_angle = 0.0f;
+
+    enum { BOMB_POSITION, BOMB_COLLIDER };
+    EntityPool<glm::vec3, int> bombs;
+    int score_bombs = 0; // spawned for the score so far
+
+    // chunks whose coins and bombs are in the world
+    // coins[i] = coin i of ChunkGameplay, a dead handle once it's collected
+    struct ActiveChunk {
+        ChunkCoord coord;
+        std::vector<EntityHandle> coins;
+        std::vector<EntityHandle> bombs;
+    };
+    std::vector<ActiveChunk> active_chunks;
+    // ChunkCoord::Key() -> bit i = coin i collected, for good (ordered, so StateHash sees it the same way every run)
+    std::map<uint64_t, uint32_t> collected_coins;
+    ChunkCoord chunk_center;
+    std::vector<glm::vec3> chunk_coins, chunk_bombs; // ChunkGameplay output
+
+    //flame particles
+    enum { FLAME_FORWARD, FLAME_LIFECYCLE, FLAME_LIFESPAN };
+    EntityPool<glm::vec3, float, float> flames;
+    // particles respawning this tick and their new values, drawn in batches (reserved for all of them)
+    std::vector<uint32_t> flame_respawns;
+    std::vector<glm::vec3> flame_forward;
+    std::vector<float> flame_lifecycle, flame_lifespan;
+
+    // coins and bombs as spheres, the plane nose is swept against them every tick
+    CollisionWorld collision;
+    std::vector<CollisionHit> hits;
+
+    // state before the last tick (for render interpolation)
+    PlaneState previous_plane;
+    float previous_rotor_angle = 0.0f;
+    float previous_coin_angle = 0.0f;
+    glm::vec3 previous_camera_position;
+
+    // input totals seen by the last tick
+    glm::vec2 last_mouse_total = glm::vec2(0.0f, 0.0f);
+    float last_scroll_total = 0.0f;
+
+    EntityHandle addCoin(const glm::vec3& position, bool respawns);
+    EntityHandle addBomb(const glm::vec3& position);
+    void spawnCoin(const glm::vec3& min, const glm::vec3& max);
+    void spawnBomb();
+    void streamChunks(bool force);
+    void collectChunkCoin(EntityHandle coin);
+    void respawnFlames();
+    void collide();
+    glm::vec3 spawnPoint(const glm::vec3& min, const glm::vec3& max, float radius);
+    PlaneState planeState() const;
+
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <GL/glew.h> // GLEW provides efficient run-time mechanisms for determining which OpenGL extensions are supported on the target platform.
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <string>
+#include "ShaderProgram.h"
+
+/*
+	Sky pass: cubemap sampled on a unit cube around the camera.
+	Drawn last with depth func GL_LEQUAL and z forced to the far plane (xyww),
+	so only pixels not covered by opaque geometry get shaded - and unlit.
+*/
+class Skybox {
+
+public:
+    // bakes the cubemap from the given texture (same image on all six faces)
+    Skybox(const std::string& texturePath);
+    ~Skybox();
+
+    // view translation is stripped, so the sky stays centered on the camera
+    void Draw(ShaderProgram& shader, glm::mat4 view, glm::mat4 projection);
+
+private:
+    //  render data
+    unsigned int VAO, VBO;
+    unsigned int cubemapID;
+
+    void setupCube();
+    unsigned int CubemapFromFile(const std::string& path);
+
+};
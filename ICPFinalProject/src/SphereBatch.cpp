@@ -0,0 +1,227 @@
+#include "SphereBatch.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SPHERE_BATCH_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define SPHERE_BATCH_X86 0
+#endif
+
+// MSVC compiles any intrinsic as is, GCC / Clang need the instruction set enabled per function
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)
+#endif
+
+
+typedef void (*SphereKernelFn)(const float* x, const float* y, const float* z, const float* r, size_t blocks,
+    float cx, float cy, float cz, float probe, uint64_t* mask);
+
+// whole 64 candidate blocks are done by the selected kernel, the rest always by this one
+static void scalarRange(const float* x, const float* y, const float* z, const float* r, size_t begin, size_t end,
+    float cx, float cy, float cz, float probe, uint64_t* mask)
+{
+    for (size_t i = begin; i < end; i++) {
+        float dx = x[i] - cx;
+        float dy = y[i] - cy;
+        float dz = z[i] - cz;
+        float reach = r[i] + probe;
+        if (dx * dx + dy * dy + dz * dz <= reach * reach)
+            mask[i / 64] |= 1ULL << (i % 64);
+    }
+}
+
+static void scalarKernel(const float* x, const float* y, const float* z, const float* r, size_t blocks,
+    float cx, float cy, float cz, float probe, uint64_t* mask)
+{
+    for (size_t b = 0; b < blocks; b++)
+        mask[b] = 0;
+    scalarRange(x, y, z, r, 0, blocks * 64, cx, cy, cz, probe, mask);
+}
+
+#if SPHERE_BATCH_X86
+
+SIMD_TARGET("sse2")
+static void sseKernel(const float* x, const float* y, const float* z, const float* r, size_t blocks,
+    float cx, float cy, float cz, float probe, uint64_t* mask)
+{
+    __m128 vcx = _mm_set1_ps(cx), vcy = _mm_set1_ps(cy), vcz = _mm_set1_ps(cz), vprobe = _mm_set1_ps(probe);
+    for (size_t b = 0; b < blocks; b++) {
+        uint64_t bits = 0;
+        for (int j = 0; j < 64; j += 4) {
+            size_t i = b * 64 + j;
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), vcx);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), vcy);
+            __m128 dz = _mm_sub_ps(_mm_loadu_ps(z + i), vcz);
+            __m128 reach = _mm_add_ps(_mm_loadu_ps(r + i), vprobe);
+            __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            __m128 hit = _mm_cmple_ps(d2, _mm_mul_ps(reach, reach));
+            bits |= (uint64_t)_mm_movemask_ps(hit) << j;
+        }
+        mask[b] = bits;
+    }
+}
+
+SIMD_TARGET("avx2")
+static void avx2Kernel(const float* x, const float* y, const float* z, const float* r, size_t blocks,
+    float cx, float cy, float cz, float probe, uint64_t* mask)
+{
+    __m256 vcx = _mm256_set1_ps(cx), vcy = _mm256_set1_ps(cy), vcz = _mm256_set1_ps(cz), vprobe = _mm256_set1_ps(probe);
+    for (size_t b = 0; b < blocks; b++) {
+        uint64_t bits = 0;
+        for (int j = 0; j < 64; j += 8) {
+            size_t i = b * 64 + j;
+            __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), vcx);
+            __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), vcy);
+            __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z + i), vcz);
+            __m256 reach = _mm256_add_ps(_mm256_loadu_ps(r + i), vprobe);
+            // mul + add instead of FMA so the bits match the scalar kernel exactly
+            __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+            __m256 hit = _mm256_cmp_ps(d2, _mm256_mul_ps(reach, reach), _CMP_LE_OQ);
+            bits |= (uint64_t)_mm256_movemask_ps(hit) << j;
+        }
+        mask[b] = bits;
+    }
+}
+
+SIMD_TARGET("avx512f")
+static void avx512Kernel(const float* x, const float* y, const float* z, const float* r, size_t blocks,
+    float cx, float cy, float cz, float probe, uint64_t* mask)
+{
+    __m512 vcx = _mm512_set1_ps(cx), vcy = _mm512_set1_ps(cy), vcz = _mm512_set1_ps(cz), vprobe = _mm512_set1_ps(probe);
+    for (size_t b = 0; b < blocks; b++) {
+        uint64_t bits = 0;
+        for (int j = 0; j < 64; j += 16) {
+            size_t i = b * 64 + j;
+            __m512 dx = _mm512_sub_ps(_mm512_loadu_ps(x + i), vcx);
+            __m512 dy = _mm512_sub_ps(_mm512_loadu_ps(y + i), vcy);
+            __m512 dz = _mm512_sub_ps(_mm512_loadu_ps(z + i), vcz);
+            __m512 reach = _mm512_add_ps(_mm512_loadu_ps(r + i), vprobe);
+            __m512 d2 = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)), _mm512_mul_ps(dz, dz));
+            __mmask16 hit = _mm512_cmp_ps_mask(d2, _mm512_mul_ps(reach, reach), _CMP_LE_OQ);
+            bits |= (uint64_t)hit << j;
+        }
+        mask[b] = bits;
+    }
+}
+
+#endif
+
+Simd_Level DetectSimdLevel()
+{
+#if SPHERE_BATCH_X86
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    // the OS has to save the wide registers on context switches
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool avxState = (xcr0 & 0x6) == 0x6;
+    bool avx512State = (xcr0 & 0xE6) == 0xE6;
+    bool avx2 = false, avx512f = false;
+    if (maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+        avx512f = (info[1] & (1 << 16)) != 0;
+    }
+    if (avx512f && avx512State)
+        return SIMD_AVX512;
+    if (avx && avx2 && avxState)
+        return SIMD_AVX2;
+    if (sse2)
+        return SIMD_SSE;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SIMD_SSE;
+#endif
+#endif
+    return SIMD_SCALAR;
+}
+
+const char* SimdLevelName(Simd_Level level)
+{
+    switch (level) {
+    case SIMD_SSE: return "SSE";
+    case SIMD_AVX2: return "AVX2";
+    case SIMD_AVX512: return "AVX-512";
+    default: return "scalar";
+    }
+}
+
+struct KernelChoice {
+    Simd_Level level;
+    SphereKernelFn kernel;
+};
+
+static KernelChoice chooseKernel(Simd_Level level)
+{
+    Simd_Level supported = DetectSimdLevel();
+    if (level > supported)
+        level = supported;
+
+    KernelChoice choice = { level, scalarKernel };
+#if SPHERE_BATCH_X86
+    if (level == SIMD_SSE)
+        choice.kernel = sseKernel;
+    else if (level == SIMD_AVX2)
+        choice.kernel = avx2Kernel;
+    else if (level == SIMD_AVX512)
+        choice.kernel = avx512Kernel;
+#endif
+    return choice;
+}
+
+// the best kernel, picked by the first caller; a function-local static is initialized once
+// even when several simulation threads query at the same time
+static KernelChoice& selectedKernel()
+{
+    static KernelChoice choice = chooseKernel(SIMD_AVX512);
+    return choice;
+}
+
+void SetSphereKernel(Simd_Level level)
+{
+    selectedKernel() = chooseKernel(level);
+}
+
+Simd_Level SphereKernel()
+{
+    return selectedKernel().level;
+}
+
+static int countBits(uint64_t v)
+{
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((v * 0x0101010101010101ULL) >> 56);
+}
+
+int SphereOverlapMask(const float* x, const float* y, const float* z, const float* radius, size_t count,
+    const glm::vec3& center, float probeRadius, uint64_t* mask)
+{
+    size_t blocks = count / 64;
+    selectedKernel().kernel(x, y, z, radius, blocks, center.x, center.y, center.z, probeRadius, mask);
+    if (count % 64) {
+        mask[blocks] = 0;
+        scalarRange(x, y, z, radius, blocks * 64, count, center.x, center.y, center.z, probeRadius, mask);
+    }
+
+    int hits = 0;
+    for (size_t w = 0; w < (count + 63) / 64; w++)
+        hits += countBits(mask[w]);
+    return hits;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*
+	Batch sphere-vs-sphere overlap test: one probe sphere against many candidates stored as
+	structure-of-arrays floats. Kernels: scalar, SSE (4 per instruction), AVX2 (8), AVX-512 (16),
+	the best one the CPU supports is picked at runtime (x86 only, scalar everywhere else).
+
+	Result is a hit bitmask: bit i of mask[i / 64] = candidate i overlaps the probe
+	(squared center distance <= (r_i + probe radius)^2). All kernels give identical bits.
+*/
+
+enum Simd_Level {
+    SIMD_SCALAR,
+    SIMD_SSE,
+    SIMD_AVX2,
+    SIMD_AVX512
+};
+
+// candidate spheres, one array per component
+struct SphereSoA {
+    std::vector<float> x, y, z, radius;
+
+    size_t Size() const { return x.size(); }
+
+    void Push(const glm::vec3& center, float r)
+    {
+        x.push_back(center.x);
+        y.push_back(center.y);
+        z.push_back(center.z);
+        radius.push_back(r);
+    }
+
+    void Set(size_t i, const glm::vec3& center)
+    {
+        x[i] = center.x;
+        y[i] = center.y;
+        z[i] = center.z;
+    }
+
+    glm::vec3 Center(size_t i) const { return glm::vec3(x[i], y[i], z[i]); }
+
+    void Clear()
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+        radius.clear();
+    }
+};
+
+// best kernel this CPU (and OS) can run
+Simd_Level DetectSimdLevel();
+const char* SimdLevelName(Simd_Level level);
+
+// kernel used by SphereOverlapMask, defaults to DetectSimdLevel(); levels the CPU can't run are lowered.
+// SetSphereKernel isn't synchronized: benchmarks call it while no other thread is querying
+void SetSphereKernel(Simd_Level level);
+Simd_Level SphereKernel();
+
+// tests candidates [0, count), mask needs (count + 63) / 64 words, returns the number of hits
+int SphereOverlapMask(const float* x, const float* y, const float* z, const float* radius, size_t count,
+    const glm::vec3& center, float probeRadius, uint64_t* mask);
+
+// calls f(i) for every set bit of the mask, in increasing order
+template <typename F>
+inline void ForEachHit(const uint64_t* mask, size_t count, F f)
+{
+    // index of the lowest set bit via a de Bruijn sequence (no compiler specific intrinsics)
+    static const int debruijn[64] = {
+        0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4, 62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11, 46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+    };
+    for (size_t w = 0; w < (count + 63) / 64; w++) {
+        for (uint64_t bits = mask[w]; bits != 0; bits &= bits - 1)
+            f(w * 64 + debruijn[((bits & (0 - bits)) * 0x03F79D71B4CB0A89ULL) >> 58]);
+    }
+}
+
+inline int SphereOverlapMask(const SphereSoA& spheres, const glm::vec3& center, float probeRadius, uint64_t* mask)
+{
+    return SphereOverlapMask(spheres.x.data(), spheres.y.data(), spheres.z.data(), spheres.radius.data(),
+        spheres.Size(), center, probeRadius, mask);
+}
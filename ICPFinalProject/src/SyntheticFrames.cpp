@@ -0,0 +1,46 @@
+#include <cmath>
+#include <algorithm>
+
+#include "SyntheticFrames.h"
+
+SyntheticFrames::SyntheticFrames(int width, int height, uint64_t seed)
+    : width(width), height(height), random(seed, 2) // stream 2: not the simulation's numbers
+{
+}
+
+glm::vec2 SyntheticFrames::BallAt(double time)
+{
+    return glm::vec2(0.5f + 0.3f * (float)std::sin(time * 1.1) + 0.05f * (float)std::sin(time * 4.7),
+        0.5f + 0.25f * (float)std::sin(time * 0.8 + 1.0));
+}
+
+glm::vec2 SyntheticFrames::Render(uint8_t* bgr, size_t stride, double time)
+{
+    glm::vec2 ball = BallAt(time);
+    float cx = ball.x * width, cy = ball.y * height;
+    float r = radius * height;
+    int y0 = std::max(0, (int)(cy - r)), y1 = std::min(height, (int)(cy + r) + 1);
+
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = bgr + y * stride;
+        // background: a vertical grey gradient with grey noise
+        int base = 70 + 60 * y / height;
+        for (int x = 0; x < width; x++) {
+            uint8_t grey = (uint8_t)(base + (random.Next() & 15));
+            row[x * 3] = row[x * 3 + 1] = row[x * 3 + 2] = grey;
+        }
+        if (y < y0 || y >= y1)
+            continue;
+
+        float dy = y + 0.5f - cy;
+        float half = std::sqrt(std::max(0.0f, r * r - dy * dy));
+        int x0 = std::max(0, (int)std::ceil(cx - half - 0.5f)), x1 = std::min(width, (int)std::floor(cx + half - 0.5f) + 1);
+        for (int x = x0; x < x1; x++) {
+            uint32_t noise = random.Next();
+            row[x * 3] = (uint8_t)(54 + (noise & 15));
+            row[x * 3 + 1] = (uint8_t)(14 + ((noise >> 4) & 15));
+            row[x * 3 + 2] = (uint8_t)(222 + ((noise >> 8) & 15));
+        }
+    }
+    return ball;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <cstdint>
+#include <cstddef>
+
+#include "Random.h"
+
+/*
+	Camera stand-in for tests and benchmarks: BGR frames of a red ball (inside the game's tracking
+	thresholds) moving over a noisy grey background, with the true ball position known.
+
+	- the background is grey (saturation 0), it never passes the colour threshold
+	- the ball follows a smooth closed path over the frame, BallAt(time)
+	- noise comes from a seeded Random, the same seed and times give the same frames
+*/
+class SyntheticFrames {
+
+public:
+    SyntheticFrames(int width, int height, uint64_t seed = 1);
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+
+    // draws the frame at the given time (seconds) into bgr (stride bytes per row),
+    // returns the true centre of the ball normalized to the frame
+    glm::vec2 Render(uint8_t* bgr, size_t stride, double time);
+
+    // centre of the ball at a time, normalized
+    static glm::vec2 BallAt(double time);
+
+    float radius = 0.06f; // of the frame height
+
+private:
+    int width, height;
+    Random random;
+
+};
@@ -0,0 +1,225 @@
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <algorithm>
+#include <cmath>
+
+#include "Terrain.h"
+
+static const float TERRAIN_MAX_HEIGHT = 12.0f;
+static const int OCTAVES = 4;
+static const int FIRST_CELL = 64; // texels per noise cell of the first octave (128 units)
+
+
+// random 0..1 of a lattice point of one octave
+static float lattice(unsigned int seed, int octave, int x, int z)
+{
+    uint32_t h = seed * 0x9E3779B1u ^ (uint32_t)octave * 0x85EBCA77u ^ (uint32_t)x * 0xC2B2AE3Du ^ (uint32_t)z * 0x27D4EB2Fu;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    h *= 0x297A2D39u;
+    h ^= h >> 15;
+    return (h >> 8) * (1.0f / 16777216.0f);
+}
+
+static int wrap(int i, int size)
+{
+    i %= size;
+    return i < 0 ? i + size : i;
+}
+
+float TerrainTexel(unsigned int seed, int i, int j)
+{
+    i = wrap(i, HEIGHTMAP_SIZE);
+    j = wrap(j, HEIGHTMAP_SIZE);
+
+    // value noise octaves, every lattice repeats with the heightmap
+    float sum = 0.0f, total = 0.0f, amplitude = 1.0f;
+    for (int octave = 0; octave < OCTAVES; octave++) {
+        int cell = FIRST_CELL >> octave;
+        int points = HEIGHTMAP_SIZE / cell;
+        int x = i / cell, z = j / cell;
+        float fx = (float)(i % cell) / cell, fz = (float)(j % cell) / cell;
+        fx = fx * fx * (3.0f - 2.0f * fx);
+        fz = fz * fz * (3.0f - 2.0f * fz);
+        int x1 = (x + 1) % points, z1 = (z + 1) % points;
+        float a = glm::mix(lattice(seed, octave, x, z), lattice(seed, octave, x1, z), fx);
+        float b = glm::mix(lattice(seed, octave, x, z1), lattice(seed, octave, x1, z1), fx);
+        sum += glm::mix(a, b, fz) * amplitude;
+        total += amplitude;
+        amplitude *= 0.45f;
+    }
+    // low half is plains, the rest hills
+    float height = std::max(0.0f, sum / total - 0.4f) / 0.6f * TERRAIN_MAX_HEIGHT;
+
+    // flat around the home field (and its repeats)
+    float x = (i <= HEIGHTMAP_SIZE / 2 ? i : i - HEIGHTMAP_SIZE) * HEIGHTMAP_SPACING;
+    float z = (j <= HEIGHTMAP_SIZE / 2 ? j : j - HEIGHTMAP_SIZE) * HEIGHTMAP_SPACING;
+    float r = std::max(std::abs(x), std::abs(z));
+    return height * glm::smoothstep(15.0f, 45.0f, r);
+}
+
+float TerrainHeight(unsigned int seed, float x, float z)
+{
+    float fx = x / HEIGHTMAP_SPACING, fz = z / HEIGHTMAP_SPACING;
+    int i = (int)std::floor(fx), j = (int)std::floor(fz);
+    float tx = fx - i, tz = fz - j;
+    float a = glm::mix(TerrainTexel(seed, i, j), TerrainTexel(seed, i + 1, j), tx);
+    float b = glm::mix(TerrainTexel(seed, i, j + 1), TerrainTexel(seed, i + 1, j + 1), tx);
+    return glm::mix(a, b, tz);
+}
+
+void BuildHeightmap(unsigned int seed, std::vector<float>& texels)
+{
+    texels.resize(HEIGHTMAP_SIZE * HEIGHTMAP_SIZE);
+    for (int j = 0; j < HEIGHTMAP_SIZE; j++)
+        for (int i = 0; i < HEIGHTMAP_SIZE; i++)
+            texels[j * HEIGHTMAP_SIZE + i] = TerrainTexel(seed, i, j);
+}
+
+
+glm::vec2 TerrainPatch::Vertex(int gx, int gz) const
+{
+    // odd vertices on an edge next to a coarser patch move onto the even one before them,
+    // the edge then has exactly the coarser patch's vertices (the extra triangles are empty)
+    if (gz == 0 && (stitch & STITCH_NORTH))
+        gx -= gx % 2;
+    if (gx == PATCH_GRID && (stitch & STITCH_EAST))
+        gz -= gz % 2;
+    if (gz == PATCH_GRID && (stitch & STITCH_SOUTH))
+        gx -= gx % 2;
+    if (gx == 0 && (stitch & STITCH_WEST))
+        gz -= gz % 2;
+    return origin + glm::vec2((float)gx, (float)gz) * (size / PATCH_GRID);
+}
+
+void TerrainLod::mark(const Node& node)
+{
+    int s = span(node.level);
+    for (int z = node.z; z < node.z + s; z++)
+        for (int x = node.x; x < node.x + s; x++)
+            cells[z * CELLS + x] = (signed char)node.level;
+}
+
+int TerrainLod::cellLevel(int x, int z) const
+{
+    if (x < 0 || z < 0 || x >= CELLS || z >= CELLS)
+        return -1;
+    return cells[z * CELLS + x];
+}
+
+int TerrainLod::edgeLevel(const Node& node, int edge, bool finest) const
+{
+    int s = span(node.level);
+    int result = -1;
+    for (int k = 0; k < s; k++) {
+        int level;
+        switch (edge) {
+        case 0: level = cellLevel(node.x + k, node.z - 1); break;
+        case 1: level = cellLevel(node.x + s, node.z + k); break;
+        case 2: level = cellLevel(node.x + k, node.z + s); break;
+        default: level = cellLevel(node.x - 1, node.z + k); break;
+        }
+        if (level < 0)
+            continue;
+        if (result < 0 || (finest ? level > result : level < result))
+            result = level;
+    }
+    return result;
+}
+
+void TerrainLod::Select(const glm::vec3& eye, const glm::vec3& forward, std::vector<TerrainPatch>& patches)
+{
+    patches.clear();
+    leaves.clear();
+    work.clear();
+    cells.assign(CELLS * CELLS, -1);
+
+    // roots are world aligned, so nodes don't move with the eye (no swimming vertices)
+    const float cell = cellSize();
+    int rootX = (int)std::floor(eye.x / TERRAIN_ROOT_SIZE) - ROOTS / 2;
+    int rootZ = (int)std::floor(eye.z / TERRAIN_ROOT_SIZE) - ROOTS / 2;
+    corner = glm::vec2(rootX, rootZ) * TERRAIN_ROOT_SIZE;
+    glm::vec2 eye2 = glm::vec2(eye.x, eye.z);
+    for (int z = 0; z < ROOTS; z++)
+        for (int x = 0; x < ROOTS; x++)
+            work.push_back({ 0, x * span(0), z * span(0) });
+
+    while (!work.empty()) {
+        Node node = work.back();
+        work.pop_back();
+        float size = span(node.level) * cell;
+        glm::vec2 min = corner + glm::vec2(node.x, node.z) * cell;
+        glm::vec2 outside = glm::max(glm::max(min - eye2, eye2 - (min + size)), glm::vec2(0.0f));
+        float ground = glm::length(outside);
+        if (ground > view_distance)
+            continue;
+        float distance = std::sqrt(ground * ground + eye.y * eye.y);
+        if (node.level < TERRAIN_LEVELS - 1 && distance < size * split_factor) {
+            int half = span(node.level + 1);
+            work.push_back({ node.level + 1, node.x, node.z });
+            work.push_back({ node.level + 1, node.x + half, node.z });
+            work.push_back({ node.level + 1, node.x, node.z + half });
+            work.push_back({ node.level + 1, node.x + half, node.z + half });
+        }
+        else {
+            leaves.push_back(node);
+            mark(node);
+        }
+    }
+
+    // split leaves next to ones two or more levels finer until every neighbour is within one
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < leaves.size(); i++) {
+            Node node = leaves[i];
+            if (node.level == TERRAIN_LEVELS - 1)
+                continue;
+            bool split = false;
+            for (int edge = 0; edge < 4; edge++)
+                split = split || edgeLevel(node, edge, true) > node.level + 1;
+            if (!split)
+                continue;
+            int half = span(node.level + 1);
+            Node children[4] = {
+                { node.level + 1, node.x, node.z }, { node.level + 1, node.x + half, node.z },
+                { node.level + 1, node.x, node.z + half }, { node.level + 1, node.x + half, node.z + half }
+            };
+            leaves[i] = children[0];
+            for (int c = 0; c < 4; c++) {
+                if (c > 0)
+                    leaves.push_back(children[c]);
+                mark(children[c]);
+            }
+            changed = true;
+        }
+    }
+
+    // patches in front of the eye (xz cone with the node's radius as margin)
+    glm::vec2 ahead = glm::vec2(forward.x, forward.z);
+    float length = glm::length(ahead);
+    float cone_cos = length < 0.3f ? -2.0f : std::cos(glm::radians(60.0f));
+    ahead = length < 0.3f ? glm::vec2(0.0f) : ahead / length;
+    for (const Node& node : leaves) {
+        float size = span(node.level) * cell;
+        glm::vec2 min = corner + glm::vec2(node.x, node.z) * cell;
+        glm::vec2 d = min + size * 0.5f - eye2;
+        float radius = size * 0.70711f;
+        float distance = glm::length(d);
+        if (distance > radius && glm::dot(d, ahead) < distance * cone_cos - radius)
+            continue;
+
+        TerrainPatch patch;
+        patch.origin = min;
+        patch.size = size;
+        patch.level = node.level;
+        patch.stitch = 0;
+        for (int edge = 0; edge < 4; edge++) {
+            int coarsest = edgeLevel(node, edge, false);
+            if (coarsest >= 0 && coarsest < node.level)
+                patch.stitch |= 1u << edge;
+        }
+        patches.push_back(patch);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <vector>
+#include <cstdint>
+
+/*
+	Heightmap ground of the open world.
+
+	Heights are a HEIGHTMAP_SIZE x HEIGHTMAP_SIZE grid of texels HEIGHTMAP_SPACING apart, a pure
+	function of (seed, texel) that repeats every HEIGHTMAP_SIZE texels. The renderer uploads the
+	grid as a texture once and reads it in the vertex shader; TerrainHeight interpolates the same
+	texels the same way, so collision matches what is drawn. The home field stays flat at 0.
+
+	TerrainLod picks which parts of the ground are drawn how finely: a quadtree over world aligned
+	roots of TERRAIN_ROOT_SIZE, nodes split while the eye is close to them. Every leaf is the same
+	PATCH_GRID x PATCH_GRID patch scaled to the node, so the vertices per frame depend on the view
+	distance, not on the size of the world. Neighbouring leaves differ by one level at most and
+	the finer one folds its odd edge vertices onto the coarser edge (no cracks).
+*/
+
+const int HEIGHTMAP_SIZE = 512;
+const float HEIGHTMAP_SPACING = 2.0f;
+const float TERRAIN_PERIOD = HEIGHTMAP_SIZE * HEIGHTMAP_SPACING;
+const float TERRAIN_ROOT_SIZE = 256.0f;
+const int TERRAIN_LEVELS = 4;   // root, 1/2, 1/4, 1/8 (32 units, one quad per texel)
+const int PATCH_GRID = 16;      // quads per patch side
+
+// height of texel (i, j), any integers (wraps around)
+float TerrainTexel(unsigned int seed, int i, int j);
+// ground height at a point, bilinear between the texels
+float TerrainHeight(unsigned int seed, float x, float z);
+// all texels, row by row (j * HEIGHTMAP_SIZE + i), texel (i, j) sits at (i, j) * HEIGHTMAP_SPACING
+void BuildHeightmap(unsigned int seed, std::vector<float>& texels);
+
+// edges of a patch whose neighbour is one level coarser
+enum Patch_Stitch {
+    STITCH_NORTH = 1, // -z
+    STITCH_EAST = 2,  // +x
+    STITCH_SOUTH = 4, // +z
+    STITCH_WEST = 8   // -x
+};
+
+struct TerrainPatch {
+    glm::vec2 origin; // x, z of the corner with the smallest coordinates
+    float size;
+    int level;
+    unsigned int stitch; // Patch_Stitch bits
+
+    // xz of grid vertex (gx, gz) after stitching, the same as terrain.vert does it
+    glm::vec2 Vertex(int gx, int gz) const;
+};
+
+class TerrainLod {
+
+public:
+    float view_distance = 100.0f; // far plane of the game's projection
+    float split_factor = 2.0f;    // split a node while the eye is closer than size * split_factor
+
+    // leaves of the quadtree around the eye, the ones in front of it go to patches
+    void Select(const glm::vec3& eye, const glm::vec3& forward, std::vector<TerrainPatch>& patches);
+
+    // of the last Select
+    size_t Leaves() const { return leaves.size(); }
+
+private:
+    static const int ROOTS = 3;  // per side, around the root under the eye
+    static const int CELLS = ROOTS << (TERRAIN_LEVELS - 1); // finest nodes per side of the area
+
+    struct Node {
+        int level, x, z; // x, z in finest cells from the area corner
+    };
+
+    glm::vec2 corner;
+    std::vector<signed char> cells; // level of the leaf covering each finest cell, -1 = none
+    std::vector<Node> leaves;
+    std::vector<Node> work;
+
+    static int span(int level) { return 1 << (TERRAIN_LEVELS - 1 - level); } // in finest cells
+    float cellSize() const { return TERRAIN_ROOT_SIZE / span(0); }
+    void mark(const Node& node);
+    int cellLevel(int x, int z) const;
+    // finest level of the leaves just outside one edge
+    int edgeLevel(const Node& node, int edge, bool finest) const;
+
+};
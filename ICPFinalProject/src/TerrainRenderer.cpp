@@ -0,0 +1,114 @@
+#include <GL/glew.h> // GLEW provides efficient run-time mechanisms for determining which OpenGL extensions are supported on the target platform.
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <iostream>
+
+#include "TerrainRenderer.h"
+#include "ChunkStreamer.h"
+#include "Timing.h"
+#include "RenderStats.h"
+#include "TextureLoader.h"
+
+
+TerrainRenderer::TerrainRenderer(unsigned int seed)
+{
+    double start = NowSeconds();
+    std::vector<float> texels;
+    BuildHeightmap(seed, texels);
+    glGenTextures(1, &heightmapTexture);
+    glBindTexture(GL_TEXTURE_2D, heightmapTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, HEIGHTMAP_SIZE, HEIGHTMAP_SIZE, 0, GL_RED, GL_FLOAT, texels.data());
+    // read with texelFetch only, the shader interpolates like TerrainHeight
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    std::cout << "Heightmap " << HEIGHTMAP_SIZE << " x " << HEIGHTMAP_SIZE << " built in " << (NowSeconds() - start) * 1000.0 << " ms" << std::endl;
+
+    // the one patch: grid coordinates 0 .. PATCH_GRID
+    std::vector<glm::vec2> grid;
+    std::vector<unsigned int> indices;
+    for (int z = 0; z <= PATCH_GRID; z++)
+        for (int x = 0; x <= PATCH_GRID; x++)
+            grid.push_back(glm::vec2((float)x, (float)z));
+    for (int z = 0; z < PATCH_GRID; z++) {
+        for (int x = 0; x < PATCH_GRID; x++) {
+            unsigned int a = z * (PATCH_GRID + 1) + x;
+            unsigned int b = a + 1;
+            unsigned int c = a + PATCH_GRID + 1;
+            unsigned int d = c + 1;
+            indices.insert(indices.end(), { a, c, b, b, c, d });
+        }
+    }
+    indexCount = (unsigned int)indices.size();
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glGenBuffers(1, &patchVBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, grid.size() * sizeof(glm::vec2), grid.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+    // location 3: one patch per instance
+    glBindBuffer(GL_ARRAY_BUFFER, patchVBO);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+    glVertexAttribDivisor(3, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    groundTexture = LoadTexture2D("resources/objects/ground/GroundColor.png");
+}
+
+void TerrainRenderer::Draw(ShaderProgram& shader, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eye, const glm::vec3& forward)
+{
+    lod.Select(eye, forward, patches);
+    if (patches.empty())
+        return;
+
+    instances.clear();
+    for (const TerrainPatch& patch : patches)
+        instances.push_back(glm::vec4(patch.origin.x, patch.origin.y, patch.size, (float)patch.stitch));
+    glBindBuffer(GL_ARRAY_BUFFER, patchVBO);
+    if (instances.size() > patchCapacity)
+        patchCapacity = instances.size() + instances.size() / 2;
+    glBufferData(GL_ARRAY_BUFFER, patchCapacity * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW); // orphan
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(glm::vec4), instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    shader.use();
+    shader.setMat4("view", view);
+    shader.setMat4("projection", projection);
+    shader.setInt("heightmap", 1);
+    shader.setInt("heightmapSize", HEIGHTMAP_SIZE);
+    shader.setFloat("spacing", HEIGHTMAP_SPACING);
+    shader.setInt("patchGrid", PATCH_GRID);
+    shader.setFloat("groundRepeat", CHUNK_SIZE); // the ground texture once per chunk, as before
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, groundTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, heightmapTexture);
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, (GLsizei)instances.size());
+    glBindVertexArray(0);
+    FrameRenderStats().Add(1, indexCount / 3 * instances.size());
+    glActiveTexture(GL_TEXTURE0);
+}
+
+size_t TerrainRenderer::GpuBytes() const
+{
+    return HEIGHTMAP_SIZE * HEIGHTMAP_SIZE * sizeof(float) + (PATCH_GRID + 1) * (PATCH_GRID + 1) * sizeof(glm::vec2)
+        + indexCount * sizeof(unsigned int) + patchCapacity * sizeof(glm::vec4);
+}
+
+// destructor
+TerrainRenderer::~TerrainRenderer()
+{
+    glDeleteVertexArrays(1, &VAO);
+    unsigned int buffers[3] = { VBO, EBO, patchVBO };
+    glDeleteBuffers(3, buffers);
+    glDeleteTextures(1, &heightmapTexture);
+    glDeleteTextures(1, &groundTexture);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <GL/glew.h> // GLEW provides efficient run-time mechanisms for determining which OpenGL extensions are supported on the target platform.
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <string>
+#include <vector>
+
+#include "ShaderProgram.h"
+#include "Terrain.h"
+
+/*
+	Draws the heightmap ground: the heights go to a float texture once, every frame TerrainLod
+	picks the patches and all of them are one instanced draw of a single PATCH_GRID x PATCH_GRID
+	grid (terrain.vert places, stitches and lifts the vertices). Lit by fragment_shader.frag
+	like everything else.
+*/
+class TerrainRenderer {
+
+public:
+    // needs a current OpenGL context
+    TerrainRenderer(unsigned int seed);
+    ~TerrainRenderer();
+
+    // shader: terrain.vert + fragment_shader.frag with the lights already set
+    void Draw(ShaderProgram& shader, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eye, const glm::vec3& forward);
+
+    TerrainLod lod;
+
+    // metrics of the last Draw
+    size_t Patches() const { return patches.size(); }
+    size_t Vertices() const { return patches.size() * (PATCH_GRID + 1) * (PATCH_GRID + 1); }
+    size_t GpuBytes() const;
+
+private:
+    unsigned int VAO, VBO, EBO, patchVBO;
+    unsigned int heightmapTexture, groundTexture;
+    unsigned int indexCount = 0;
+    size_t patchCapacity = 0;
+    std::vector<TerrainPatch> patches;
+    std::vector<glm::vec4> instances; // corner x, z, size, stitch bits
+
+
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <string>
+
+// 2D texture from an image file (stb_image): 1 / 3 / 4 channels as RED / RGB / RGBA, mipmapped,
+// repeating; gamma = colour data in sRGB (the GPU linearizes it when sampling)
+// needs a current OpenGL context; on failure the message is printed and the texture stays empty
+unsigned int LoadTexture2D(const std::string& path, bool gamma = false);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+// seconds on a monotonic clock shared by all threads (the render, simulation and detection loops)
+inline double NowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// sleeps until the given NowSeconds() time
+// coarse sleeps first (OS timer granularity can be ~1-15 ms), the last 2 ms are yielded away
+inline void SleepUntil(double time)
+{
+    for (;;) {
+        double remaining = time - NowSeconds();
+        if (remaining <= 0.0)
+            return;
+        if (remaining > 0.002)
+            std::this_thread::sleep_for(std::chrono::duration<double>(remaining - 0.002));
+        else
+            std::this_thread::yield();
+    }
+}
+
+// per-second timing statistics of one loop (frame or tick durations)
+struct TimingStats {
+    // values of the last finished one second window
+    float rate = 0.0f; // samples per second
+    float avg_ms = 0.0f;
+    float max_ms = 0.0f;
+
+    // add one sample, returns true when a new window was finished (every second)
+    bool AddSample(double ms, double now)
+    {
+        if (window_start == 0.0)
+            window_start = now;
+        count++;
+        sum_ms += ms;
+        if (ms > window_max_ms)
+            window_max_ms = ms;
+
+        double elapsed = now - window_start;
+        if (elapsed < 1.0)
+            return false;
+
+        rate = (float)(count / elapsed);
+        avg_ms = (float)(sum_ms / count);
+        max_ms = (float)window_max_ms;
+        count = 0;
+        sum_ms = 0.0;
+        window_max_ms = 0.0;
+        window_start = now;
+        return true;
+    }
+
+private:
+    double window_start = 0.0;
+    unsigned int count = 0;
+    double sum_ms = 0.0;
+    double window_max_ms = 0.0;
+};
+
+// CPU time the calling thread has used so far, in seconds (Timing.cpp)
+double ThreadCpuSeconds();
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Trace.h"
+
+std::atomic<bool> traceEnabled(false);
+
+enum Trace_Type : uint8_t { TRACE_COMPLETE, TRACE_COUNTER_VALUE };
+
+struct TraceEvent {
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> start_ns;
+    std::atomic<uint64_t> value; // duration in ns, or the bits of a counter's double
+    std::atomic<uint8_t> type;
+};
+
+// one thread's events, written by that thread only
+struct TraceRing {
+    static const uint64_t RING_EVENTS = 1 << 16;
+    TraceEvent events[RING_EVENTS];
+    std::atomic<uint64_t> written{ 0 };
+    std::atomic<const char*> name{ nullptr };
+    int tid = 0;
+};
+
+// rings outlive their threads, a trace written at exit still has the tracking threads in it
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<TraceRing>> registry;
+static thread_local TraceRing* threadRing = nullptr;
+
+static TraceRing& ring()
+{
+    if (!threadRing) {
+        auto created = std::make_unique<TraceRing>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        created->tid = (int)registry.size() + 1;
+        threadRing = created.get();
+        registry.push_back(std::move(created));
+    }
+    return *threadRing;
+}
+
+static void record(const char* name, uint64_t start_ns, uint64_t value, Trace_Type type)
+{
+    TraceRing& r = ring();
+    uint64_t index = r.written.load(std::memory_order_relaxed);
+    TraceEvent& event = r.events[index % TraceRing::RING_EVENTS];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start_ns.store(start_ns, std::memory_order_relaxed);
+    event.value.store(value, std::memory_order_relaxed);
+    event.type.store(type, std::memory_order_relaxed);
+    r.written.store(index + 1, std::memory_order_release);
+}
+
+// names are literals from the code, quotes and backslashes are all JSON needs escaped
+static void writeString(std::ofstream& out, const char* text)
+{
+    out << '"';
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+void TraceEnable(bool enable)
+{
+    traceEnabled.store(enable, std::memory_order_relaxed);
+}
+
+void TraceThreadName(const char* name)
+{
+    ring().name.store(name, std::memory_order_relaxed);
+}
+
+uint64_t TraceNowNs()
+{
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceComplete(const char* name, uint64_t start_ns, uint64_t end_ns)
+{
+    record(name, start_ns, end_ns - start_ns, TRACE_COMPLETE);
+}
+
+void TraceCounter(const char* name, double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    record(name, TraceNowNs(), bits, TRACE_COUNTER_VALUE);
+}
+
+bool TraceWrite(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    std::vector<TraceRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& r : registry)
+            rings.push_back(r.get());
+    }
+
+    // timestamps from the oldest event on, in microseconds with ns precision
+    uint64_t base = UINT64_MAX;
+    for (TraceRing* r : rings) {
+        uint64_t written = r->written.load(std::memory_order_acquire);
+        uint64_t first = written > TraceRing::RING_EVENTS ? written - TraceRing::RING_EVENTS : 0;
+        for (uint64_t i = first; i < written; i++)
+            base = std::min(base, r->events[i % TraceRing::RING_EVENTS].start_ns.load(std::memory_order_relaxed));
+    }
+    if (base == UINT64_MAX)
+        base = 0;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out.precision(3);
+    out << std::fixed;
+    bool first_event = true;
+    auto separator = [&]() {
+        if (!first_event)
+            out << ",\n";
+        first_event = false;
+    };
+    for (TraceRing* r : rings) {
+        const char* thread_name = r->name.load(std::memory_order_relaxed);
+        if (thread_name) {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r->tid << ",\"args\":{\"name\":";
+            writeString(out, thread_name);
+            out << "}}";
+        }
+
+        // the thread may be writing on: events it overwrote while they were read are dropped
+        uint64_t written = r->written.load(std::memory_order_acquire);
+        uint64_t begin = written > TraceRing::RING_EVENTS ? written - TraceRing::RING_EVENTS : 0;
+        for (uint64_t i = begin; i < written; i++) {
+            const TraceEvent& event = r->events[i % TraceRing::RING_EVENTS];
+            const char* name = event.name.load(std::memory_order_relaxed);
+            uint64_t start = event.start_ns.load(std::memory_order_relaxed);
+            uint64_t value = event.value.load(std::memory_order_relaxed);
+            uint8_t type = event.type.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (r->written.load(std::memory_order_relaxed) >= i + TraceRing::RING_EVENTS)
+                continue;
+            if (!name || start < base)
+                continue;
+
+            separator();
+            out << "{\"name\":";
+            writeString(out, name);
+            if (type == TRACE_COMPLETE) {
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << r->tid << ",\"ts\":" << (start - base) / 1000.0 << ",\"dur\":" << value / 1000.0 << '}';
+            }
+            else {
+                double counter;
+                std::memcpy(&counter, &value, sizeof(counter));
+                out << ",\"ph\":\"C\",\"pid\":1,\"tid\":" << r->tid << ",\"ts\":" << (start - base) / 1000.0 << ",\"args\":{\"value\":" << counter << "}}";
+            }
+        }
+    }
+    out << "\n]}\n";
+    return (bool)out;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+	Scoped CPU tracing of all threads, written out as Chrome Trace Event JSON (opens in
+	chrome://tracing and ui.perfetto.dev).
+
+	- TRACE_SCOPE("name") records the enclosing scope as one complete event, TRACE_COUNTER adds
+	  a counter sample; names must be string literals (only the pointer is stored)
+	- every thread writes into its own ring buffer of the last RING_EVENTS events: no locks, no
+	  allocations, nanosecond timestamps; the writer only ever stores relaxed atomics, so
+	  TraceWrite() can read the rings while the threads keep going
+	- off by default and switchable at runtime; while off a scope costs one relaxed load
+	- TraceThreadName() names the thread in the trace and creates its ring, call it when the
+	  thread starts (otherwise the first event creates the ring, an allocation on that thread)
+*/
+
+extern std::atomic<bool> traceEnabled;
+
+inline bool TraceEnabled() { return traceEnabled.load(std::memory_order_relaxed); }
+void TraceEnable(bool enable);
+
+void TraceThreadName(const char* name);
+// nanoseconds on the NowSeconds() clock
+uint64_t TraceNowNs();
+void TraceComplete(const char* name, uint64_t start_ns, uint64_t end_ns);
+void TraceCounter(const char* name, double value);
+
+// every thread's ring as Chrome Trace Event JSON, false if the file can't be written
+bool TraceWrite(const std::string& path);
+
+class TraceScope {
+
+public:
+    explicit TraceScope(const char* name)
+        : name(TraceEnabled() ? name : nullptr), start(this->name ? TraceNowNs() : 0) {}
+    ~TraceScope() { End(); }
+
+    // ends the event before the scope does
+    void End()
+    {
+        if (name)
+            TraceComplete(name, start, TraceNowNs());
+        name = nullptr;
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_COUNTER(name, value) do { if (TraceEnabled()) TraceCounter(name, (double)(value)); } while (0)
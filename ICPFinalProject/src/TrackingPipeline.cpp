@@ -0,0 +1,256 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+#include "TrackingPipeline.h"
+#include "AllocationCounter.h"
+#include "Trace.h"
+
+void TrackingPipeline::Start()
+{
+    stopping = false;
+    roi.Reset();
+    roi.range = range;
+    roi.settings.full_confidence = full_confidence;
+
+    // buffers 0, 2 and 4 start with the capture, process and preview stages, 1 and 3 in the slots
+    pool.Allocate(POOL_BUFFERS, source.Mode().width, source.Mode().height);
+    TrackingFrame spare;
+    spare.buffer = 1;
+    frames.Reset(spare);
+    spare.buffer = 3;
+    views.Reset(spare);
+    processed_frames = 0;
+    window_allocations = 0;
+    steady_allocations = 0;
+
+    capture_thread = std::thread(&TrackingPipeline::captureLoop, this);
+    process_thread = std::thread(&TrackingPipeline::processLoop, this);
+    if (preview != PREVIEW_OFF)
+        preview_thread = std::thread(&TrackingPipeline::previewLoop, this);
+}
+
+bool TrackingPipeline::PreviewFromName(const char* name, Preview_Mode& mode)
+{
+    if (std::strcmp(name, "off") == 0)
+        mode = PREVIEW_OFF;
+    else if (std::strcmp(name, "frame") == 0)
+        mode = PREVIEW_FRAME;
+    else if (std::strcmp(name, "mask") == 0)
+        mode = PREVIEW_MASK;
+    else
+        return false;
+    return true;
+}
+
+void TrackingPipeline::Finish()
+{
+    // the capture stage closes the frame slot at the end of the source, the process stage then ends
+    for (std::thread* stage : { &capture_thread, &process_thread }) {
+        if (stage->joinable())
+            stage->join();
+    }
+    Stop();
+}
+
+void TrackingPipeline::Stop()
+{
+    stopping = true;
+    frames.Close();
+    views.Close();
+    // Read() returns within a camera frame
+    for (std::thread* stage : { &capture_thread, &process_thread, &preview_thread }) {
+        if (stage->joinable())
+            stage->join();
+    }
+    source.Close();
+}
+
+TimingStats TrackingPipeline::Stats()
+{
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return stats;
+}
+
+TrackingLoad TrackingPipeline::Load()
+{
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return load;
+}
+
+void TrackingPipeline::captureLoop()
+{
+    TraceThreadName("tracking capture");
+    TrackingFrame frame;
+    frame.buffer = 0;
+    uint64_t index = 0;
+    while (!stopping) {
+        TRACE_SCOPE("capture");
+        uint64_t allocations = ThreadAllocations();
+        // a camera that stops giving frames ends the tracking (files loop)
+        if (!source.Read(pool[frame.buffer])) {
+            std::cerr << "Tracking: no more frames from the source" << std::endl;
+            break;
+        }
+        frame.capture_time = NowSeconds();
+        frame.index = index++;
+        bool reallocated = pool.Reallocated(frame.buffer);
+        frames.Publish(frame);
+        countAllocations(allocations, reallocated);
+    }
+    frames.Close();
+}
+
+void TrackingPipeline::processLoop()
+{
+    TraceThreadName("tracking process");
+    TrackingFrame frame;
+    frame.buffer = 2;
+    double window_start = NowSeconds();
+    double cpu_start = ThreadCpuSeconds();
+    uint64_t window_frames = 0, window_pixels = 0, window_skipped = 0;
+    double next_preview = 0.0;
+
+    while (frames.Take(frame)) {
+        TRACE_SCOPE("detect");
+        uint64_t allocations = ThreadAllocations();
+        uint64_t pixels = process(frame);
+        double now = NowSeconds();
+
+        TrackingResult latest;
+        latest.center = frame.center;
+        latest.confidence = frame.confidence;
+        latest.capture_time = frame.capture_time;
+        latest.result_time = now;
+        latest.frame = frame.index + 1;
+        result.Store(latest);
+        TRACE_COUNTER("tracking latency ms", (now - frame.capture_time) * 1000.0);
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            stats.AddSample((now - frame.capture_time) * 1000.0, now);
+        }
+
+        window_frames++;
+        window_pixels += pixels;
+        window_skipped += frame.skipped;
+        if (now - window_start >= 1.0) {
+            double cpu = ThreadCpuSeconds();
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            load.pixels_per_frame = (float)((double)window_pixels / window_frames);
+            load.cpu_percent = (float)((cpu - cpu_start) / (now - window_start) * 100.0);
+            load.skipped_percent = (float)(100.0 * window_skipped / window_frames);
+            load.allocations = window_allocations.exchange(0);
+            window_start = now;
+            cpu_start = cpu;
+            window_frames = window_pixels = window_skipped = 0;
+        }
+        // the preview stage only gets the frames it is going to show
+        if (preview != PREVIEW_OFF && now >= next_preview) {
+            next_preview = preview_fps > 0.0 ? now + 1.0 / preview_fps : 0.0;
+            views.Publish(frame);
+        }
+        processed_frames++;
+        countAllocations(allocations, false);
+        // benchmarks only, not part of the steady state
+        if (result_log)
+            result_log->push_back(latest);
+    }
+    views.Close();
+}
+
+void TrackingPipeline::previewLoop()
+{
+    TraceThreadName("tracking preview");
+    TrackingFrame frame;
+    frame.buffer = 4;
+    while (views.Take(frame)) {
+        const cv::Mat& image = pool[frame.buffer];
+        if (image.empty() || image.type() != CV_8UC3)
+            continue;
+        TRACE_SCOPE("preview");
+        uint64_t allocations = ThreadAllocations();
+        int width = std::clamp(preview_width, 1, image.cols);
+        int height = std::max(1, image.rows * width / image.cols);
+        float scale = (float)width / image.cols;
+
+        // the mask thresholds the downscaled pixels, nearest keeps them real camera colours
+        TrackingPreview& out = previews.WriteBuffer();
+        const uint8_t* memory = out.image.data;
+        cv::resize(image, out.image, cv::Size(width, height), 0, 0, preview == PREVIEW_MASK ? cv::INTER_NEAREST : cv::INTER_AREA);
+        if (preview == PREVIEW_MASK) {
+            for (int y = 0; y < height; y++) {
+                uint8_t* p = out.image.ptr(y);
+                for (int x = 0; x < width; x++, p += 3)
+                    p[0] = p[1] = p[2] = HsvInside(p[0], p[1], p[2], range) ? 255 : 0;
+            }
+        }
+        cv::Rect window((int)(frame.window.x * scale), (int)(frame.window.y * scale),
+            std::max(1, (int)(frame.window.width * scale)), std::max(1, (int)(frame.window.height * scale)));
+        cv::rectangle(out.image, window, CV_RGB(255, 255, 0), 1);
+        DrawCross(out.image, frame.center, 10);
+        out.frame = frame.index;
+        bool reallocated = out.image.data != memory;
+        previews.Publish();
+        countAllocations(allocations, reallocated);
+    }
+}
+
+// allocations of one stage's frame: operator new on this thread since `before`, a reallocated image
+void TrackingPipeline::countAllocations(uint64_t before, bool reallocated)
+{
+    uint64_t made = ThreadAllocations() - before + (reallocated ? 1 : 0);
+    if (made == 0)
+        return;
+    window_allocations += made;
+    if (processed_frames >= WARMUP_FRAMES)
+        steady_allocations += made;
+}
+
+// centre and confidence of one frame, returns the pixels read
+uint64_t TrackingPipeline::process(TrackingFrame& frame)
+{
+    const cv::Mat& image = pool[frame.buffer];
+    if (!roi_tracking || image.type() != CV_8UC3) {
+        frame.center = FindCenter(image, frame.confidence);
+        frame.window = cv::Rect(0, 0, image.cols, image.rows);
+        frame.skipped = false;
+        return (uint64_t)image.cols * image.rows;
+    }
+
+    RoiResult tracked = roi.Track(image.data, image.cols, image.rows, image.step, frame.capture_time);
+    frame.center = tracked.center;
+    frame.confidence = tracked.confidence;
+    frame.window = cv::Rect(tracked.x0, tracked.y0, tracked.x1 - tracked.x0, tracked.y1 - tracked.y0);
+    frame.skipped = tracked.skipped;
+    return tracked.pixels;
+}
+
+glm::vec2 TrackingPipeline::FindCenter(const cv::Mat& frame, float& confidence)
+{
+    // threshold in HSV and average the X,Y coordinates of the pixels inside,
+    // one pass over the BGR frame without any intermediate image (HsvCentroid)
+    confidence = 0.0f;
+    if (frame.type() != CV_8UC3)
+        return glm::vec2(0.0f);
+
+    HsvMoments moments = hsv_centroid.Run(frame.data, frame.cols, frame.rows, frame.step, range);
+    double area = (double)frame.cols * frame.rows;
+    confidence = (float)std::min(1.0, moments.count / (area * full_confidence));
+    return moments.Normalized(frame.cols, frame.rows);
+}
+
+void TrackingPipeline::DrawCross(cv::Mat& img, glm::vec2 center_normalized, int size)
+{
+    center_normalized.x = std::clamp(center_normalized.x, 0.0f, 1.0f);
+    center_normalized.y = std::clamp(center_normalized.y, 0.0f, 1.0f);
+
+    cv::Point2f center_absolute(center_normalized.x * img.cols, center_normalized.y * img.rows);
+
+    cv::Point2f p1(center_absolute.x - size / 2, center_absolute.y);
+    cv::Point2f p2(center_absolute.x + size / 2, center_absolute.y);
+    cv::Point2f p3(center_absolute.x, center_absolute.y - size / 2);
+    cv::Point2f p4(center_absolute.x, center_absolute.y + size / 2);
+
+    cv::line(img, p1, p2, CV_RGB(0, 255, 0), 3);
+    cv::line(img, p3, p4, CV_RGB(0, 255, 0), 3);
+}
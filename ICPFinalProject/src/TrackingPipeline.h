@@ -0,0 +1,157 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <glm/glm.hpp> // ibrary for math operations
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "HsvCentroid.h"
+#include "LatestSlot.h"
+#include "SeqLock.h"
+#include "FramePool.h"
+#include "TripleBuffer.h"
+#include "CaptureSource.h"
+#include "RoiTracker.h"
+#include "Timing.h"
+
+// one captured image on its way through the tracker
+struct TrackingFrame {
+    int buffer = -1; // FramePool index of the image
+    double capture_time = 0.0; // NowSeconds() when the capture returned it
+    uint64_t index = 0;
+    glm::vec2 center = glm::vec2(0.0f); // filled by the processing stage (for the view)
+    float confidence = 0.0f;
+    cv::Rect window; // full resolution region the processing stage looked at
+    bool skipped = false; // no motion, the previous result
+};
+
+// newest tracking result
+struct TrackingResult {
+    glm::vec2 center = glm::vec2(0.0f); // normalized to the frame, (0, 0) = nothing found
+    float confidence = 0.0f; // 0 = nothing found, 1 = at least full_confidence of the frame matched
+    double capture_time = 0.0; // of the frame it came from
+    double result_time = 0.0;
+    uint64_t frame = 0; // 1 for the first frame, 0 = no result yet
+};
+
+// what the in-game preview shows
+enum Preview_Mode {
+    PREVIEW_OFF,
+    PREVIEW_FRAME, // the camera frame with the cross and the searched window
+    PREVIEW_MASK   // pixels inside the colour range white, the rest black, with the cross
+};
+
+// downscaled frame for the in-game preview (BGR, continuous)
+struct TrackingPreview {
+    cv::Mat image;
+    uint64_t frame = 0; // TrackingFrame::index it was made from
+};
+
+// work of the processing stage over the last one second window
+struct TrackingLoad {
+    float pixels_per_frame = 0.0f;
+    float cpu_percent = 0.0f;     // of one core, the processing thread (not the full frame path's helpers)
+    float skipped_percent = 0.0f; // frames skipped for no motion
+    uint64_t allocations = 0;     // operator new on the stage threads + reallocated images (0 in the steady state)
+};
+
+/*
+	Hand tracking in three stages on their own threads, each working on the newest frame only:
+
+	capture  -> reads the CaptureSource (camera, video file or synthetic frames), stamps the frame
+	process  -> HSV threshold + centroid as soon as a frame is there, publishes the result;
+	            RoiTracker (window around the predicted marker, motion skip) or the full frame
+	preview  -> optional, a few times a second: downscales the frame, draws the cross (or the
+	            threshold mask) and hands it to the render thread (PreviewOverlay), never holds
+	            up the others
+
+	Results are published through a SeqLock with the capture time and a confidence, readers
+	never block the tracker (TrackingPredictor makes up for the latency on their side).
+
+	The stages hand frames over through LatestSlot: a slow stage gets the newest frame and the
+	ones in between are dropped, nobody polls or spins. Stop() closes the slots and joins.
+	The render thread picks previews up through a TripleBuffer, it never waits either.
+
+	Images live in a FramePool allocated by Start() for the source's mode, the stages pass
+	buffer indices around. After WARMUP_FRAMES the stage threads shouldn't allocate:
+	SteadyAllocations() counts what they still do - operator new on the three stage threads
+	and reallocated pool / preview images. OpenCV's internal scratch memory and the worker
+	threads of cv::parallel_for_ and HsvCentroid (full-frame mode) aren't counted.
+*/
+class TrackingPipeline {
+
+public:
+    CaptureSource source; // opened by the caller before Start()
+    Preview_Mode preview = PREVIEW_FRAME;
+    int preview_width = 320;  // preview image width, the height keeps the frame's aspect
+    double preview_fps = 15.0; // previews per second at most, independent of the tracking rate
+    bool roi_tracking = true; // false = every frame thresholded whole (HsvCentroid on all threads)
+    // frames processed before allocations count (first sizes, lazily created buffers)
+    static const int WARMUP_FRAMES = 30;
+
+    std::vector<TrackingResult>* result_log = nullptr; // every result appended here when set (benchmarks), read after Stop()
+
+    // game's thresholds (lubosova plet)
+    HsvRange range = { { 170, 150, 150 }, { 180, 255, 250 } };
+    float full_confidence = 0.002f; // fraction of the frame inside range for confidence 1
+
+
+    ~TrackingPipeline() { Stop(); }
+
+    void Start();
+    void Stop();
+    // waits until the source has no more frames and every frame is processed
+    void Finish();
+
+    // newest result, lock-free, frame = 0 before the first one
+    TrackingResult Latest() const { return result.Load(); }
+
+    // capture -> result latency (avg / max ms per second) and processed frames per second (rate)
+    TimingStats Stats();
+    uint64_t Captured() { return frames.Published(); }
+    uint64_t Dropped() { return frames.Dropped(); }
+    TrackingLoad Load();
+    // stage threads' operator new + reallocated images after the warm-up (not OpenCV internals, not worker threads)
+    uint64_t SteadyAllocations() const { return steady_allocations; }
+
+    // render thread: takes the newest preview if there is a new one (then Preview() is it)
+    bool AcquirePreview() { return previews.Acquire(); }
+    const TrackingPreview& Preview() const { return previews.ReadBuffer(); }
+
+    // centroid of the pixels inside range, normalized to the frame, (0, 0) if there are none
+    glm::vec2 FindCenter(const cv::Mat& frame, float& confidence);
+    static void DrawCross(cv::Mat& img, glm::vec2 center_normalized, int size);
+
+    // parses "off" / "frame" / "mask"
+    static bool PreviewFromName(const char* name, Preview_Mode& mode);
+
+private:
+    // buffers: one each for capture, process and preview, one in each of the two slots
+    static const int POOL_BUFFERS = 5;
+
+    HsvCentroid hsv_centroid;
+    RoiTracker roi;
+    FramePool pool;
+    LatestSlot<TrackingFrame> frames; // capture -> process
+    LatestSlot<TrackingFrame> views;  // process -> preview
+    TripleBuffer<TrackingPreview> previews; // preview -> render thread
+    std::thread capture_thread, process_thread, preview_thread;
+    std::atomic<bool> stopping = false;
+
+    SeqLock<TrackingResult> result;
+    std::mutex stats_mutex;
+    TimingStats stats;
+    TrackingLoad load;
+    std::atomic<uint64_t> processed_frames = 0;
+    std::atomic<uint64_t> window_allocations = 0, steady_allocations = 0;
+
+    void captureLoop();
+    void processLoop();
+    void previewLoop();
+    uint64_t process(TrackingFrame& frame);
+    void countAllocations(uint64_t before, bool reallocated);
+
+};
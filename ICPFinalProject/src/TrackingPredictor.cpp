@@ -0,0 +1,143 @@
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+#include "TrackingPredictor.h"
+
+void TrackingPredictor::Add(const TrackingSample& sample)
+{
+    bool detected = sample.confidence > 0.0f;
+    if (!has_state || (detected && Lost(sample.capture_time))) {
+        // first detection or back after losing the hand: start from the measurement
+        if (!detected)
+            return;
+        position = sample.center;
+        velocity = glm::vec2(0.0f);
+        p00 = settings.measurement_noise * settings.measurement_noise;
+        p01 = 0.0f;
+        p11 = 1.0f;
+        state_time = sample.capture_time;
+        last_detection = sample.capture_time;
+        has_state = true;
+        return;
+    }
+
+    // predict to the sample's capture time (white noise acceleration)
+    float dt = (float)std::max(0.0, sample.capture_time - state_time);
+    float q = settings.process_noise;
+    position += velocity * dt;
+    p00 += 2.0f * dt * p01 + dt * dt * p11 + q * dt * dt * dt / 3.0f;
+    p01 += dt * p11 + q * dt * dt / 2.0f;
+    p11 += q * dt;
+    state_time = sample.capture_time;
+
+    if (!detected) {
+        if (Lost(sample.capture_time))
+            velocity = glm::vec2(0.0f);
+        return;
+    }
+
+    // correct with the measurement, less confident = noisier
+    float noise = settings.measurement_noise / std::max(sample.confidence, 0.1f);
+    float s = p00 + noise * noise;
+    float k0 = p00 / s;
+    float k1 = p01 / s;
+    glm::vec2 innovation = sample.center - position;
+    position += k0 * innovation;
+    velocity += k1 * innovation;
+    p11 -= k1 * p01;
+    p01 *= 1.0f - k0;
+    p00 *= 1.0f - k0;
+    last_detection = sample.capture_time;
+}
+
+glm::vec2 TrackingPredictor::Predict(double time) const
+{
+    if (Lost(time))
+        return glm::vec2(0.5f);
+    glm::vec2 estimate = position;
+    if (settings.predict) {
+        float dt = (float)std::clamp(time - state_time, 0.0, (double)settings.max_lookahead);
+        estimate += velocity * dt;
+    }
+    return glm::clamp(estimate, glm::vec2(0.0f), glm::vec2(1.0f));
+}
+
+static void summarize(std::vector<float>& errors, float& rms, float& p95)
+{
+    if (errors.empty())
+        return;
+    double sum = 0.0;
+    for (float e : errors)
+        sum += (double)e * e;
+    rms = (float)std::sqrt(sum / errors.size());
+    std::sort(errors.begin(), errors.end());
+    p95 = errors[std::min(errors.size() - 1, (size_t)(0.95 * errors.size()))];
+}
+
+TrackingError EvaluateTracking(const std::vector<TrackingSample>& samples, const TrackingPredictorSettings& settings)
+{
+    TrackingError result;
+    TrackingPredictorSettings smooth_settings = settings;
+    smooth_settings.predict = false;
+    TrackingPredictorSettings predict_settings = settings;
+    predict_settings.predict = true;
+    TrackingPredictor smooth(smooth_settings), predict(predict_settings);
+
+    std::vector<float> hold_errors, smooth_errors, predict_errors;
+    glm::vec2 hold = glm::vec2(0.5f);
+    bool any_published = false;
+    double latency = 0.0;
+    size_t published = 0;
+
+    for (size_t k = 0; k < samples.size(); k++) {
+        const TrackingSample& now = samples[k];
+        // everything the consumer had received by the time this frame was captured
+        while (published < k && samples[published].result_time <= now.capture_time) {
+            smooth.Add(samples[published]);
+            predict.Add(samples[published]);
+            hold = samples[published].center;
+            any_published = true;
+            published++;
+        }
+        latency += now.result_time - now.capture_time;
+
+        if (!any_published || now.confidence <= 0.0f)
+            continue;
+        hold_errors.push_back(glm::length(hold - now.center));
+        smooth_errors.push_back(glm::length(smooth.Predict(now.capture_time) - now.center));
+        predict_errors.push_back(glm::length(predict.Predict(now.capture_time) - now.center));
+    }
+
+    result.samples = (int)predict_errors.size();
+    summarize(hold_errors, result.hold_rms, result.hold_p95);
+    summarize(smooth_errors, result.smooth_rms, result.smooth_p95);
+    summarize(predict_errors, result.predict_rms, result.predict_p95);
+    if (!samples.empty())
+        result.latency_ms = (float)(latency / samples.size() * 1000.0);
+    return result;
+}
+
+bool SaveTrackingSamples(const std::string& path, const std::vector<TrackingSample>& samples)
+{
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    file << std::setprecision(17);
+    for (const TrackingSample& sample : samples)
+        file << sample.capture_time << ' ' << sample.result_time << ' ' << sample.center.x << ' ' << sample.center.y << ' ' << sample.confidence << '\n';
+    return (bool)file;
+}
+
+bool LoadTrackingSamples(const std::string& path, std::vector<TrackingSample>& samples)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    samples.clear();
+    TrackingSample sample;
+    while (file >> sample.capture_time >> sample.result_time >> sample.center.x >> sample.center.y >> sample.confidence)
+        samples.push_back(sample);
+    return file.eof();
+}
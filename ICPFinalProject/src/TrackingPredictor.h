@@ -0,0 +1,79 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <vector>
+#include <string>
+
+/*
+	Makes up for the tracking pipeline's latency on the consumer side.
+
+	Every tracking result is a sample of where the hand was when the frame was captured, it
+	arrives tens of milliseconds later. The predictor runs a constant velocity Kalman filter per
+	axis over the samples (weighted by their confidence) and extrapolates the position to the
+	time the game actually uses it. Samples without a detection only age the filter; when the
+	hand has been lost for a while the prediction goes back to the neutral centre.
+
+	Raw samples can be logged next to a recording (SaveTrackingSamples) and replayed through
+	the predictor offline (EvaluateTracking, ICPBench prediction) to measure its error.
+*/
+
+struct TrackingSample {
+    double capture_time = 0.0; // NowSeconds() of the frame
+    double result_time = 0.0;  // when the result was published
+    glm::vec2 center = glm::vec2(0.0f); // normalized
+    float confidence = 0.0f; // 0 = nothing found, 1 = a marker of a solid size
+};
+
+struct TrackingPredictorSettings {
+    float process_noise = 4.0f;       // acceleration noise of the hand (normalized units / s^2)
+    float measurement_noise = 0.01f;  // centroid noise at full confidence (normalized units)
+    float max_lookahead = 0.15f;      // never extrapolates further than this (seconds)
+    float lost_timeout = 0.5f;        // without a detection for this long the hand is lost
+    bool predict = true;              // false = filtered position at the last sample only (smoothing)
+};
+
+class TrackingPredictor {
+
+public:
+    TrackingPredictorSettings settings;
+
+    TrackingPredictor(const TrackingPredictorSettings& settings = TrackingPredictorSettings()) : settings(settings) {}
+
+    // samples have to come in capture order (the pipeline publishes them that way)
+    void Add(const TrackingSample& sample);
+
+    // estimated hand position at the given time, (0.5, 0.5) = neutral while lost
+    glm::vec2 Predict(double time) const;
+
+    bool Lost(double time) const { return !has_state || time - last_detection > settings.lost_timeout; }
+
+private:
+    // per axis state (position, velocity) and its covariance
+    glm::vec2 position = glm::vec2(0.5f);
+    glm::vec2 velocity = glm::vec2(0.0f);
+    float p00 = 1.0f, p01 = 0.0f, p11 = 1.0f; // same for both axes (same noise)
+    double state_time = 0.0;
+    double last_detection = 0.0;
+    bool has_state = false;
+
+};
+
+// error of the consumer side estimate against the next measured sample
+struct TrackingError {
+    int samples = 0;          // confident samples scored
+    float hold_rms = 0.0f;    // using the newest published sample as it is (the old behaviour)
+    float hold_p95 = 0.0f;
+    float smooth_rms = 0.0f;  // filter without prediction
+    float smooth_p95 = 0.0f;
+    float predict_rms = 0.0f; // filter + extrapolation to the capture time of that sample
+    float predict_p95 = 0.0f;
+    float latency_ms = 0.0f;  // average capture -> result latency of the samples
+};
+
+// replays samples in time order: at the capture time of each sample, estimates its position
+// from the samples published before that moment and compares to what it then measured
+TrackingError EvaluateTracking(const std::vector<TrackingSample>& samples, const TrackingPredictorSettings& settings);
+
+// text file, one sample per line: capture_time result_time x y confidence
+bool SaveTrackingSamples(const std::string& path, const std::vector<TrackingSample>& samples);
+bool LoadTrackingSamples(const std::string& path, std::vector<TrackingSample>& samples);
@@ -0,0 +1,484 @@
+#include <glm/ext.hpp>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "TriangleBVH.h"
+#include "Timing.h"
+
+
+static const int SAH_BINS = 16;
+static const uint32_t MAX_LEAF = 8; // leaves that SAH would rather keep bigger are split anyway
+static const int MAX_DEPTH = 64;
+
+static float area(const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 e = max - min;
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+void TriangleBVH::AddTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    v0.push_back(a);
+    e1.push_back(b - a);
+    e2.push_back(c - a);
+}
+
+bool TriangleBVH::AddObj(const std::string& path, const glm::mat4& transform)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Can't open collision mesh: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<glm::vec3> positions;
+    std::vector<int> face;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.size() < 2 || line[1] != ' ')
+            continue;
+        std::istringstream in(line.substr(2));
+        if (line[0] == 'v') {
+            glm::vec3 p;
+            in >> p.x >> p.y >> p.z;
+            positions.push_back(glm::vec3(transform * glm::vec4(p, 1.0f)));
+        }
+        else if (line[0] == 'f') {
+            // "f 1/2/3 4/5/6 ..." - only the position index, negative = from the end
+            face.clear();
+            std::string corner;
+            while (in >> corner) {
+                int index = std::atoi(corner.c_str());
+                face.push_back(index < 0 ? (int)positions.size() + index : index - 1);
+            }
+            for (size_t i = 2; i < face.size(); i++) {
+                if (face[0] < 0 || face[i - 1] < 0 || face[i] < 0 || face[i] >= (int)positions.size())
+                    continue;
+                AddTriangle(positions[face[0]], positions[face[i - 1]], positions[face[i]]);
+            }
+        }
+    }
+    return true;
+}
+
+void TriangleBVH::refit(Node& node) const
+{
+    node.min = glm::vec3(1e30f);
+    node.max = glm::vec3(-1e30f);
+    for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        glm::vec3 a = v0[i], b = v0[i] + e1[i], c = v0[i] + e2[i];
+        node.min = glm::min(node.min, glm::min(a, glm::min(b, c)));
+        node.max = glm::max(node.max, glm::max(a, glm::max(b, c)));
+    }
+}
+
+void TriangleBVH::Build()
+{
+    double start = NowSeconds();
+    nodes.clear();
+    depth = 0;
+    if (v0.empty())
+        return;
+
+    std::vector<glm::vec3> centroids(v0.size());
+    for (size_t i = 0; i < v0.size(); i++)
+        centroids[i] = v0[i] + (e1[i] + e2[i]) * (1.0f / 3.0f);
+
+    nodes.reserve(v0.size() * 2);
+    Node root;
+    root.first = 0;
+    root.count = (uint32_t)v0.size();
+    refit(root);
+    nodes.push_back(root);
+    subdivide(0, centroids, 1);
+
+    build_seconds = NowSeconds() - start;
+}
+
+void TriangleBVH::subdivide(uint32_t index, std::vector<glm::vec3>& centroids, int level)
+{
+    depth = std::max(depth, level);
+    Node node = nodes[index];
+    if (node.count <= 2 || level >= MAX_DEPTH)
+        return;
+
+    glm::vec3 cmin(1e30f), cmax(-1e30f);
+    for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        cmin = glm::min(cmin, centroids[i]);
+        cmax = glm::max(cmax, centroids[i]);
+    }
+
+    // best binned SAH split over all three axes
+    float bestCost = 1e30f;
+    int bestAxis = -1, bestBin = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = cmax[axis] - cmin[axis];
+        if (extent <= 0.0f)
+            continue;
+        struct Bin { glm::vec3 min = glm::vec3(1e30f), max = glm::vec3(-1e30f); int count = 0; } bins[SAH_BINS];
+        float scale = SAH_BINS / extent;
+        for (uint32_t i = node.first; i < node.first + node.count; i++) {
+            int b = std::min(SAH_BINS - 1, (int)((centroids[i][axis] - cmin[axis]) * scale));
+            glm::vec3 a = v0[i], p = v0[i] + e1[i], q = v0[i] + e2[i];
+            bins[b].min = glm::min(bins[b].min, glm::min(a, glm::min(p, q)));
+            bins[b].max = glm::max(bins[b].max, glm::max(a, glm::max(p, q)));
+            bins[b].count++;
+        }
+        // sweep from both sides: cost of splitting after bin i
+        float leftArea[SAH_BINS - 1], rightArea[SAH_BINS - 1];
+        int leftCount[SAH_BINS - 1], rightCount[SAH_BINS - 1];
+        glm::vec3 lmin(1e30f), lmax(-1e30f), rmin(1e30f), rmax(-1e30f);
+        int lsum = 0, rsum = 0;
+        for (int i = 0; i < SAH_BINS - 1; i++) {
+            lsum += bins[i].count;
+            lmin = glm::min(lmin, bins[i].min);
+            lmax = glm::max(lmax, bins[i].max);
+            leftCount[i] = lsum;
+            leftArea[i] = lsum ? area(lmin, lmax) : 0.0f;
+            int j = SAH_BINS - 1 - i;
+            rsum += bins[j].count;
+            rmin = glm::min(rmin, bins[j].min);
+            rmax = glm::max(rmax, bins[j].max);
+            rightCount[j - 1] = rsum;
+            rightArea[j - 1] = rsum ? area(rmin, rmax) : 0.0f;
+        }
+        for (int i = 0; i < SAH_BINS - 1; i++) {
+            if (leftCount[i] == 0 || rightCount[i] == 0)
+                continue;
+            float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = i;
+            }
+        }
+    }
+
+    if (bestAxis < 0)
+        return;
+    float leafCost = node.count * area(node.min, node.max);
+    if (bestCost >= leafCost && node.count <= MAX_LEAF)
+        return;
+
+    // partition the triangle range around the chosen plane
+    float scale = SAH_BINS / (cmax[bestAxis] - cmin[bestAxis]);
+    uint32_t i = node.first, j = node.first + node.count - 1;
+    while (i <= j) {
+        int b = std::min(SAH_BINS - 1, (int)((centroids[i][bestAxis] - cmin[bestAxis]) * scale));
+        if (b <= bestBin)
+            i++;
+        else {
+            std::swap(v0[i], v0[j]);
+            std::swap(e1[i], e1[j]);
+            std::swap(e2[i], e2[j]);
+            std::swap(centroids[i], centroids[j]);
+            if (j == 0)
+                break;
+            j--;
+        }
+    }
+    uint32_t leftCount = i - node.first;
+    if (leftCount == 0 || leftCount == node.count)
+        return;
+
+    Node left, right;
+    left.first = node.first;
+    left.count = leftCount;
+    right.first = i;
+    right.count = node.count - leftCount;
+    refit(left);
+    refit(right);
+
+    uint32_t leftIndex = (uint32_t)nodes.size();
+    nodes.push_back(left);
+    nodes.push_back(right);
+    nodes[index].first = leftIndex;
+    nodes[index].count = 0;
+
+    subdivide(leftIndex, centroids, level + 1);
+    subdivide(leftIndex + 1, centroids, level + 1);
+}
+
+// entry distance of the ray into the box, or a value > maxT when it misses
+static float rayBox(const glm::vec3& origin, const glm::vec3& invDir, const glm::vec3& min, const glm::vec3& max, float maxT)
+{
+    glm::vec3 t0 = (min - origin) * invDir;
+    glm::vec3 t1 = (max - origin) * invDir;
+    glm::vec3 tmin = glm::min(t0, t1), tmax = glm::max(t0, t1);
+    float enter = std::max(std::max(tmin.x, tmin.y), std::max(tmin.z, 0.0f));
+    float exit = std::min(std::min(tmax.x, tmax.y), std::min(tmax.z, maxT));
+    return enter <= exit ? enter : 1e30f;
+}
+
+bool TriangleBVH::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxT, BVHHit& hit) const
+{
+    if (nodes.empty())
+        return false;
+    glm::vec3 invDir = 1.0f / direction;
+    float best = maxT;
+    int bestTriangle = -1;
+
+    uint32_t stack[MAX_DEPTH * 2];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (node.count > 0) {
+            // Moller-Trumbore
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                glm::vec3 p = glm::cross(direction, e2[i]);
+                float det = glm::dot(e1[i], p);
+                if (std::fabs(det) < 1e-12f)
+                    continue;
+                float inv = 1.0f / det;
+                glm::vec3 s = origin - v0[i];
+                float u = glm::dot(s, p) * inv;
+                if (u < 0.0f || u > 1.0f)
+                    continue;
+                glm::vec3 q = glm::cross(s, e1[i]);
+                float v = glm::dot(direction, q) * inv;
+                if (v < 0.0f || u + v > 1.0f)
+                    continue;
+                float t = glm::dot(e2[i], q) * inv;
+                if (t >= 0.0f && t < best) {
+                    best = t;
+                    bestTriangle = (int)i;
+                }
+            }
+            continue;
+        }
+        // nearer child last on the stack = visited first
+        uint32_t a = node.first, b = node.first + 1;
+        float ta = rayBox(origin, invDir, nodes[a].min, nodes[a].max, best);
+        float tb = rayBox(origin, invDir, nodes[b].min, nodes[b].max, best);
+        if (ta > tb) {
+            std::swap(a, b);
+            std::swap(ta, tb);
+        }
+        if (tb <= best)
+            stack[top++] = b;
+        if (ta <= best)
+            stack[top++] = a;
+    }
+
+    if (bestTriangle < 0)
+        return false;
+    hit.t = best;
+    hit.triangle = bestTriangle;
+    hit.normal = glm::normalize(glm::cross(e1[bestTriangle], e2[bestTriangle]));
+    if (glm::dot(hit.normal, direction) > 0.0f)
+        hit.normal = -hit.normal;
+    return true;
+}
+
+// first t in 0..1 where a sphere of radius r around o + t d touches the sphere around c (radius 0 = point)
+static bool sweptSpherePoint(const glm::vec3& o, const glm::vec3& d, const glm::vec3& c, float r, float& t)
+{
+    glm::vec3 m = o - c;
+    float C = glm::dot(m, m) - r * r;
+    if (C <= 0.0f) {
+        t = 0.0f;
+        return true;
+    }
+    float A = glm::dot(d, d);
+    float B = glm::dot(m, d);
+    if (A == 0.0f || B >= 0.0f)
+        return false;
+    float disc = B * B - A * C;
+    if (disc < 0.0f)
+        return false;
+    t = (-B - std::sqrt(disc)) / A;
+    return t <= 1.0f;
+}
+
+// same against the edge a-b (a cylinder of radius r, the rounded ends are left to sweptSpherePoint)
+static bool sweptSphereEdge(const glm::vec3& o, const glm::vec3& d, const glm::vec3& a, const glm::vec3& b, float r, float& t)
+{
+    glm::vec3 ab = b - a, ao = o - a;
+    float abab = glm::dot(ab, ab);
+    if (abab == 0.0f)
+        return false;
+    float dAxis = glm::dot(d, ab) / abab;
+    float oAxis = glm::dot(ao, ab) / abab;
+    glm::vec3 dp = d - ab * dAxis, op = ao - ab * oAxis;
+    float C = glm::dot(op, op) - r * r;
+    if (C <= 0.0f) {
+        if (oAxis < 0.0f || oAxis > 1.0f)
+            return false;
+        t = 0.0f;
+        return true;
+    }
+    float A = glm::dot(dp, dp);
+    float B = glm::dot(op, dp);
+    if (A == 0.0f || B >= 0.0f)
+        return false;
+    float disc = B * B - A * C;
+    if (disc < 0.0f)
+        return false;
+    t = (-B - std::sqrt(disc)) / A;
+    float s = oAxis + t * dAxis;
+    return t <= 1.0f && s >= 0.0f && s <= 1.0f;
+}
+
+static bool insideTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& n)
+{
+    float c0 = glm::dot(glm::cross(b - a, p - a), n);
+    float c1 = glm::dot(glm::cross(c - b, p - b), n);
+    float c2 = glm::dot(glm::cross(a - c, p - c), n);
+    return (c0 >= 0.0f && c1 >= 0.0f && c2 >= 0.0f) || (c0 <= 0.0f && c1 <= 0.0f && c2 <= 0.0f);
+}
+
+// first touch of the moving sphere with the triangle: its face, else the edges and corners
+static bool sweptSphereTriangle(const glm::vec3& o, const glm::vec3& d, float r, const glm::vec3& a, const glm::vec3& e1, const glm::vec3& e2, float maxT, float& tHit)
+{
+    glm::vec3 n = glm::cross(e1, e2);
+    float length = glm::length(n);
+    if (length == 0.0f)
+        return false;
+    n /= length;
+    glm::vec3 b = a + e1, c = a + e2;
+
+    float s0 = glm::dot(n, o - a);
+    float dn = glm::dot(n, d);
+    if (s0 < 0.0f) { // work from the side the sphere starts on
+        s0 = -s0;
+        dn = -dn;
+        n = -n;
+    }
+    // the plane is never farther than the triangle - a touch inside the face is the first one
+    float tPlane;
+    if (s0 <= r)
+        tPlane = 0.0f;
+    else if (dn < 0.0f)
+        tPlane = (s0 - r) / -dn;
+    else
+        return false;
+    if (tPlane > maxT)
+        return false;
+    if (insideTriangle(o + d * tPlane - n * std::min(s0, r), a, b, c, n)) {
+        tHit = tPlane;
+        return true;
+    }
+
+    float best = maxT, t;
+    bool found = false;
+    const glm::vec3 corners[3] = { a, b, c };
+    for (int i = 0; i < 3; i++) {
+        if (sweptSphereEdge(o, d, corners[i], corners[(i + 1) % 3], r, t) && t < best) {
+            best = t;
+            found = true;
+        }
+        if (sweptSpherePoint(o, d, corners[i], r, t) && t < best) {
+            best = t;
+            found = true;
+        }
+    }
+    if (found)
+        tHit = best;
+    return found;
+}
+
+bool TriangleBVH::SphereCast(const glm::vec3& p0, const glm::vec3& p1, float radius, BVHHit& hit) const
+{
+    if (nodes.empty())
+        return false;
+    glm::vec3 d = p1 - p0;
+    glm::vec3 invDir = 1.0f / d;
+    glm::vec3 grow(radius);
+    float best = 1.0f;
+    int bestTriangle = -1;
+
+    uint32_t stack[MAX_DEPTH * 2];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                float t;
+                if (sweptSphereTriangle(p0, d, radius, v0[i], e1[i], e2[i], best, t) && (t < best || bestTriangle < 0)) {
+                    best = t;
+                    bestTriangle = (int)i;
+                }
+            }
+            continue;
+        }
+        // boxes grown by the radius against the segment
+        uint32_t a = node.first, b = node.first + 1;
+        float ta = rayBox(p0, invDir, nodes[a].min - grow, nodes[a].max + grow, best);
+        float tb = rayBox(p0, invDir, nodes[b].min - grow, nodes[b].max + grow, best);
+        if (ta > tb) {
+            std::swap(a, b);
+            std::swap(ta, tb);
+        }
+        if (tb <= best)
+            stack[top++] = b;
+        if (ta <= best)
+            stack[top++] = a;
+    }
+
+    if (bestTriangle < 0)
+        return false;
+    hit.t = best;
+    hit.triangle = bestTriangle;
+    hit.normal = glm::normalize(glm::cross(e1[bestTriangle], e2[bestTriangle]));
+    if (glm::dot(hit.normal, p0 - v0[bestTriangle]) < 0.0f)
+        hit.normal = -hit.normal;
+    return true;
+}
+
+// closest point of the triangle a, a + e1, a + e2 to p (Ericson, Real-Time Collision Detection 5.1.5)
+static glm::vec3 closestOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& ab, const glm::vec3& ac)
+{
+    glm::vec3 ap = p - a;
+    float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) return a;
+    glm::vec3 bp = ap - ab;
+    float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) return a + ab;
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+    glm::vec3 cp = ap - ac;
+    float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) return a + ac;
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return a + ab + (ac - ab) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+bool TriangleBVH::OverlapSphere(const glm::vec3& center, float radius) const
+{
+    if (nodes.empty())
+        return false;
+    float r2 = radius * radius;
+
+    uint32_t stack[MAX_DEPTH * 2];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        glm::vec3 closest = glm::clamp(center, node.min, node.max);
+        glm::vec3 delta = closest - center;
+        if (glm::dot(delta, delta) > r2)
+            continue;
+        if (node.count == 0) {
+            stack[top++] = node.first;
+            stack[top++] = node.first + 1;
+            continue;
+        }
+        for (uint32_t i = node.first; i < node.first + node.count; i++) {
+            glm::vec3 d = closestOnTriangle(center, v0[i], e1[i], e2[i]) - center;
+            if (glm::dot(d, d) <= r2)
+                return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/*
+	Bounding volume hierarchy over static triangles (level geometry) for exact collision.
+
+	- built once at load time: binned SAH (16 bins per axis on the centroid bounds)
+	- flattened into one array of 32 byte nodes, children of a node are stored next to each
+	  other, triangles are reordered so every leaf is one contiguous range
+	- Raycast: closest hit along a ray, SphereCast: first touch of a sphere moving along a segment
+	  (triangle face, edges and corners, exact), OverlapSphere: any triangle within a radius
+
+	AddObj reads only positions and faces of an OBJ file (no materials, no assimp), so the
+	headless runner and the benchmarks can load the same collision geometry as the game.
+*/
+
+struct BVHHit {
+    float t = 0.0f;        // Raycast: distance along the direction, SphereCast: 0..1 along the segment
+    int triangle = -1;
+    glm::vec3 normal;      // of the triangle, facing the query
+};
+
+class TriangleBVH {
+
+public:
+    void AddTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+
+    // appends the faces of an OBJ file transformed by `transform`, returns false when it can't be read
+    bool AddObj(const std::string& path, const glm::mat4& transform);
+
+    // builds the tree over all triangles added so far
+    void Build();
+
+    bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxT, BVHHit& hit) const;
+    bool SphereCast(const glm::vec3& p0, const glm::vec3& p1, float radius, BVHHit& hit) const;
+    bool OverlapSphere(const glm::vec3& center, float radius) const;
+
+    bool Empty() const { return nodes.empty(); }
+    int TriangleCount() const { return (int)v0.size(); }
+    int NodeCount() const { return (int)nodes.size(); }
+    int Depth() const { return depth; }
+    double build_seconds = 0.0;
+
+private:
+    struct Node {
+        glm::vec3 min;
+        uint32_t first;  // inner node: index of the left child (right = first + 1), leaf: first triangle
+        glm::vec3 max;
+        uint32_t count;  // triangles of a leaf, 0 = inner node
+    };
+
+    // triangles as a corner + two edges (what the ray test needs)
+    std::vector<glm::vec3> v0, e1, e2;
+    std::vector<Node> nodes;
+    int depth = 0;
+
+    void subdivide(uint32_t node, std::vector<glm::vec3>& centroids, int level);
+    void refit(Node& node) const;
+
+};
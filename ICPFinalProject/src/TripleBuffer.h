@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+
+/*
+	Lock-free single-producer / single-consumer triple buffer.
+
+	The writer always owns one slot, the reader owns another and the third one
+	is the "middle" slot they exchange through a single atomic. Publish() swaps the
+	freshly written slot into the middle, Acquire() swaps the middle into the reader
+	when it holds something new. Neither side ever waits for the other - the reader
+	always sees the latest complete value, intermediate ones are simply dropped.
+*/
+template <typename T>
+class TripleBuffer {
+
+public:
+    TripleBuffer() : middle(1) {}
+
+    // slot owned by the writer, fill it and call Publish()
+    T& WriteBuffer() { return buffers[writeIndex]; }
+
+    // hands the written slot over to the reader
+    void Publish()
+    {
+        unsigned int previous = middle.exchange(writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // takes the newest published value if there is one, returns false if nothing new was published
+    bool Acquire()
+    {
+        if ((middle.load(std::memory_order_acquire) & FRESH_BIT) == 0)
+            return false;
+        unsigned int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    // slot owned by the reader, valid until the next Acquire()
+    const T& ReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const unsigned int INDEX_MASK = 0x3;
+    static const unsigned int FRESH_BIT = 0x4;
+
+    T buffers[3];
+    unsigned int writeIndex = 0;
+    unsigned int readIndex = 2;
+    std::atomic<unsigned int> middle;
+
+};
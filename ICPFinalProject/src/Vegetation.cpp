@@ -0,0 +1,97 @@
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <cmath>
+
+#include "Vegetation.h"
+
+static const int TRUNK_SIDES = 8;
+static const int CROWN_SIDES = 8;
+
+
+void VegetationBatch::Begin(const glm::vec3& eyePosition, const glm::vec3& forward3)
+{
+    eye = eyePosition;
+    near_trees.clear();
+    far_trees.clear();
+    culled = 0;
+
+    // looking (almost) straight down every direction is visible
+    glm::vec2 flat = glm::vec2(forward3.x, forward3.z);
+    float length = glm::length(flat);
+    if (length < 0.3f) {
+        forward = glm::vec2(0.0f, 1.0f);
+        cone_cos = -2.0f;
+    }
+    else {
+        forward = flat / length;
+        cone_cos = std::cos(glm::radians(settings.half_fov_degrees));
+    }
+}
+
+void VegetationBatch::Add(const glm::vec4* trees, size_t count)
+{
+    const float max2 = settings.max_distance * settings.max_distance;
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec4& tree = trees[i];
+        glm::vec2 d = glm::vec2(tree.x - eye.x, tree.z - eye.z);
+        float distance2 = glm::dot(d, d);
+        if (distance2 > max2) {
+            culled++;
+            continue;
+        }
+        float distance = std::sqrt(distance2);
+        // the crown reaches about half the height sideways, so keep trees the cone only touches
+        if (glm::dot(d, forward) < distance * cone_cos - tree.w * 0.5f) {
+            culled++;
+            continue;
+        }
+        if (distance < settings.fade_end)
+            near_trees.push_back(tree);
+        if (distance > settings.fade_start)
+            far_trees.push_back(tree);
+    }
+}
+
+void BuildTreeMesh(std::vector<TreeVertex>& vertices, std::vector<unsigned int>& indices, unsigned int& barkIndices)
+{
+    const float TWO_PI = 6.28318530718f;
+    vertices.clear();
+    indices.clear();
+
+    // trunk: prism up into the crown, flat shaded
+    const float trunkHeight = 0.4f, trunkRadius = 0.05f;
+    for (int s = 0; s < TRUNK_SIDES; s++) {
+        float a0 = TWO_PI * s / TRUNK_SIDES, a1 = TWO_PI * (s + 1) / TRUNK_SIDES, mid = (a0 + a1) * 0.5f;
+        glm::vec3 p0 = glm::vec3(std::cos(a0), 0.0f, std::sin(a0)) * trunkRadius;
+        glm::vec3 p1 = glm::vec3(std::cos(a1), 0.0f, std::sin(a1)) * trunkRadius;
+        glm::vec3 up = glm::vec3(0.0f, trunkHeight, 0.0f);
+        glm::vec3 normal = glm::vec3(std::cos(mid), 0.0f, std::sin(mid));
+        float u0 = (float)s / TRUNK_SIDES, u1 = (float)(s + 1) / TRUNK_SIDES;
+        unsigned int v = (unsigned int)vertices.size();
+        vertices.push_back({ p0, normal, glm::vec2(u0, 0.0f) });
+        vertices.push_back({ p1, normal, glm::vec2(u1, 0.0f) });
+        vertices.push_back({ p1 + up, normal, glm::vec2(u1, 1.0f) });
+        vertices.push_back({ p0 + up, normal, glm::vec2(u0, 1.0f) });
+        indices.insert(indices.end(), { v, v + 1, v + 2, v, v + 2, v + 3 });
+    }
+    barkIndices = (unsigned int)indices.size();
+
+    // crown: two stacked cones (bottom y, top y, radius)
+    const glm::vec3 cones[2] = { glm::vec3(0.25f, 0.75f, 0.32f), glm::vec3(0.5f, 1.0f, 0.24f) };
+    for (const glm::vec3& cone : cones) {
+        glm::vec3 apex = glm::vec3(0.0f, cone.y, 0.0f);
+        for (int s = 0; s < CROWN_SIDES; s++) {
+            float a0 = TWO_PI * s / CROWN_SIDES, a1 = TWO_PI * (s + 1) / CROWN_SIDES, mid = (a0 + a1) * 0.5f;
+            glm::vec3 b0 = glm::vec3(std::cos(a0) * cone.z, cone.x, std::sin(a0) * cone.z);
+            glm::vec3 b1 = glm::vec3(std::cos(a1) * cone.z, cone.x, std::sin(a1) * cone.z);
+            glm::vec3 normal = glm::normalize(glm::cross(apex - b0, b1 - b0));
+            if (glm::dot(normal, glm::vec3(std::cos(mid), 0.0f, std::sin(mid))) < 0.0f)
+                normal = -normal;
+            unsigned int v = (unsigned int)vertices.size();
+            vertices.push_back({ b0, normal, glm::vec2(0.0f, 0.0f) });
+            vertices.push_back({ b1, normal, glm::vec2(1.0f, 0.0f) });
+            vertices.push_back({ apex, normal, glm::vec2(0.5f, 1.0f) });
+            indices.insert(indices.end(), { v, v + 1, v + 2 });
+        }
+    }
+}
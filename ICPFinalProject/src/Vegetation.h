@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glm/glm.hpp> // ibrary for math operations
+#include <vector>
+#include <cstddef>
+
+/*
+	CPU side of the vegetation: which trees get the full mesh and which the billboard impostor.
+
+	- trees come as vec4 (base xyz, height w), the chunks place them (ChunkTrees)
+	- up to fade_end from the eye a tree is drawn as a mesh, from fade_start on as an impostor,
+	  in between as both and the shaders dither one into the other (no sorting, no blending)
+	- trees behind the eye or beyond max_distance are culled
+	- the result is two instance arrays, one instanced draw each (VegetationRenderer)
+*/
+
+struct VegetationSettings {
+    float fade_start = 35.0f;   // impostors start here
+    float fade_end = 45.0f;     // meshes end here
+    float max_distance = 100.0f; // far plane of the game's projection
+    float half_fov_degrees = 60.0f; // horizontal culling cone (wider than the view, trees have size)
+};
+
+class VegetationBatch {
+
+public:
+    VegetationSettings settings;
+
+    // starts a new frame seen from eye looking along forward
+    void Begin(const glm::vec3& eye, const glm::vec3& forward);
+
+    // sorts trees into the near / far instance arrays
+    void Add(const glm::vec4* trees, size_t count);
+
+    const std::vector<glm::vec4>& Near() const { return near_trees; }
+    const std::vector<glm::vec4>& Far() const { return far_trees; }
+    size_t Culled() const { return culled; }
+
+private:
+    glm::vec3 eye;
+    glm::vec2 forward; // on the ground plane
+    float cone_cos = 0.5f;
+    std::vector<glm::vec4> near_trees, far_trees;
+    size_t culled = 0;
+
+};
+
+// same layout as Vertex in Mesh.h (that one needs OpenGL headers)
+struct TreeVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
+// tree of height 1 standing on the origin: bark triangles first (barkIndices of them), leaves after
+void BuildTreeMesh(std::vector<TreeVertex>& vertices, std::vector<unsigned int>& indices, unsigned int& barkIndices);
@@ -0,0 +1,255 @@
+#include <GL/glew.h> // GLEW provides efficient run-time mechanisms for determining which OpenGL extensions are supported on the target platform.
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <iostream>
+#include <cstddef>
+
+#include "VegetationRenderer.h"
+#include "RenderStats.h"
+#include "TextureLoader.h"
+
+// far enough that nothing fades (baking)
+static const float NO_FADE = 1e6f;
+static const glm::vec3 LIGHT_DIRECTION = glm::vec3(-0.2f, -1.0f, -0.3f); // the game's dirLight
+
+
+VegetationRenderer::VegetationRenderer(const ChunkStreamer& streamer)
+    : meshShader("resources/shaders/vegetation.vert", "resources/shaders/vegetation.frag"),
+      impostorShader("resources/shaders/impostor.vert", "resources/shaders/impostor.frag")
+{
+    slots.resize(streamer.MaxResident());
+    for (Slot& slot : slots)
+        slot.trees.reserve(MAX_TREES_PER_CHUNK);
+
+    std::vector<TreeVertex> vertices;
+    std::vector<unsigned int> indices;
+    BuildTreeMesh(vertices, indices, barkIndices);
+    leafIndices = (unsigned int)indices.size() - barkIndices;
+
+    glGenVertexArrays(1, &treeVAO);
+    glGenBuffers(1, &treeVBO);
+    glGenBuffers(1, &treeEBO);
+    glGenBuffers(1, &nearVBO);
+    glBindVertexArray(treeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, treeVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(TreeVertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, treeEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(TreeVertex), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TreeVertex), (void*)offsetof(TreeVertex, normal));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(TreeVertex), (void*)offsetof(TreeVertex, uv));
+    instanceAttribute(nearVBO);
+
+    // quad: x across (-0.5 .. 0.5), y up (0 .. 1), scaled by the tree in the shader
+    const float quad[] = { -0.5f, 0.0f, 0.5f, 0.0f, 0.5f, 1.0f, -0.5f, 0.0f, 0.5f, 1.0f, -0.5f, 1.0f };
+    glGenVertexArrays(1, &quadVAO);
+    glGenBuffers(1, &quadVBO);
+    glGenBuffers(1, &farVBO);
+    glBindVertexArray(quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    instanceAttribute(farVBO);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    barkTexture = LoadTexture2D("resources/objects/trees/BarkDecidious0143_5_S.jpg");
+    leafTexture = LoadTexture2D("resources/objects/trees/Leaves0120_35_S.png");
+
+    bakeImpostors();
+}
+
+void VegetationRenderer::Sync(ChunkStreamer& streamer, int maxUploads)
+{
+    ChunkCoord coord;
+    while (streamer.PopEvicted(coord)) {
+        for (Slot& slot : slots) {
+            if (slot.used && slot.coord == coord) {
+                slot.used = false;
+                used--;
+                break;
+            }
+        }
+    }
+
+    for (int i = 0; i < maxUploads; i++) {
+        ChunkMesh* mesh = streamer.PopReady();
+        if (!mesh)
+            break;
+        for (Slot& slot : slots) {
+            if (slot.used)
+                continue;
+            slot.used = true;
+            slot.coord = mesh->coord;
+            slot.trees.assign(mesh->trees.begin(), mesh->trees.end());
+            used++;
+            break;
+        }
+        streamer.Recycle(mesh);
+    }
+}
+
+void VegetationRenderer::Collect(VegetationBatch& batch) const
+{
+    for (const Slot& slot : slots) {
+        if (slot.used)
+            batch.Add(slot.trees.data(), slot.trees.size());
+    }
+}
+
+void VegetationRenderer::instanceAttribute(unsigned int VBO)
+{
+    // location 3: base xyz + height, one per instance (the VAO must be bound)
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+    glVertexAttribDivisor(3, 1);
+}
+
+void VegetationRenderer::bakeImpostors()
+{
+    const int width = FRAME_WIDTH * IMPOSTOR_FRAMES;
+    unsigned int* targets[2] = { &atlasColor, &atlasNormal };
+    for (unsigned int* target : targets) {
+        glGenTextures(1, target);
+        glBindTexture(GL_TEXTURE_2D, *target);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, FRAME_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    unsigned int FBO, depth;
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlasColor, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, atlasNormal, 0);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, FRAME_HEIGHT);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    const GLenum buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, buffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Impostor framebuffer is not complete" << std::endl;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    // transparent, with a leafy color so the mipmaps don't get dark edges
+    glClearColor(0.2f, 0.3f, 0.1f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // one unit tree on the origin, seen from IMPOSTOR_FRAMES directions around it
+    std::vector<glm::vec4> origin(1, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    upload(nearVBO, nearCapacity, origin);
+    float halfWidth = IMPOSTOR_WIDTH * 0.5f;
+    glm::mat4 projection = glm::ortho(-halfWidth, halfWidth, 0.0f, 1.0f, 0.5f, 4.0f);
+    for (int frame = 0; frame < IMPOSTOR_FRAMES; frame++) {
+        float angle = glm::two_pi<float>() * frame / IMPOSTOR_FRAMES;
+        glm::vec3 eye = glm::vec3(std::sin(angle), 0.0f, std::cos(angle)) * 2.0f;
+        glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glViewport(frame * FRAME_WIDTH, 0, FRAME_WIDTH, FRAME_HEIGHT);
+
+        meshShader.use();
+        setCommon(meshShader, view, projection, eye, NO_FADE, NO_FADE * 2.0f);
+        meshShader.setBool("bake", true);
+        glBindVertexArray(treeVAO);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, barkTexture);
+        glDrawElementsInstanced(GL_TRIANGLES, barkIndices, GL_UNSIGNED_INT, 0, 1);
+        glBindTexture(GL_TEXTURE_2D, leafTexture);
+        glDrawElementsInstanced(GL_TRIANGLES, leafIndices, GL_UNSIGNED_INT, (void*)(barkIndices * sizeof(unsigned int)), 1);
+    }
+    glBindVertexArray(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glDeleteRenderbuffers(1, &depth);
+    glDeleteFramebuffers(1, &FBO);
+    for (unsigned int* target : targets) {
+        glBindTexture(GL_TEXTURE_2D, *target);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void VegetationRenderer::upload(unsigned int VBO, size_t& capacity, const std::vector<glm::vec4>& instances)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (instances.size() > capacity)
+        capacity = instances.size() + instances.size() / 2;
+    // same size every frame: orphaning, the driver hands out fresh memory instead of waiting for last frame's draws
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(glm::vec4), instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VegetationRenderer::setCommon(ShaderProgram& shader, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eye, float fadeStart, float fadeEnd)
+{
+    shader.setMat4("view", view);
+    shader.setMat4("projection", projection);
+    shader.setVec3("viewPos", eye);
+    shader.setVec3("lightDir", glm::normalize(LIGHT_DIRECTION));
+    shader.setFloat("fadeStart", fadeStart);
+    shader.setFloat("fadeEnd", fadeEnd);
+}
+
+void VegetationRenderer::Draw(const VegetationBatch& batch, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eye)
+{
+    const std::vector<glm::vec4>& near = batch.Near();
+    const std::vector<glm::vec4>& far = batch.Far();
+    draw_calls = 0;
+    triangles = 0;
+    glActiveTexture(GL_TEXTURE0);
+
+    if (!near.empty()) {
+        upload(nearVBO, nearCapacity, near);
+        meshShader.use();
+        setCommon(meshShader, view, projection, eye, batch.settings.fade_start, batch.settings.fade_end);
+        meshShader.setBool("bake", false);
+        meshShader.setInt("diffuse", 0);
+        glBindVertexArray(treeVAO);
+        glBindTexture(GL_TEXTURE_2D, barkTexture);
+        glDrawElementsInstanced(GL_TRIANGLES, barkIndices, GL_UNSIGNED_INT, 0, (GLsizei)near.size());
+        glBindTexture(GL_TEXTURE_2D, leafTexture);
+        glDrawElementsInstanced(GL_TRIANGLES, leafIndices, GL_UNSIGNED_INT, (void*)(barkIndices * sizeof(unsigned int)), (GLsizei)near.size());
+        draw_calls += 2;
+        triangles += (barkIndices + leafIndices) / 3 * near.size();
+    }
+
+    if (!far.empty()) {
+        upload(farVBO, farCapacity, far);
+        impostorShader.use();
+        setCommon(impostorShader, view, projection, eye, batch.settings.fade_start, batch.settings.fade_end);
+        impostorShader.setInt("atlasColor", 0);
+        impostorShader.setInt("atlasNormal", 1);
+        impostorShader.setInt("frames", IMPOSTOR_FRAMES);
+        impostorShader.setFloat("width", IMPOSTOR_WIDTH);
+        glBindTexture(GL_TEXTURE_2D, atlasColor);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, atlasNormal);
+        glBindVertexArray(quadVAO);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)far.size());
+        glActiveTexture(GL_TEXTURE0);
+        draw_calls += 1;
+        triangles += 2 * far.size();
+    }
+    glBindVertexArray(0);
+    FrameRenderStats().Add(draw_calls, triangles);
+}
+
+// destructor
+VegetationRenderer::~VegetationRenderer()
+{
+    glDeleteVertexArrays(1, &treeVAO);
+    glDeleteVertexArrays(1, &quadVAO);
+    unsigned int buffers[5] = { treeVBO, treeEBO, nearVBO, quadVBO, farVBO };
+    glDeleteBuffers(5, buffers);
+    unsigned int textures[4] = { barkTexture, leafTexture, atlasColor, atlasNormal };
+    glDeleteTextures(4, textures);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <GL/glew.h> // GLEW provides efficient run-time mechanisms for determining which OpenGL extensions are supported on the target platform.
+#include <glm/glm.hpp> // ibrary for math operations
+#include <glm/ext.hpp>
+#include <string>
+#include <vector>
+
+#include "ShaderProgram.h"
+#include "ChunkStreamer.h"
+#include "Vegetation.h"
+
+/*
+	Render side of the streamed chunks (the ground is TerrainRenderer's): keeps the tree list of
+	every loaded chunk and draws a VegetationBatch with three instanced draws, however many trees
+	there are:
+	- near trees: the tree mesh (BuildTreeMesh), bark and leaves, one vec4 per instance
+	- far trees: camera facing quads with an impostor picked from IMPOSTOR_FRAMES views around the tree
+
+	The impostors are rendered once at startup into an atlas (color + normal, so the far trees
+	are lit the same way as the near ones). In the fade band both are drawn and dithered.
+*/
+class VegetationRenderer {
+
+public:
+    static const int IMPOSTOR_FRAMES = 8;
+    static const int FRAME_WIDTH = 128;
+    static const int FRAME_HEIGHT = 160;
+    // impostor width relative to the tree height (the frame aspect)
+    static constexpr float IMPOSTOR_WIDTH = (float)FRAME_WIDTH / FRAME_HEIGHT;
+
+    // needs a current OpenGL context, bakes the impostor atlas
+    // (room for every chunk the streamer can have loaded at once)
+    VegetationRenderer(const ChunkStreamer& streamer);
+    ~VegetationRenderer();
+
+    // drops the trees of evicted chunks, takes at most maxUploads finished ones
+    void Sync(ChunkStreamer& streamer, int maxUploads = 4);
+    // adds the trees of all loaded chunks to the batch
+    void Collect(VegetationBatch& batch) const;
+    int Chunks() const { return used; }
+
+    void Draw(const VegetationBatch& batch, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eye);
+
+    // metrics of the last Draw
+    int DrawCalls() const { return draw_calls; }
+    size_t Triangles() const { return triangles; }
+
+private:
+    struct Slot {
+        bool used = false;
+        ChunkCoord coord;
+        std::vector<glm::vec4> trees;
+    };
+
+    std::vector<Slot> slots;
+    int used = 0;
+    ShaderProgram meshShader, impostorShader;
+    unsigned int treeVAO, treeVBO, treeEBO, nearVBO;
+    unsigned int quadVAO, quadVBO, farVBO;
+    unsigned int barkIndices = 0, leafIndices = 0;
+    size_t nearCapacity = 0, farCapacity = 0; // instances the buffers hold
+    unsigned int barkTexture, leafTexture;
+    unsigned int atlasColor, atlasNormal;
+    int draw_calls = 0;
+    size_t triangles = 0;
+
+    void bakeImpostors();
+    void setCommon(ShaderProgram& shader, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eye, float fadeStart, float fadeEnd);
+    // copies the instances, grows the buffer only when they don't fit
+    static void upload(unsigned int VBO, size_t& capacity, const std::vector<glm::vec4>& instances);
+    static void instanceAttribute(unsigned int VBO);
+
+};
@@ -1,11 +1,85 @@
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
 
 #include "GameApp.h"
+#include "Trace.h"
 
 
-int main() {
+// usage: ICPFinalProject [--seed N] [--record file] [--replay file] [--no-roi]
+//                        [--tracking-preview off|frame|mask] [--preview-width N] [--preview-fps N]
+//                        [--camera N] [--capture WxH@FPS] [--capture-format mjpeg|yuyv|any] [--capture-buffers N]
+//                        [--capture-file video] [--synthetic-camera] [--gpu-csv file] [--trace file]
+//                        [--benchmark] [--benchmark-csv file] [--benchmark-frames N] [--benchmark-warmup N] [--benchmark-budget ms]
+static const char* USAGE = "usage: ICPFinalProject [--seed N] [--record file] [--replay file] [--no-roi]\n"
+	"       [--tracking-preview off|frame|mask] [--preview-width N] [--preview-fps N]\n"
+	"       [--camera N] [--capture WxH@FPS] [--capture-format mjpeg|yuyv|any] [--capture-buffers N]\n"
+	"       [--capture-file video] [--synthetic-camera] [--gpu-csv file] [--trace file]\n"
+	"       [--benchmark] [--benchmark-csv file] [--benchmark-frames N] [--benchmark-warmup N] [--benchmark-budget ms]";
 
+int main(int argc, char** argv) {
+
+	TraceThreadName("render");
 	GameApp game;
+	for (int i = 1; i < argc; i++) {
+		bool has_value = i + 1 < argc;
+		if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+			game.seed = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+			game.hasSeed = true;
+		}
+		else if (std::strcmp(argv[i], "--record") == 0 && has_value)
+			game.recordPath = argv[++i];
+		else if (std::strcmp(argv[i], "--replay") == 0 && has_value)
+			game.replayPath = argv[++i];
+		else if (std::strcmp(argv[i], "--tracking-preview") == 0 && has_value && TrackingPipeline::PreviewFromName(argv[++i], game.tracking.preview)) {
+		}
+		else if (std::strcmp(argv[i], "--preview-width") == 0 && has_value)
+			game.tracking.preview_width = std::max(16, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--preview-fps") == 0 && has_value)
+			game.tracking.preview_fps = std::atof(argv[++i]);
+		else if (std::strcmp(argv[i], "--no-roi") == 0)
+			game.tracking.roi_tracking = false;
+		else if (std::strcmp(argv[i], "--camera") == 0 && has_value)
+			game.captureSettings.device = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--capture") == 0 && has_value
+			&& std::sscanf(argv[++i], "%dx%d@%lf", &game.captureSettings.width, &game.captureSettings.height, &game.captureSettings.fps) == 3) {
+		}
+		else if (std::strcmp(argv[i], "--capture-format") == 0 && has_value && CaptureSource::FormatFromName(argv[++i], game.captureSettings.format)) {
+		}
+		else if (std::strcmp(argv[i], "--capture-buffers") == 0 && has_value)
+			game.captureSettings.buffers = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--capture-file") == 0 && has_value) {
+			game.captureSettings.source = CAPTURE_FILE;
+			game.captureSettings.file = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--synthetic-camera") == 0)
+			game.captureSettings.source = CAPTURE_SYNTHETIC;
+		else if (std::strcmp(argv[i], "--gpu-csv") == 0 && has_value)
+			game.gpuCsvPath = argv[++i];
+		else if (std::strcmp(argv[i], "--trace") == 0 && has_value) {
+			game.tracePath = argv[++i];
+			TraceEnable(true);
+		}
+		else if (std::strcmp(argv[i], "--benchmark") == 0)
+			game.benchmark = true;
+		else if (std::strcmp(argv[i], "--benchmark-csv") == 0 && has_value)
+			game.benchmarkCsv = argv[++i];
+		else if (std::strcmp(argv[i], "--benchmark-frames") == 0 && has_value)
+			game.bench.measured_frames = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--benchmark-warmup") == 0 && has_value)
+			game.bench.warmup_frames = std::max(0, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--benchmark-budget") == 0 && has_value)
+			game.bench.budget_ms = (float)std::atof(argv[++i]);
+		else {
+			std::cout << USAGE << std::endl;
+			return -1;
+		}
+	}
+	// benchmark: its own exit code (0 ok, 1 over budget, 2 aborted, 3 no output), the summary is printed
+	if (game.benchmark)
+		return game.run_game();
 	if (game.run_game() == 0) {
 		std::cout << "App is correctly terminated !" << std::endl;
 		return 0;
@@ -0,0 +1,409 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+
+#include <opencv2/opencv.hpp>
+#include <glm/glm.hpp> // ibrary for math operations
+
+#include "HsvCentroid.h"
+#include "RoiTracker.h"
+#include "SyntheticFrames.h"
+#include "CaptureSource.h"
+#include "TrackingPipeline.h"
+#include "Timing.h"
+
+/*
+	Tracking benchmark and accuracy check over annotated clips (the ICPBench project doesn't link OpenCV,
+	video decoding and the real pipeline need it, so this is its own executable).
+
+	usage: ICPTrackBench [video ...] [--frames N] [--range h,s,v,h,s,v] [--csv file] [--no-live]
+	       ICPTrackBench --make-clips dir   (writes the synthetic clips as MJPG videos with their truth files)
+
+	Every video needs its ground truth next to it, "<video>.truth": one line per frame with the
+	normalized marker centre "x y", "-1 -1" where the marker isn't in the frame. Without videos
+	two synthetic clips are used (SyntheticFrames at 640x480 and 1920x1080, 60 fps).
+
+	offline - the clip's frames one after another through each tracker, only the tracking is timed
+	          (decoding isn't): full frame on one thread, HsvCentroid on all threads, RoiTracker;
+	          per frame ms p50 / p95 / p99 / max, frames per second, error against the truth in
+	          pixels, detected frames and false detections (found where the marker isn't)
+	live    - TrackingPipeline with the clip as its paced source (no preview), capture -> result
+	          latency percentiles, processed frames per second, dropped frames, the error and the
+	          operator new calls on the pipeline's stage threads plus reallocated images after its
+	          warm-up (should be 0; OpenCV's internal allocations and worker threads aren't counted)
+
+	Exit code: 0, 1 when a clip or its truth can't be read, -1 for a bad command line.
+*/
+
+static const char* USAGE =
+	"usage: ICPTrackBench [video ...] [--frames N] [--range h,s,v,h,s,v] [--csv file] [--no-live]\n"
+	"       ICPTrackBench --make-clips dir";
+
+struct Clip {
+	std::string name;
+	std::string path; // empty = synthetic
+	int width = 0;
+	int height = 0;
+	double fps = 60.0;
+	std::vector<glm::vec2> truth; // per frame, x < 0 = marker not visible
+};
+
+// frames of a clip in order, decoded or generated
+class ClipReader {
+
+public:
+	bool Open(const Clip& clip, int maxFrames)
+	{
+		this->clip = &clip;
+		index = 0;
+		frames = std::min((int)clip.truth.size(), maxFrames > 0 ? maxFrames : (int)clip.truth.size());
+		if (clip.path.empty()) {
+			synthetic.reset(new SyntheticFrames(clip.width, clip.height));
+			return true;
+		}
+		return video.open(clip.path);
+	}
+
+	// next frame, false at the end of the clip
+	bool Next(cv::Mat& frame)
+	{
+		if (index >= frames)
+			return false;
+		if (synthetic) {
+			frame.create(clip->height, clip->width, CV_8UC3);
+			synthetic->Render(frame.data, frame.step, index / clip->fps);
+		}
+		else if (!video.read(frame) || frame.type() != CV_8UC3) {
+			return false;
+		}
+		index++;
+		return true;
+	}
+
+	int Index() const { return index; } // 1-based index of the last frame
+	int Frames() const { return frames; }
+
+private:
+	const Clip* clip = nullptr;
+	std::unique_ptr<SyntheticFrames> synthetic;
+	cv::VideoCapture video;
+	int index = 0;
+	int frames = 0;
+};
+
+enum Track_Method {
+	TRACK_FULL_FRAME,  // one kernel call over the whole frame on this thread
+	TRACK_ALL_THREADS, // HsvCentroid, the frame split over all cores
+	TRACK_ROI          // RoiTracker, window around the predicted marker
+};
+
+static const char* METHOD_NAMES[] = { "full frame", "all threads", "roi" };
+
+// what one tracker did over one clip
+struct Measurement {
+	std::vector<double> ms;        // per frame (offline) or capture -> result latency (live)
+	std::vector<double> error_px;  // frames where the marker is visible and was found
+	double seconds = 0.0;          // offline: time spent tracking, live: first to last result
+	int frames = 0;
+	int visible = 0;
+	int detected = 0;
+	int false_detections = 0;
+	uint64_t dropped = 0;
+	uint64_t allocations = UINT64_MAX; // live: SteadyAllocations() after the warm-up, UINT64_MAX offline
+
+	// one tracked frame against its truth
+	void Add(glm::vec2 truth, glm::vec2 center, float confidence, int width, int height)
+	{
+		frames++;
+		bool found = confidence > 0.0f;
+		if (truth.x < 0.0f) {
+			false_detections += found;
+			return;
+		}
+		visible++;
+		if (!found)
+			return;
+		detected++;
+		error_px.push_back(std::hypot((center.x - truth.x) * width, (center.y - truth.y) * height));
+	}
+};
+
+static double percentile(std::vector<double>& values, double p)
+{
+	if (values.empty())
+		return 0.0;
+	std::sort(values.begin(), values.end());
+	return values[std::min(values.size() - 1, (size_t)(p * values.size()))];
+}
+
+static double mean(const std::vector<double>& values)
+{
+	double sum = 0.0;
+	for (double v : values)
+		sum += v;
+	return values.empty() ? 0.0 : sum / values.size();
+}
+
+static std::ofstream csv;
+
+static void report(const Clip& clip, const char* mode, const char* tracker, Measurement& m)
+{
+	double fps = m.seconds > 0.0 ? m.frames / m.seconds : 0.0;
+	double detected = m.visible ? 100.0 * m.detected / m.visible : 0.0;
+	std::cout << "  " << std::left << std::setw(8) << mode << std::setw(12) << tracker << std::right << std::fixed
+		<< std::setprecision(2) << " ms p50 " << percentile(m.ms, 0.5) << "  p95 " << percentile(m.ms, 0.95)
+		<< "  p99 " << percentile(m.ms, 0.99) << "  max " << percentile(m.ms, 1.0)
+		<< std::setprecision(1) << "  | " << fps << " fps"
+		<< std::setprecision(2) << "  | error px mean " << mean(m.error_px) << "  p95 " << percentile(m.error_px, 0.95)
+		<< "  max " << percentile(m.error_px, 1.0)
+		<< std::setprecision(1) << "  | detected " << detected << " %  false " << m.false_detections;
+	if (m.dropped)
+		std::cout << "  dropped " << m.dropped;
+	if (m.allocations != UINT64_MAX)
+		std::cout << "  stage allocations " << m.allocations;
+	std::cout << std::defaultfloat << std::endl;
+
+	if (csv.is_open()) {
+		csv << clip.name << ',' << clip.width << 'x' << clip.height << ',' << mode << ',' << tracker << ',' << m.frames << ','
+			<< percentile(m.ms, 0.5) << ',' << percentile(m.ms, 0.95) << ',' << percentile(m.ms, 0.99) << ',' << percentile(m.ms, 1.0) << ','
+			<< fps << ',' << mean(m.error_px) << ',' << percentile(m.error_px, 0.95) << ',' << percentile(m.error_px, 1.0) << ','
+			<< detected << ',' << m.false_detections << ',' << m.dropped << ',';
+		if (m.allocations != UINT64_MAX)
+			csv << m.allocations;
+		csv << '\n';
+	}
+}
+
+// the clip's frames through one tracker as fast as it goes
+static bool runOffline(const Clip& clip, Track_Method method, const HsvRange& range, int maxFrames, Measurement& m)
+{
+	const float full_confidence = 0.002f; // like TrackingPipeline
+	ClipReader reader;
+	if (!reader.Open(clip, maxFrames))
+		return false;
+
+	HsvCentroid centroid(method == TRACK_ALL_THREADS ? 0 : 1);
+	RoiTracker roi;
+	roi.range = range;
+	roi.settings.full_confidence = full_confidence;
+
+	cv::Mat frame;
+	while (reader.Next(frame)) {
+		glm::vec2 center(0.0f);
+		float confidence = 0.0f;
+
+		double start = NowSeconds();
+		if (method == TRACK_ROI) {
+			RoiResult result = roi.Track(frame.data, frame.cols, frame.rows, frame.step, (reader.Index() - 1) / clip.fps);
+			center = result.center;
+			confidence = result.confidence;
+		}
+		else {
+			HsvMoments moments = method == TRACK_FULL_FRAME
+				? HsvThresholdMoments(frame.data, frame.cols, frame.step, 0, frame.rows, range)
+				: centroid.Run(frame.data, frame.cols, frame.rows, frame.step, range);
+			center = moments.Normalized(frame.cols, frame.rows);
+			confidence = (float)std::min(1.0, moments.count / ((double)frame.cols * frame.rows * full_confidence));
+		}
+		double elapsed = NowSeconds() - start;
+
+		m.ms.push_back(elapsed * 1000.0);
+		m.seconds += elapsed;
+		m.Add(clip.truth[reader.Index() - 1], center, confidence, frame.cols, frame.rows);
+	}
+	return m.frames > 0;
+}
+
+// the clip as the paced source of the real pipeline
+static bool runLive(const Clip& clip, bool roiTracking, const HsvRange& range, int maxFrames, Measurement& m)
+{
+	std::vector<TrackingResult> results;
+	TrackingPipeline tracking;
+	tracking.preview = PREVIEW_OFF;
+	tracking.roi_tracking = roiTracking;
+	tracking.range = range;
+	tracking.result_log = &results;
+
+	CaptureSettings settings;
+	settings.source = clip.path.empty() ? CAPTURE_SYNTHETIC : CAPTURE_FILE;
+	settings.file = clip.path;
+	settings.width = clip.width;
+	settings.height = clip.height;
+	settings.fps = clip.fps;
+	settings.loop = false;
+	settings.max_frames = std::min((int)clip.truth.size(), maxFrames > 0 ? maxFrames : (int)clip.truth.size());
+	if (!tracking.source.Open(settings))
+		return false;
+
+	tracking.Start();
+	tracking.Finish();
+
+	for (const TrackingResult& result : results) {
+		m.ms.push_back((result.result_time - result.capture_time) * 1000.0);
+		m.Add(clip.truth[result.frame - 1], result.center, result.confidence, clip.width, clip.height);
+	}
+	if (results.size() > 1)
+		m.seconds = results.back().result_time - results.front().result_time;
+	m.dropped = tracking.Dropped();
+	m.allocations = tracking.SteadyAllocations();
+	return !results.empty();
+}
+
+static Clip syntheticClip(int width, int height, int frames)
+{
+	Clip clip;
+	clip.name = "synthetic_" + std::to_string(width) + "x" + std::to_string(height);
+	clip.width = width;
+	clip.height = height;
+	for (int i = 0; i < frames; i++)
+		clip.truth.push_back(SyntheticFrames::BallAt(i / clip.fps));
+	return clip;
+}
+
+// size and fps from the video, truth from "<path>.truth"
+static bool loadClip(const std::string& path, Clip& clip)
+{
+	cv::VideoCapture video(path);
+	if (!video.isOpened()) {
+		std::cerr << "can't open " << path << std::endl;
+		return false;
+	}
+	clip.name = path.substr(path.find_last_of("/\\") + 1);
+	clip.path = path;
+	clip.width = (int)video.get(cv::CAP_PROP_FRAME_WIDTH);
+	clip.height = (int)video.get(cv::CAP_PROP_FRAME_HEIGHT);
+	double fps = video.get(cv::CAP_PROP_FPS);
+	if (fps > 0.0)
+		clip.fps = fps;
+
+	std::ifstream truth(path + ".truth");
+	float x, y;
+	while (truth >> x >> y)
+		clip.truth.push_back(x < 0.0f || y < 0.0f ? glm::vec2(-1.0f) : glm::vec2(x, y));
+	if (clip.truth.empty()) {
+		std::cerr << "no ground truth in " << path << ".truth" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+static bool makeClip(const Clip& clip, const std::string& directory)
+{
+	std::string path = directory + "/" + clip.name + ".avi";
+	cv::VideoWriter writer(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), clip.fps, cv::Size(clip.width, clip.height));
+	std::ofstream truth(path + ".truth");
+	if (!writer.isOpened() || !truth) {
+		std::cerr << "can't write " << path << std::endl;
+		return false;
+	}
+	ClipReader reader;
+	reader.Open(clip, 0);
+	cv::Mat frame;
+	while (reader.Next(frame)) {
+		writer.write(frame);
+		glm::vec2 center = clip.truth[reader.Index() - 1];
+		truth << center.x << ' ' << center.y << '\n';
+	}
+	std::cout << path << ": " << reader.Frames() << " frames" << std::endl;
+	return true;
+}
+
+static bool parseRange(const char* text, HsvRange& range)
+{
+	int v[6];
+	if (std::sscanf(text, "%d,%d,%d,%d,%d,%d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 6)
+		return false;
+	for (int i = 0; i < 3; i++) {
+		range.low[i] = (uint8_t)std::clamp(v[i], 0, 255);
+		range.high[i] = (uint8_t)std::clamp(v[i + 3], 0, 255);
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> videos;
+	int maxFrames = 0;
+	HsvRange range = TrackingPipeline().range;
+	std::string csvPath, clipDirectory;
+	bool live = true;
+
+	for (int i = 1; i < argc; i++) {
+		bool has_value = i + 1 < argc;
+		if (std::strcmp(argv[i], "--frames") == 0 && has_value)
+			maxFrames = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--range") == 0 && has_value && parseRange(argv[i + 1], range))
+			i++;
+		else if (std::strcmp(argv[i], "--csv") == 0 && has_value)
+			csvPath = argv[++i];
+		else if (std::strcmp(argv[i], "--make-clips") == 0 && has_value)
+			clipDirectory = argv[++i];
+		else if (std::strcmp(argv[i], "--no-live") == 0)
+			live = false;
+		else if (argv[i][0] != '-')
+			videos.push_back(argv[i]);
+		else {
+			std::cout << USAGE << std::endl;
+			return -1;
+		}
+	}
+
+	std::vector<Clip> clips;
+	if (videos.empty() || !clipDirectory.empty()) {
+		clips.push_back(syntheticClip(640, 480, 600));
+		clips.push_back(syntheticClip(1920, 1080, 600));
+	}
+	if (!clipDirectory.empty()) {
+		for (const Clip& clip : clips) {
+			if (!makeClip(clip, clipDirectory))
+				return 1;
+		}
+		return 0;
+	}
+	for (const std::string& video : videos) {
+		clips.emplace_back();
+		if (!loadClip(video, clips.back()))
+			return 1;
+	}
+
+	if (!csvPath.empty()) {
+		csv.open(csvPath);
+		csv << "clip,size,mode,tracker,frames,p50_ms,p95_ms,p99_ms,max_ms,fps,error_mean_px,error_p95_px,error_max_px,detected_percent,false_detections,dropped,steady_stage_allocations\n";
+	}
+
+	std::cout << "HSV kernel: " << SimdLevelName(HsvKernel()) << ", " << HsvCentroid().Threads() << " threads" << std::endl;
+	for (const Clip& clip : clips) {
+		std::cout << clip.name << " (" << clip.width << "x" << clip.height << ", " << clip.fps << " fps, "
+			<< clip.truth.size() << " annotated frames)" << std::endl;
+
+		for (Track_Method method : { TRACK_FULL_FRAME, TRACK_ALL_THREADS, TRACK_ROI }) {
+			Measurement m;
+			if (!runOffline(clip, method, range, maxFrames, m)) {
+				std::cerr << "can't read " << clip.name << std::endl;
+				return 1;
+			}
+			report(clip, "offline", METHOD_NAMES[method], m);
+		}
+
+		if (!live)
+			continue;
+		for (bool roiTracking : { false, true }) {
+			Measurement m;
+			if (!runLive(clip, roiTracking, range, maxFrames, m)) {
+				std::cerr << "can't run the pipeline on " << clip.name << std::endl;
+				return 1;
+			}
+			report(clip, "live", roiTracking ? "roi" : "all threads", m);
+		}
+	}
+	return 0;
+}